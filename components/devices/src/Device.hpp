@@ -8,6 +8,7 @@
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <concepts>
@@ -16,19 +17,27 @@
 
 #include <driver/gpio.h>
 #include <esp_app_desc.h>
+#include <esp_cpu.h>
+#include <esp_random.h>
+#include <esp_timer.h>
 
 static const char* const farmhubVersion = reinterpret_cast<const char*>(esp_app_get_description()->version);
 
 #include <BatteryManager.hpp>
+#include <ConnectivityCoordinator.hpp>
 #include <Console.hpp>
 #include <CrashManager.hpp>
 #include <DebugConsole.hpp>
+#include <EnergyLedger.hpp>
+#include <FlashBusyEdges.hpp>
 #include <HttpUpdate.hpp>
 #include <KernelStatus.hpp>
 #include <Log.hpp>
+#include <MemoryClass.hpp>
 #include <NvsConfiguration.hpp>
 #include <NvsStore.hpp>
 #include <Strings.hpp>
+#include <TelemetryDocument.hpp>
 #include <drivers/RtcDriver.hpp>
 #include <mqtt/MqttDriver.hpp>
 #include <mqtt/MqttLog.hpp>
@@ -187,10 +196,10 @@ std::shared_ptr<Watchdog> initWatchdog(seconds timeout) {
     });
 }
 
-std::shared_ptr<MqttRoot> initMqtt(const std::shared_ptr<ModuleStates>& states, const std::shared_ptr<NetworkConfig>& networkConfig, StateSource& mqttReady) {
+std::shared_ptr<MqttRoot> initMqtt(const std::shared_ptr<ModuleStates>& states, const std::shared_ptr<NetworkConfig>& networkConfig, StateSource& mqttReady, milliseconds listenPeriod, bool batchTraffic, size_t compressAbove, const std::shared_ptr<ConnectivityCoordinator>& connectivity, const std::shared_ptr<EnergyLedger>& energyLedger) {
     // NetworkConfig inherits from MqttDriver::Config, so we can upcast
     auto mqttConfig = std::static_pointer_cast<MqttDriver::Config>(networkConfig);
-    auto mqtt = std::make_shared<MqttDriver>(states->networkReady, mqttConfig, networkConfig->instance.get(), mqttReady);
+    auto mqtt = std::make_shared<MqttDriver>(states->networkReady, mqttConfig, networkConfig->instance.get(), mqttReady, listenPeriod, batchTraffic, compressAbove, connectivity, energyLedger);
     const std::string& location = networkConfig->location.get();
     return std::make_shared<MqttRoot>(mqtt, (location.empty() ? "" : location + "/") + "devices/ugly-duckling/" + networkConfig->instance.get());
 }
@@ -212,13 +221,13 @@ void registerBasicCommands(const std::shared_ptr<MqttRoot>& mqttRoot) {
 }
 
 void registerNvsCommands(const std::shared_ptr<MqttRoot>& mqttRoot) {
-    mqttRoot->registerCommand("nvs/list", [](const JsonObject& request, JsonObject& response) {
+    mqttRoot->registerStreamingCommand("nvs/list", [](const JsonObject& request, ResponseStream& stream) {
         const char* ns = request["namespace"] | "config";
         NvsStore store(ns);
-        JsonArray entries = response["entries"].to<JsonArray>();
-        store.list([entries](const std::string& key) {
-            auto entry = entries.add<JsonObject>();
-            entry["key"] = key;
+        store.list([&stream](const std::string& key) {
+            stream.add([&key](JsonObject& entry) {
+                entry["key"] = key;
+            });
         });
     });
     mqttRoot->registerCommand("nvs/read", [](const JsonObject& request, JsonObject& response) {
@@ -257,6 +266,81 @@ void registerNvsCommands(const std::shared_ptr<MqttRoot>& mqttRoot) {
     });
 }
 
+/**
+ * @brief Tag only compiled in up to info level, used to measure the cost of log calls.
+ */
+static const StaticLogTag<ESP_LOG_INFO> LOG_BENCHMARK { "farmhub:log-benchmark", ESP_LOG_WARN };
+
+template <typename F>
+static double measureCyclesPerCall(int iterations, F&& call) {
+    auto start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < iterations; i++) {
+        call();
+        // Keep the compiler from merging or dropping iterations
+        asm volatile("" ::: "memory");
+    }
+    return static_cast<double>(esp_cpu_get_cycle_count() - start) / iterations;
+}
+
+void registerLogCommands(const std::shared_ptr<MqttRoot>& mqttRoot) {
+    mqttRoot->registerCommand("log/level", [](const JsonObject& request, JsonObject& response) {
+        if (request["level"].is<const char*>() || request["level"].is<int>()) {
+            auto level = request["level"].is<int>()
+                ? std::optional<uint8_t>(std::clamp(request["level"].as<int>(), 0, static_cast<int>(LOG_LEVEL_VERBOSE)))
+                : parseLogLevel(request["level"].as<const char*>());
+            if (!level.has_value()) {
+                response["error"] = "Unknown level";
+                return;
+            }
+            if (request["tag"].is<const char*>()) {
+                auto tag = request["tag"].as<std::string>();
+                if (!tag.starts_with("farmhub:")) {
+                    tag = "farmhub:" + tag;
+                }
+                auto index = logLevels.find(tag);
+                if (!index.has_value()) {
+                    response["error"] = "Unknown tag";
+                    return;
+                }
+                logLevels.setLevel(*index, *level);
+            } else {
+                for (uint8_t index = 0; index < logLevels.size(); index++) {
+                    logLevels.setLevel(index, *level);
+                }
+            }
+        }
+        auto levels = response["levels"].to<JsonObject>();
+        for (uint8_t index = 0; index < logLevels.size(); index++) {
+            auto tag = levels[logLevels.getName(index)].to<JsonObject>();
+            tag["level"] = logLevelName(logLevels.getLevel(index));
+            tag["max"] = logLevelName(logLevels.getMaxLevel(index));
+        }
+    });
+    mqttRoot->registerCommand("log/benchmark", [](const JsonObject& request, JsonObject& response) {
+        int iterations = request["iterations"] | 10000;
+        auto cycles = response["cycles"].to<JsonObject>();
+        // Debug level is compiled out for the tag, leaving only the loop itself
+        cycles["compiled-out"] = measureCyclesPerCall(iterations, [] {
+            LOGTD(LOG_BENCHMARK, "Not compiled in");
+        });
+        // Info level is compiled in, but disabled at runtime
+        cycles["disabled"] = measureCyclesPerCall(iterations, [] {
+            LOGTI(LOG_BENCHMARK, "Disabled at runtime");
+        });
+        // Check for an enabled level, without the cost of formatting and printing the message
+        cycles["enabled"] = measureCyclesPerCall(iterations, [] {
+            volatile bool enabled = logLevels.isEnabled(LOG_BENCHMARK.index, ESP_LOG_WARN);
+            (void) enabled;
+        });
+        // For comparison, the per-tag lookup ESP-IDF does by name
+        cycles["esp-log-level-get"] = measureCyclesPerCall(iterations, [] {
+            volatile bool enabled = esp_log_level_get(LOG_BENCHMARK.name) >= ESP_LOG_WARN;
+            (void) enabled;
+        });
+        response["iterations"] = iterations;
+    });
+}
+
 void registerHttpUpdateCommand(const std::shared_ptr<MqttRoot>& mqttRoot, const std::shared_ptr<NvsStore>& nvs) {
     mqttRoot->registerCommand("update", [nvs](const JsonObject& request, JsonObject& response) {
         if (!request["url"].is<std::string>()) {
@@ -275,25 +359,34 @@ void registerHttpUpdateCommand(const std::shared_ptr<MqttRoot>& mqttRoot, const
 
 void initTelemetryPublishTask(
     milliseconds publishInterval,
+    size_t telemetryBudget,
     const std::shared_ptr<Watchdog>& watchdog,
     const std::shared_ptr<MqttRoot>& mqttRoot,
     const std::shared_ptr<BatteryManager>& batteryManager,
     const std::shared_ptr<PowerManager>& powerManager,
+    const std::shared_ptr<EnergyLedger>& energyLedger,
     const std::shared_ptr<WiFiDriver>& wifi,
+    const std::shared_ptr<ConnectivityCoordinator>& connectivity,
+    const std::shared_ptr<RtcDriver>& rtc,
     const std::shared_ptr<TelemetryCollector>& telemetryCollector,
     const std::shared_ptr<CopyQueue<bool>>& telemetryPublishQueue) {
-    Task::loop("telemetry", 8192, [publishInterval, watchdog, mqttRoot, batteryManager, powerManager, wifi, telemetryCollector, telemetryPublishQueue](Task& task) {
+    // Kept between publishes so we don't need to allocate on the heap every time
+    auto telemetryDocument = std::make_shared<TelemetryDocument>(telemetryBudget);
+    auto serializeLock = std::make_shared<PerformanceLock>("telemetry");
+    Task::loop("telemetry", 8192, [publishInterval, watchdog, mqttRoot, batteryManager, powerManager, energyLedger, wifi, connectivity, rtc, telemetryCollector, telemetryPublishQueue, telemetryDocument, serializeLock](Task& task) {
         task.markWakeTime();
 
-        mqttRoot->publish("telemetry", [batteryManager, powerManager, wifi, mqttRoot, telemetryCollector](JsonObject& telemetry) {
-            telemetry["uptime"] = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-            telemetry["timestamp"] = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+        auto telemetry = telemetryDocument->begin();
+        telemetry["uptime"] = duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+        telemetry["timestamp"] = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 
-            if (batteryManager != nullptr) {
-                auto battery = telemetry["battery"].to<JsonObject>();
+        // Sections are added in order of priority, the last ones are dropped first if we run out of budget
+        std::optional<double> current;
+        if (batteryManager != nullptr) {
+            current = batteryManager->getCurrent();
+            telemetryDocument->add<JsonObject>("battery", [&](JsonObject& battery) {
                 battery["voltage"] = static_cast<double>(batteryManager->getVoltage()) / 1000.0;    // Convert to volts
                 battery["percentage"] = batteryManager->getPercentage();
-                auto current = batteryManager->getCurrent();
                 if (current.has_value()) {
                     battery["current"] = *current;
                 }
@@ -301,23 +394,69 @@ void initTelemetryPublishTask(
                 if (timeToEmpty.has_value()) {
                     battery["time-to-empty"] = timeToEmpty->count();
                 }
-            }
+            });
+        }
 
-            auto wifiData = telemetry["wifi"].to<JsonObject>();
+        telemetryDocument->add<JsonArray>("features", [&](JsonArray& features) {
+            telemetryCollector->collect(features);
+        });
+
+        telemetryDocument->add<JsonObject>("wifi", [&](JsonObject& wifiData) {
             wifi->populateTelemetry(wifiData);
+        });
 
-            auto mqttData = telemetry["mqtt"].to<JsonObject>();
+        telemetryDocument->add<JsonObject>("connectivity", [&](JsonObject& connectivityData) {
+            connectivity->populateTelemetry(connectivityData);
+        });
+
+        telemetryDocument->add<JsonObject>("mqtt", [&](JsonObject& mqttData) {
             mqttRoot->mqtt->populateTelemetry(mqttData);
+        });
+
+        telemetryDocument->add<JsonObject>("energy", [&](JsonObject& energyData) {
+            energyLedger->populateTelemetry(energyData, current);
+        });
+
+        telemetryDocument->add<JsonObject>("rtc", [&](JsonObject& rtcData) {
+            rtc->populateTelemetry(rtcData);
+        });
+
+        telemetryDocument->add<JsonObject>("pm", [&](JsonObject& powerManagementData) {
+            powerManager->populateTelemetry(powerManagementData);
+        });
+
+        telemetryDocument->add<JsonObject>("config", [&](JsonObject& configData) {
+            ConfigurationUpdateStats::populateTelemetry(configData);
+        });
 
-            auto memoryData = telemetry["memory"].to<JsonObject>();
+        telemetryDocument->add<JsonObject>("log", [&](JsonObject& logData) {
+            ConsoleProvider::populateTelemetry(logData);
+        });
+
+        if constexpr (FlashBusyEdges::ENABLED) {
+            telemetryDocument->add<JsonObject>("isr", [&](JsonObject& isrData) {
+                isrData["flash-busy-edges"] = FlashBusyEdges::take();
+            });
+        }
+
+        telemetryDocument->add<JsonObject>("memory", [&](JsonObject& memoryData) {
             memoryData["free-heap"] = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
             memoryData["min-heap"] = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+            auto classesData = memoryData["classes"].to<JsonObject>();
+            Memory::populateTelemetry(classesData);
+        });
 
-            auto powerManagementData = telemetry["pm"].to<JsonObject>();
-            powerManager->populateTelemetry(powerManagementData);
+        if (!telemetryDocument->getTruncated().empty()) {
+            LOGW("Telemetry over budget, dropped %d sections", static_cast<int>(telemetryDocument->getTruncated().size()));
+        }
 
-            auto features = telemetry["features"].to<JsonArray>();
-            telemetryCollector->collect(features); }, Retention::NoRetain, QoS::AtLeastOnce);
+        std::string payload;
+        {
+            PowerManagementLockGuard burst(*serializeLock);
+            // The document keeps its buffer for the next report, the message gets an exact-size copy
+            payload = telemetryDocument->serialize();
+        }
+        mqttRoot->publish("telemetry", std::move(payload), Retention::NoRetain, QoS::AtLeastOnce);
 
         // Signal that we are still alive
         watchdog->restart();
@@ -333,6 +472,16 @@ void initTelemetryPublishTask(
     });
 }
 
+/**
+ * @brief Typical current draw of the device while idle in light sleep, in mA.
+ */
+static constexpr double BASELINE_CURRENT = 1.5;
+
+/**
+ * @brief Typical extra current draw when the CPU is kept from entering light sleep, in mA.
+ */
+static constexpr double AWAKE_CURRENT = 20.0;
+
 enum class InitState : std::uint8_t {
     Success = 0,
     PeripheralError = 1,
@@ -342,13 +491,23 @@ enum class InitState : std::uint8_t {
 template <std::derived_from<DeviceDefinition> TDeviceDefinition>
 static void startDevice() {
     auto i2c = std::make_shared<I2CManager>();
+
+    // Measure what it costs to set up the board's pins
+    auto pinsStartTime = esp_timer_get_time();
+    auto pinsStartHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
     auto deviceDefinition = std::make_shared<TDeviceDefinition>();
+    auto pinsSetupTime = esp_timer_get_time() - pinsStartTime;
+    auto pinsSetupHeap = static_cast<int>(pinsStartHeap) - static_cast<int>(heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    LOGD("Device definition with %zu board pins set up in %lld us using %d bytes of heap",
+        deviceDefinition->pins.getPins().size(), pinsSetupTime, pinsSetupHeap);
     auto battery = initBattery(deviceDefinition, i2c);
 
     initNvsFlash();
 
     // Install GPIO ISR service
-    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+    // Keep handling pulses and switch edges while flash operations have the cache disabled;
+    // every handler added to the service must be IRAM-safe
+    ESP_ERROR_CHECK(gpio_install_isr_service(ESP_INTR_FLAG_IRAM));
 
 #ifdef CONFIG_HEAP_TRACING
     ESP_ERROR_CHECK(heap_trace_init_standalone(trace_record, NUM_RECORDS));
@@ -368,8 +527,14 @@ static void startDevice() {
 
     auto watchdog = initWatchdog(settings->watchdogTimeout.get());
 
-    auto powerManager = std::make_shared<PowerManager>(settings->sleepWhenIdle.get());
+    auto powerManager = std::make_shared<PowerManager>(settings->sleepWhenIdle.get(),
+        battery != nullptr ? settings->batteryMaxCpuFreq.get() : 0);
+
+    auto energyLedger = std::make_shared<EnergyLedger>(BASELINE_CURRENT);
+    PowerManager::noLightSleep.trackEnergy(energyLedger->registerConsumer("no-light-sleep", AWAKE_CURRENT));
 
+    // Stays in internal RAM: the queue itself only holds pointers, and each record is a single
+    // short line that is freed as soon as it is published, so there is no bulk buffer to move
     auto logRecords = std::make_shared<Queue<LogRecord>>("logs",
 #ifdef FARMHUB_DEBUG
         128
@@ -377,7 +542,10 @@ static void startDevice() {
         32
 #endif
     );
-    ConsoleProvider::init(logRecords, settings->publishLogs.get());
+    LogRateLimiter::configure(settings->logBurst.get(), duration_cast<milliseconds>(settings->logBurstWindow.get()).count());
+    ConsoleProvider::init(logRecords, settings->publishLogs.get(),
+        settings->consoleBufferSize.get(),
+        settings->consoleBlockWhenFull.get() ? ConsoleOverflow::Block : ConsoleOverflow::DropOldest);
 
     LOGD("\n"
          "   ______                   _    _       _\n"
@@ -398,12 +566,18 @@ static void startDevice() {
     auto states = std::make_shared<ModuleStates>();
     KernelStatusTask::init(statusLed, states);
 
+    // Paces reconnects across WiFi, MQTT and NTP
+    auto connectivity = std::make_shared<ConnectivityCoordinator>(esp_random);
+
     // Init WiFi
     auto wifi = std::make_shared<WiFiDriver>(
         states->networkConnecting,
         states->networkReady,
         states->configPortalRunning,
-        networkConfig->getHostname());
+        networkConfig->getHostname(),
+        WiFiDriver::listenIntervalFor(settings->commandLatency.get()),
+        connectivity,
+        energyLedger);
 
     auto telemetryPublishQueue = std::make_shared<CopyQueue<bool>>("telemetry-publish", 1);
     auto telemetryPublisher = std::make_shared<TelemetryPublisher>(telemetryPublishQueue);
@@ -429,6 +603,10 @@ static void startDevice() {
 
     // Init battery management
     auto shutdownManager = std::make_shared<ShutdownManager>();
+    // Let writes in progress finish once everything else is shut down, and don't start new ones
+    shutdownManager->registerShutdownListener("nvs", ShutdownPriority::Deferred, 100ms, [](const ShutdownParameters& /*parameters*/) {
+        NvsStore::flush();
+    });
     std::shared_ptr<BatteryManager> batteryManager;
     if (battery != nullptr) {
         LOGD("Battery configured");
@@ -442,13 +620,19 @@ static void startDevice() {
 #endif
 
     // Init real time clock
-    auto rtc = std::make_shared<RtcDriver>(wifi->getNetworkReady(), networkConfig->ntp.get(), states->rtcInSync);
+    auto rtc = std::make_shared<RtcDriver>(wifi->getNetworkReady(), connectivity, networkConfig->ntp.get(), states->rtcInSync);
 
     // Init MQTT connection
-    auto mqttRoot = initMqtt(states, networkConfig, states->mqttReady);
+    // Without power save the radio listens at every beacon, and there is nothing to gain from batching
+    bool sleepWhenIdle = settings->sleepWhenIdle.get();
+    auto listenPeriod = sleepWhenIdle
+        ? wifi->getListenPeriod()
+        : duration_cast<milliseconds>(WiFiDriver::BEACON_INTERVAL);
+    auto mqttRoot = initMqtt(states, networkConfig, states->mqttReady, listenPeriod, sleepWhenIdle && settings->batchTraffic.get(), settings->compressAbove.get(), connectivity, energyLedger);
     MqttLog::init(settings->publishLogs.get(), logRecords, mqttRoot);
     registerBasicCommands(mqttRoot);
     registerNvsCommands(mqttRoot);
+    registerLogCommands(mqttRoot);
 
     // Handle any pending HTTP update (will reboot if update was required and was successful)
     registerHttpUpdateCommand(mqttRoot, configNvs);
@@ -462,6 +646,7 @@ static void startDevice() {
 
     // Init peripherals
     auto peripheralServices = PeripheralServices {
+        .energy = energyLedger,
         .i2c = i2c,
         .nvs = peripheralsNvs,
         .pcntManager = pcnt,
@@ -471,8 +656,10 @@ static void startDevice() {
         .telemetryPublisher = telemetryPublisher,
     };
     auto peripheralManager = std::make_shared<PeripheralManager>(telemetryCollector, peripheralServices);
-    shutdownManager->registerShutdownListener([peripheralManager]() {
-        peripheralManager->shutdown();
+    // Bring actuators to a safe state first, even when we are about to lose power
+    // Peripherals shut down concurrently, and get some leeway over their own estimates
+    shutdownManager->registerShutdownListener("peripherals", ShutdownPriority::Critical, 2s, [peripheralManager](const ShutdownParameters& parameters) {
+        peripheralManager->shutdown(parameters);
     });
     deviceDefinition->registerPeripheralFactories(peripheralManager, peripheralServices, settings);
 
@@ -483,8 +670,8 @@ static void startDevice() {
     };
     auto functionsConfigNvs = std::make_shared<NvsStore>("function-cfg");
     auto functionManager = std::make_shared<FunctionManager>(functionsConfigNvs, functionServices, mqttRoot);
-    shutdownManager->registerShutdownListener([functionManager]() {
-        functionManager->shutdown();
+    shutdownManager->registerShutdownListener("functions", ShutdownPriority::Normal, 100ms, [functionManager](const ShutdownParameters& parameters) {
+        functionManager->shutdown(parameters);
     });
     deviceDefinition->registerFunctionFactories(functionManager);
 
@@ -500,7 +687,7 @@ static void startDevice() {
     InitState initState = InitState::Success;
 
     // Init peripherals
-    JsonDocument peripheralsInitDoc;
+    JsonDocument peripheralsInitDoc(bulkJsonAllocator());
     auto peripheralsInitJson = peripheralsInitDoc.to<JsonArray>();
 
     auto builtInPeripheralsSettings = deviceDefinition->getBuiltInPeripherals();
@@ -521,7 +708,7 @@ static void startDevice() {
         }
     }
 
-    JsonDocument functionsInitDoc;
+    JsonDocument functionsInitDoc(bulkJsonAllocator());
     auto functionsInitJson = functionsInitDoc.to<JsonArray>();
     auto& functionsSettings = settings->functions.get();
     LOGI("Loading configuration for %d user-configured functions",
@@ -532,16 +719,27 @@ static void startDevice() {
         }
     }
 
-    initTelemetryPublishTask(settings->publishInterval.get(), watchdog, mqttRoot, batteryManager, powerManager, wifi, telemetryCollector, telemetryPublishQueue);
+    initTelemetryPublishTask(settings->publishInterval.get(), settings->telemetryBudget.get(), watchdog, mqttRoot, batteryManager, powerManager, energyLedger, wifi, connectivity, rtc, telemetryCollector, telemetryPublishQueue);
 
     // Enable power saving once we are done initializing
     WiFiDriver::setPowerSaveMode(settings->sleepWhenIdle.get());
 
+    auto previousLog = ConsoleProvider::takePreviousLog();
+    auto previousShutdown = ShutdownManager::takePreviousShutdown();
+    if (previousShutdown.has_value()) {
+        LOGI("Previous shutdown %s safe state in %" PRIu32 " ms",
+            previousShutdown->safe ? "reached" : "failed to reach", previousShutdown->timeToSafeState);
+    }
+
     mqttRoot->publish(
         "init",
-        [settings, networkConfig, initState, peripheralsInitJson, functionsInitJson, powerManager, deviceDefinition](JsonObject& json) {
+        [settings, networkConfig, initState, peripheralsInitJson, functionsInitJson, powerManager, deviceDefinition, pinsSetupTime, pinsSetupHeap, previousShutdown, previousLog](JsonObject& json) {
             json["model"] = deviceDefinition->model;
             json["revision"] = deviceDefinition->revision;
+            auto pinsJson = json["pins"].to<JsonObject>();
+            pinsJson["count"] = deviceDefinition->pins.getPins().size();
+            pinsJson["setup-time"] = pinsSetupTime;
+            pinsJson["setup-heap"] = pinsSetupHeap;
             json["platform"] = UD_PLATFORM;
             json["instance"] = networkConfig->instance.get();
             json["mac"] = getMacAddress();
@@ -561,8 +759,15 @@ static void startDevice() {
             json["peripherals"].to<JsonArray>().set(peripheralsInitJson);
             json["functions"].to<JsonArray>().set(functionsInitJson);
             json["sleepWhenIdle"] = powerManager->sleepWhenIdle;
+            if (previousShutdown.has_value()) {
+                auto shutdownJson = json["shutdown"].to<JsonObject>();
+                shutdownJson["time-to-safe-state"] = previousShutdown->timeToSafeState;
+                shutdownJson["safe"] = previousShutdown->safe;
+                shutdownJson["emergency"] = previousShutdown->emergency;
+                shutdownJson["late"] = previousShutdown->lateListeners;
+            }
 
-            CrashManager::handleCrashReport(json);
+            CrashManager::handleCrashReport(json, previousLog);
         },
         Retention::NoRetain, QoS::AtLeastOnce, 5s);
 
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <array>
 #include <list>
 #include <memory>
 #include <string>
 
 #include <Pin.hpp>
+#include <PinTable.hpp>
 
 #include <ArduinoJson.h>
 
@@ -23,6 +25,7 @@
 #include <peripherals/analog_meter/AnalogMeter.hpp>
 #include <peripherals/environment/Ds18B20SoilSensor.hpp>
 #include <peripherals/environment/Environment.hpp>
+#include <peripherals/environment/FusedSoilMoistureSensor.hpp>
 #include <peripherals/environment/KalmanFilterSoilSensor.hpp>
 #include <peripherals/environment/NtcTemperatureSensor.hpp>
 #include <peripherals/environment/Sht2xSensor.hpp>
@@ -42,21 +45,26 @@ using namespace farmhub::peripherals;
 
 namespace farmhub::devices {
 
-#define UD_DEFINE_PIN3(GPIO, VAR, STR) \
-    const InternalPinPtr VAR = InternalPin::registerPin(STR, GPIO);
+#define UD_GET_MACRO(_1, _2, _3, NAME, ...) NAME
 
-#define UD_DEFINE_PIN2(GPIO, VAR) \
-    UD_DEFINE_PIN3(GPIO, VAR, #VAR)
+#define UD_PIN_DEFINITION3(GPIO, VAR, STR) PinDefinition { STR, GPIO },
+#define UD_PIN_DEFINITION2(GPIO, VAR) UD_PIN_DEFINITION3(GPIO, VAR, #VAR)
+#define UD_PIN_DEFINITION(...) UD_GET_MACRO(__VA_ARGS__, UD_PIN_DEFINITION3, UD_PIN_DEFINITION2)(__VA_ARGS__)
 
-#define UD_GET_MACRO(_1, _2, _3, NAME, ...) NAME
+#define UD_PIN_MEMBER3(GPIO, VAR, STR) const InternalPinPtr VAR = InternalPin::byGpio(GPIO);
+#define UD_PIN_MEMBER2(GPIO, VAR) UD_PIN_MEMBER3(GPIO, VAR, #VAR)
+#define UD_PIN_MEMBER(...) UD_GET_MACRO(__VA_ARGS__, UD_PIN_MEMBER3, UD_PIN_MEMBER2)(__VA_ARGS__)
 
-#define DEFINE_PIN(...) UD_GET_MACRO(__VA_ARGS__, UD_DEFINE_PIN3, UD_DEFINE_PIN2)(__VA_ARGS__)
+// Takes a list of PIN(GPIO, VAR) or PIN(GPIO, VAR, "NAME") entries, and defines a compile-time
+// pin table named PINS, plus a member for each pin. The list must contain "BOOT" and "STATUS".
+#define DEFINE_PINS(LIST)                                                                        \
+    static constexpr PinTable PINS { std::to_array<PinDefinition>({ LIST(UD_PIN_DEFINITION) }) }; \
+    LIST(UD_PIN_MEMBER)
 
 struct DeviceConfig {
     std::string model;
     int revision;
-    gpio_num_t boot;
-    gpio_num_t status;
+    PinTableView pins;
 };
 
 class DeviceDefinition {
@@ -64,8 +72,9 @@ public:
     explicit DeviceDefinition(DeviceConfig config)
         : model(std::move(config.model))
         , revision(config.revision)
-        , bootPin(InternalPin::registerPin("BOOT", config.boot))
-        , statusPin(InternalPin::registerPin("STATUS", config.status)) {
+        , pins(InternalPin::useBoardPins(config.pins))
+        , bootPin(InternalPin::byName("BOOT"))
+        , statusPin(InternalPin::byName("STATUS")) {
     }
 
     virtual ~DeviceDefinition() = default;
@@ -80,6 +89,7 @@ public:
         peripheralManager->registerFactory(environment::makeFactoryForSoilMoisture());
         peripheralManager->registerFactory(environment::makeFactoryForDs18b20());
         peripheralManager->registerFactory(environment::makeFactoryForKalmanSoilMoisture());
+        peripheralManager->registerFactory(environment::makeFactoryForFusedSoilMoisture());
 
         peripheralManager->registerFactory(fence::makeFactory());
 
@@ -113,6 +123,7 @@ public:
 
     const std::string model;
     const int revision;
+    const PinTableView pins;
     const InternalPinPtr bootPin;
     const InternalPinPtr statusPin;
 
@@ -13,10 +13,42 @@ struct DeviceSettings : ConfigurationSection {
 
     Property<bool> sleepWhenIdle { this, "sleepWhenIdle", true };
 
+    /**
+     * @brief Maximum CPU frequency in MHz when running on battery, outside of known CPU-heavy bursts;
+     * 0 keeps the default.
+     */
+    Property<int> batteryMaxCpuFreq { this, "batteryMaxCpuFreq", 0 };
+
+    /**
+     * @brief Hold back non-urgent messages and send them together when the radio wakes to listen for beacons.
+     */
+    Property<bool> batchTraffic { this, "batchTraffic", false };
+
+    /**
+     * @brief Upper bound on how long commands may wait at the access point while we sleep.
+     *
+     * Determines the WiFi listen interval when sleeping when idle.
+     */
+    Property<milliseconds> commandLatency { this, "commandLatency", 2s };
+
+    /**
+     * @brief Compress MQTT payloads of at least this many bytes; 0 disables compression.
+     *
+     * Compressed payloads start with a 0x1F 'L' marker, the broker's consumers need to understand it.
+     */
+    Property<size_t> compressAbove { this, "compressAbove", 0 };
+
     /**
      * @brief How often to publish telemetry.
      */
     Property<seconds> publishInterval { this, "publishInterval", 5min };
+
+    /**
+     * @brief Maximum size of a telemetry message in bytes; low-priority sections are dropped beyond this.
+     *
+     * The default fits in the MQTT output buffer.
+     */
+    Property<size_t> telemetryBudget { this, "telemetryBudget", 4000 };
     Property<Level> publishLogs { this, "publishLogs",
 #ifdef FARMHUB_DEBUG
         Level::Verbose
@@ -25,6 +57,22 @@ struct DeviceSettings : ConfigurationSection {
 #endif
     };
 
+    /**
+     * @brief Buffer this many bytes of console output, written by a separate task; 0 to write synchronously.
+     */
+    Property<size_t> consoleBufferSize { this, "consoleBufferSize", 4096 };
+
+    /**
+     * @brief Wait briefly for the console to catch up when its buffer is full, instead of dropping old output.
+     */
+    Property<bool> consoleBlockWhenFull { this, "consoleBlockWhenFull", false };
+
+    /**
+     * @brief How many warnings and errors a single place in the code can log per window before being suppressed.
+     */
+    Property<uint32_t> logBurst { this, "logBurst", 10 };
+    Property<seconds> logBurstWindow { this, "logBurstWindow", 1min };
+
     /**
      * @brief How long without successfully published telemetry before the watchdog times out and reboots the device.
      */
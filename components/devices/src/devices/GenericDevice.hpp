@@ -11,27 +11,30 @@ using namespace farmhub::kernel;
 
 namespace farmhub::devices {
 
-class GenericDevice : public DeviceDefinition {
-public:
-    GenericDevice()
-        : DeviceDefinition({
-              .model = "generic",
-              .revision = 1,
 #if defined(CONFIG_IDF_TARGET_ESP32S3)
-              .boot = GPIO_NUM_0,
-              .status = GPIO_NUM_48,
+#define UD_GENERIC_PINS(PIN) \
+    PIN(GPIO_NUM_0, BOOT)    \
+    PIN(GPIO_NUM_48, STATUS)
 #elif defined(CONFIG_IDF_TARGET_ESP32C6)
-              .boot = GPIO_NUM_9,
-              .status = GPIO_NUM_8,
+#define UD_GENERIC_PINS(PIN) \
+    PIN(GPIO_NUM_9, BOOT)    \
+    PIN(GPIO_NUM_8, STATUS)
 #else
 #error "Unsupported target"
 #endif
-          }) {
+
+class GenericDevice : public DeviceDefinition {
+public:
+    GenericDevice()
+        : DeviceDefinition({ .model = "generic", .revision = 1, .pins = PINS.view() }) {
     }
 
 protected:
     void registerDeviceSpecificPeripheralFactories(const std::shared_ptr<PeripheralManager>& /*peripheralManager*/, const PeripheralServices& /*services*/, const std::shared_ptr<DeviceSettings>& /*settings*/) override {
     }
+
+private:
+    DEFINE_PINS(UD_GENERIC_PINS)
 };
 
 }    // namespace farmhub::devices
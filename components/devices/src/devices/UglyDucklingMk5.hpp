@@ -16,10 +16,46 @@ using namespace farmhub::peripherals::valve;
 
 namespace farmhub::devices {
 
+#define UD_MK5_PINS(PIN)              \
+    /* Boot button and status LED */  \
+    PIN(GPIO_NUM_0, BOOT)             \
+    PIN(GPIO_NUM_2, STATUS)           \
+    PIN(GPIO_NUM_1, BATTERY)          \
+    PIN(GPIO_NUM_4, AIPROPI)          \
+    PIN(GPIO_NUM_5, IOA1, "A1")       \
+    PIN(GPIO_NUM_6, IOA2, "A2")       \
+    PIN(GPIO_NUM_7, BIPROPI)          \
+    PIN(GPIO_NUM_15, IOB1, "B1")      \
+    PIN(GPIO_NUM_16, AIN1)            \
+    PIN(GPIO_NUM_17, AIN2)            \
+    PIN(GPIO_NUM_18, BIN1)            \
+    PIN(GPIO_NUM_8, BIN2)             \
+    PIN(GPIO_NUM_19, DMINUS, "D-")    \
+    PIN(GPIO_NUM_20, DPLUS, "D+")     \
+    PIN(GPIO_NUM_9, IOB2, "B2")       \
+    PIN(GPIO_NUM_10, NSLEEP)          \
+    PIN(GPIO_NUM_11, NFault)          \
+    PIN(GPIO_NUM_12, IOC4, "C4")      \
+    PIN(GPIO_NUM_13, IOC3, "C3")      \
+    PIN(GPIO_NUM_14, IOC2, "C2")      \
+    PIN(GPIO_NUM_21, IOC1, "C1")      \
+    PIN(GPIO_NUM_47, IOD4, "D4")      \
+    PIN(GPIO_NUM_48, IOD3, "D3")      \
+    PIN(GPIO_NUM_35, SDA)             \
+    PIN(GPIO_NUM_36, SCL)             \
+    PIN(GPIO_NUM_37, IOD1, "D1")      \
+    PIN(GPIO_NUM_38, IOD2, "D2")      \
+    PIN(GPIO_NUM_39, TCK)             \
+    PIN(GPIO_NUM_40, TDO)             \
+    PIN(GPIO_NUM_41, TDI)             \
+    PIN(GPIO_NUM_42, TMS)             \
+    PIN(GPIO_NUM_44, RXD0)            \
+    PIN(GPIO_NUM_43, TXD0)
+
 class UglyDucklingMk5 : public DeviceDefinition {
 public:
     UglyDucklingMk5()
-        : DeviceDefinition({ .model = "mk5", .revision = 2, .boot = GPIO_NUM_0, .status = GPIO_NUM_2 }) {
+        : DeviceDefinition({ .model = "mk5", .revision = 2, .pins = PINS.view() }) {
     }
 
 protected:
@@ -47,37 +83,7 @@ protected:
     }
 
 private:
-    DEFINE_PIN(GPIO_NUM_1, BATTERY)
-    DEFINE_PIN(GPIO_NUM_4, AIPROPI)
-    DEFINE_PIN(GPIO_NUM_5, IOA1, "A1")
-    DEFINE_PIN(GPIO_NUM_6, IOA2, "A2")
-    DEFINE_PIN(GPIO_NUM_7, BIPROPI)
-    DEFINE_PIN(GPIO_NUM_15, IOB1, "B1")
-    DEFINE_PIN(GPIO_NUM_16, AIN1)
-    DEFINE_PIN(GPIO_NUM_17, AIN2)
-    DEFINE_PIN(GPIO_NUM_18, BIN1)
-    DEFINE_PIN(GPIO_NUM_8, BIN2)
-    DEFINE_PIN(GPIO_NUM_19, DMINUS, "D-")
-    DEFINE_PIN(GPIO_NUM_20, DPLUS, "D+")
-    DEFINE_PIN(GPIO_NUM_9, IOB2, "B2")
-    DEFINE_PIN(GPIO_NUM_10, NSLEEP)
-    DEFINE_PIN(GPIO_NUM_11, NFault)
-    DEFINE_PIN(GPIO_NUM_12, IOC4, "C4")
-    DEFINE_PIN(GPIO_NUM_13, IOC3, "C3")
-    DEFINE_PIN(GPIO_NUM_14, IOC2, "C2")
-    DEFINE_PIN(GPIO_NUM_21, IOC1, "C1")
-    DEFINE_PIN(GPIO_NUM_47, IOD4, "D4")
-    DEFINE_PIN(GPIO_NUM_48, IOD3, "D3")
-    DEFINE_PIN(GPIO_NUM_35, SDA)
-    DEFINE_PIN(GPIO_NUM_36, SCL)
-    DEFINE_PIN(GPIO_NUM_37, IOD1, "D1")
-    DEFINE_PIN(GPIO_NUM_38, IOD2, "D2")
-    DEFINE_PIN(GPIO_NUM_39, TCK)
-    DEFINE_PIN(GPIO_NUM_40, TDO)
-    DEFINE_PIN(GPIO_NUM_41, TDI)
-    DEFINE_PIN(GPIO_NUM_42, TMS)
-    DEFINE_PIN(GPIO_NUM_44, RXD0)
-    DEFINE_PIN(GPIO_NUM_43, TXD0)
+    DEFINE_PINS(UD_MK5_PINS)
 };
 
 }    // namespace farmhub::devices
@@ -20,10 +20,49 @@ using namespace farmhub::peripherals::valve;
 
 namespace farmhub::devices {
 
+#define UD_MK6_PINS(PIN)              \
+    /* Boot button and status LED */  \
+    PIN(GPIO_NUM_0, BOOT)             \
+    PIN(GPIO_NUM_2, STATUS)           \
+    PIN(GPIO_NUM_1, BATTERY)          \
+    PIN(GPIO_NUM_4, STATUS2)          \
+    PIN(GPIO_NUM_5, IOB1, "B1")       \
+    PIN(GPIO_NUM_6, IOA1, "A1")       \
+    PIN(GPIO_NUM_7, DIPROPI)          \
+    PIN(GPIO_NUM_15, IOA2, "A2")      \
+    PIN(GPIO_NUM_16, AIN1)            \
+    PIN(GPIO_NUM_17, AIN2)            \
+    PIN(GPIO_NUM_18, BIN2)            \
+    PIN(GPIO_NUM_8, BIN1)             \
+    PIN(GPIO_NUM_19, DMINUS, "D-")    \
+    PIN(GPIO_NUM_20, DPLUS, "D+")     \
+    PIN(GPIO_NUM_46, LEDA_RED)        \
+    PIN(GPIO_NUM_9, LEDA_GREEN)       \
+    PIN(GPIO_NUM_11, NFault)          \
+    PIN(GPIO_NUM_12, BTN1)            \
+    PIN(GPIO_NUM_13, BTN2)            \
+    PIN(GPIO_NUM_14, IOC4, "C4")      \
+    PIN(GPIO_NUM_21, IOC3, "C3")      \
+    PIN(GPIO_NUM_47, IOC2, "C2")      \
+    PIN(GPIO_NUM_48, IOC1, "C1")      \
+    PIN(GPIO_NUM_45, IOB2, "B2")      \
+    PIN(GPIO_NUM_35, SDA)             \
+    PIN(GPIO_NUM_36, SCL)             \
+    PIN(GPIO_NUM_37, LEDB_GREEN)      \
+    PIN(GPIO_NUM_38, LEDB_RED)        \
+    PIN(GPIO_NUM_39, TCK)             \
+    PIN(GPIO_NUM_40, TDO)             \
+    PIN(GPIO_NUM_41, TDI)             \
+    PIN(GPIO_NUM_42, TMS)             \
+    PIN(GPIO_NUM_44, RXD0)            \
+    PIN(GPIO_NUM_43, TXD0)            \
+    /* Available on MK6 Rev3+ */      \
+    PIN(GPIO_NUM_10, LOADEN)
+
 class UglyDucklingMk6Base : public DeviceDefinition {
 public:
     explicit UglyDucklingMk6Base(int revision)
-        : DeviceDefinition({ .model = "mk6", .revision = revision, .boot = GPIO_NUM_0, .status = GPIO_NUM_2 }) {
+        : DeviceDefinition({ .model = "mk6", .revision = revision, .pins = PINS.view() }) {
         // Switch off strapping pin
         // TODO(lptr): Add a LED driver instead
         LEDA_RED->pinMode(Pin::Mode::Output);
@@ -63,40 +102,7 @@ protected:
     }
 
 protected:
-    DEFINE_PIN(GPIO_NUM_1, BATTERY)
-    DEFINE_PIN(GPIO_NUM_4, STATUS2)
-    DEFINE_PIN(GPIO_NUM_5, IOB1, "B1")
-    DEFINE_PIN(GPIO_NUM_6, IOA1, "A1")
-    DEFINE_PIN(GPIO_NUM_7, DIPROPI)
-    DEFINE_PIN(GPIO_NUM_15, IOA2, "A2")
-    DEFINE_PIN(GPIO_NUM_16, AIN1)
-    DEFINE_PIN(GPIO_NUM_17, AIN2)
-    DEFINE_PIN(GPIO_NUM_18, BIN2)
-    DEFINE_PIN(GPIO_NUM_8, BIN1)
-    DEFINE_PIN(GPIO_NUM_19, DMINUS, "D-")
-    DEFINE_PIN(GPIO_NUM_20, DPLUS, "D+")
-    DEFINE_PIN(GPIO_NUM_46, LEDA_RED)
-    DEFINE_PIN(GPIO_NUM_9, LEDA_GREEN)
-    DEFINE_PIN(GPIO_NUM_11, NFault)
-    DEFINE_PIN(GPIO_NUM_12, BTN1)
-    DEFINE_PIN(GPIO_NUM_13, BTN2)
-    DEFINE_PIN(GPIO_NUM_14, IOC4, "C4")
-    DEFINE_PIN(GPIO_NUM_21, IOC3, "C3")
-    DEFINE_PIN(GPIO_NUM_47, IOC2, "C2")
-    DEFINE_PIN(GPIO_NUM_48, IOC1, "C1")
-    DEFINE_PIN(GPIO_NUM_45, IOB2, "B2")
-    DEFINE_PIN(GPIO_NUM_35, SDA)
-    DEFINE_PIN(GPIO_NUM_36, SCL)
-    DEFINE_PIN(GPIO_NUM_37, LEDB_GREEN)
-    DEFINE_PIN(GPIO_NUM_38, LEDB_RED)
-    DEFINE_PIN(GPIO_NUM_39, TCK)
-    DEFINE_PIN(GPIO_NUM_40, TDO)
-    DEFINE_PIN(GPIO_NUM_41, TDI)
-    DEFINE_PIN(GPIO_NUM_42, TMS)
-    DEFINE_PIN(GPIO_NUM_44, RXD0)
-    DEFINE_PIN(GPIO_NUM_43, TXD0)
-    // Available on MK6 Rev3+
-    DEFINE_PIN(GPIO_NUM_10, LOADEN)
+    DEFINE_PINS(UD_MK6_PINS)
 };
 
 // MAC prefix 0x34:0x85:0x18
@@ -17,10 +17,45 @@ using namespace farmhub::peripherals::valve;
 
 namespace farmhub::devices {
 
+#define UD_MK7_PINS(PIN)              \
+    /* Boot button and status LED */  \
+    PIN(GPIO_NUM_0, BOOT)             \
+    PIN(GPIO_NUM_15, STATUS)          \
+    PIN(GPIO_NUM_1, IOA2, "A2")       \
+    PIN(GPIO_NUM_2, IOA1, "A1")       \
+    PIN(GPIO_NUM_3, IOA3, "A3")       \
+    PIN(GPIO_NUM_4, IOB3, "B3")       \
+    PIN(GPIO_NUM_5, IOB1, "B1")       \
+    PIN(GPIO_NUM_6, IOB2, "B2")       \
+    PIN(GPIO_NUM_8, BAT_GPIO)         \
+    PIN(GPIO_NUM_9, FSPIHD)           \
+    PIN(GPIO_NUM_10, FSPICS0)         \
+    PIN(GPIO_NUM_11, FSPID)           \
+    PIN(GPIO_NUM_12, FSPICLK)         \
+    PIN(GPIO_NUM_13, FSPIQ)           \
+    PIN(GPIO_NUM_14, FSPIWP)          \
+    PIN(GPIO_NUM_16, LOADEN)          \
+    PIN(GPIO_NUM_17, SCL)             \
+    PIN(GPIO_NUM_18, SDA)             \
+    PIN(GPIO_NUM_19, DMINUS, "D-")    \
+    PIN(GPIO_NUM_20, DPLUS, "D+")     \
+    PIN(GPIO_NUM_21, IOX1, "X1")      \
+    PIN(GPIO_NUM_37, DBIN1)           \
+    PIN(GPIO_NUM_38, DBIN2)           \
+    PIN(GPIO_NUM_39, DAIN2)           \
+    PIN(GPIO_NUM_40, DAIN1)           \
+    PIN(GPIO_NUM_41, DNFault)         \
+    PIN(GPIO_NUM_43, TXD0)            \
+    PIN(GPIO_NUM_44, RXD0)            \
+    PIN(GPIO_NUM_45, IOX2, "X2")      \
+    PIN(GPIO_NUM_46, STATUS2)         \
+    PIN(GPIO_NUM_47, IOB4, "B4")      \
+    PIN(GPIO_NUM_48, IOA4, "A4")
+
 class UglyDucklingMk7 : public DeviceDefinition {
 public:
     UglyDucklingMk7()
-        : DeviceDefinition({ .model = "mk7", .revision = 1, .boot = GPIO_NUM_0, .status = GPIO_NUM_15 }) {
+        : DeviceDefinition({ .model = "mk7", .revision = 1, .pins = PINS.view() }) {
         // Switch off strapping pin
         // TODO: Add a LED driver instead
         STATUS2->pinMode(Pin::Mode::Output);
@@ -57,36 +92,7 @@ protected:
     }
 
 private:
-    DEFINE_PIN(GPIO_NUM_1, IOA2, "A2")
-    DEFINE_PIN(GPIO_NUM_2, IOA1, "A1")
-    DEFINE_PIN(GPIO_NUM_3, IOA3, "A3")
-    DEFINE_PIN(GPIO_NUM_4, IOB3, "B3")
-    DEFINE_PIN(GPIO_NUM_5, IOB1, "B1")
-    DEFINE_PIN(GPIO_NUM_6, IOB2, "B2")
-    DEFINE_PIN(GPIO_NUM_8, BAT_GPIO)
-    DEFINE_PIN(GPIO_NUM_9, FSPIHD)
-    DEFINE_PIN(GPIO_NUM_10, FSPICS0)
-    DEFINE_PIN(GPIO_NUM_11, FSPID)
-    DEFINE_PIN(GPIO_NUM_12, FSPICLK)
-    DEFINE_PIN(GPIO_NUM_13, FSPIQ)
-    DEFINE_PIN(GPIO_NUM_14, FSPIWP)
-    DEFINE_PIN(GPIO_NUM_16, LOADEN)
-    DEFINE_PIN(GPIO_NUM_17, SCL)
-    DEFINE_PIN(GPIO_NUM_18, SDA)
-    DEFINE_PIN(GPIO_NUM_19, DMINUS, "D-")
-    DEFINE_PIN(GPIO_NUM_20, DPLUS, "D+")
-    DEFINE_PIN(GPIO_NUM_21, IOX1, "X1")
-    DEFINE_PIN(GPIO_NUM_37, DBIN1)
-    DEFINE_PIN(GPIO_NUM_38, DBIN2)
-    DEFINE_PIN(GPIO_NUM_39, DAIN2)
-    DEFINE_PIN(GPIO_NUM_40, DAIN1)
-    DEFINE_PIN(GPIO_NUM_41, DNFault)
-    DEFINE_PIN(GPIO_NUM_43, TXD0)
-    DEFINE_PIN(GPIO_NUM_44, RXD0)
-    DEFINE_PIN(GPIO_NUM_45, IOX2, "X2")
-    DEFINE_PIN(GPIO_NUM_46, STATUS2)
-    DEFINE_PIN(GPIO_NUM_47, IOB4, "B4")
-    DEFINE_PIN(GPIO_NUM_48, IOA4, "A4")
+    DEFINE_PINS(UD_MK7_PINS)
 };
 
 }    // namespace farmhub::devices
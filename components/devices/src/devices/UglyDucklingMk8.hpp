@@ -22,10 +22,61 @@ using namespace farmhub::peripherals::valve;
 
 namespace farmhub::devices {
 
+#define UD_MK8_PINS(PIN)                  \
+    /* Boot button and status LED */      \
+    PIN(GPIO_NUM_0, BOOT)                 \
+    PIN(GPIO_NUM_45, STATUS)              \
+    /* Internal I2C */                    \
+    PIN(GPIO_NUM_1, SDA)                  \
+    PIN(GPIO_NUM_2, SCL)                  \
+    /* Watchdog interrupt */              \
+    PIN(GPIO_NUM_3, WDI)                  \
+    /* Port B pins */                     \
+    PIN(GPIO_NUM_4, IOB3, "B3")           \
+    PIN(GPIO_NUM_5, IOB1, "B1")           \
+    PIN(GPIO_NUM_6, IOB2, "B2")           \
+    PIN(GPIO_NUM_7, IOB4, "B4")           \
+    /* Battery fuel gauge interrupt */    \
+    PIN(GPIO_NUM_8, BAT_GAUGE)            \
+    /* SPI for e-ink display */           \
+    PIN(GPIO_NUM_9, SBUSY)                \
+    PIN(GPIO_NUM_10, SCS)                 \
+    PIN(GPIO_NUM_11, SSDI)                \
+    PIN(GPIO_NUM_12, SSCLK)               \
+    PIN(GPIO_NUM_13, SRES)                \
+    PIN(GPIO_NUM_14, SDC)                 \
+    /* Port A pins */                     \
+    PIN(GPIO_NUM_15, IOA3, "A3")          \
+    PIN(GPIO_NUM_16, IOA1, "A1")          \
+    PIN(GPIO_NUM_17, IOA2, "A2")          \
+    PIN(GPIO_NUM_18, IOA4, "A4")          \
+    /* USB */                             \
+    PIN(GPIO_NUM_19, DMINUS, "D-")        \
+    PIN(GPIO_NUM_20, DPLUS, "D+")         \
+    /* Motor control pins */              \
+    PIN(GPIO_NUM_35, DAIN2)               \
+    PIN(GPIO_NUM_36, DAIN1)               \
+    PIN(GPIO_NUM_37, DBIN1)               \
+    PIN(GPIO_NUM_38, DBIN2)               \
+    /* Debug */                           \
+    PIN(GPIO_NUM_39, TCK)                 \
+    PIN(GPIO_NUM_40, TDO)                 \
+    PIN(GPIO_NUM_41, TDI)                 \
+    PIN(GPIO_NUM_42, TMS)                 \
+    /* UART */                            \
+    PIN(GPIO_NUM_43, RXD0)                \
+    PIN(GPIO_NUM_44, TXD0)                \
+    /* Status LEDs */                     \
+    PIN(GPIO_NUM_46, STATUS2)             \
+    /* Enable / disable external load */  \
+    PIN(GPIO_NUM_47, LOADEN)              \
+    /* Motor fault pin */                 \
+    PIN(GPIO_NUM_48, NFAULT)
+
 class UglyDucklingMk8Base : public DeviceDefinition {
 public:
     explicit UglyDucklingMk8Base(int revision)
-        : DeviceDefinition({ .model = "mk8", .revision = revision, .boot = GPIO_NUM_0, .status = GPIO_NUM_45 }) {
+        : DeviceDefinition({ .model = "mk8", .revision = revision, .pins = PINS.view() }) {
         // Switch off strapping pin
         // TODO: Add a LED driver instead
         STATUS2->pinMode(Pin::Mode::Output);
@@ -61,52 +112,7 @@ protected:
         peripheralManager->registerFactory(door::makeFactory(motors));
     }
 
-    // Internal I2C
-    DEFINE_PIN(GPIO_NUM_1, SDA)
-    DEFINE_PIN(GPIO_NUM_2, SCL)
-    // Watchdog interrupt
-    DEFINE_PIN(GPIO_NUM_3, WDI)
-    // Port B pins
-    DEFINE_PIN(GPIO_NUM_4, IOB3, "B3")
-    DEFINE_PIN(GPIO_NUM_5, IOB1, "B1")
-    DEFINE_PIN(GPIO_NUM_6, IOB2, "B2")
-    DEFINE_PIN(GPIO_NUM_7, IOB4, "B4")
-    // Battery fuel gauge interrupt
-    DEFINE_PIN(GPIO_NUM_8, BAT_GAUGE)
-    // SPI for e-ink display
-    DEFINE_PIN(GPIO_NUM_9, SBUSY)
-    DEFINE_PIN(GPIO_NUM_10, SCS)
-    DEFINE_PIN(GPIO_NUM_11, SSDI)
-    DEFINE_PIN(GPIO_NUM_12, SSCLK)
-    DEFINE_PIN(GPIO_NUM_13, SRES)
-    DEFINE_PIN(GPIO_NUM_14, SDC)
-    // Port A pins
-    DEFINE_PIN(GPIO_NUM_15, IOA3, "A3")
-    DEFINE_PIN(GPIO_NUM_16, IOA1, "A1")
-    DEFINE_PIN(GPIO_NUM_17, IOA2, "A2")
-    DEFINE_PIN(GPIO_NUM_18, IOA4, "A4")
-    // USB
-    DEFINE_PIN(GPIO_NUM_19, DMINUS, "D-")
-    DEFINE_PIN(GPIO_NUM_20, DPLUS, "D+")
-    // Motor control pins
-    DEFINE_PIN(GPIO_NUM_35, DAIN2)
-    DEFINE_PIN(GPIO_NUM_36, DAIN1)
-    DEFINE_PIN(GPIO_NUM_37, DBIN1)
-    DEFINE_PIN(GPIO_NUM_38, DBIN2)
-    // Debug
-    DEFINE_PIN(GPIO_NUM_39, TCK)
-    DEFINE_PIN(GPIO_NUM_40, TDO)
-    DEFINE_PIN(GPIO_NUM_41, TDI)
-    DEFINE_PIN(GPIO_NUM_42, TMS)
-    // UART
-    DEFINE_PIN(GPIO_NUM_43, RXD0)
-    DEFINE_PIN(GPIO_NUM_44, TXD0)
-    // Status LEDs
-    DEFINE_PIN(GPIO_NUM_46, STATUS2)
-    // Enable / disable external load
-    DEFINE_PIN(GPIO_NUM_47, LOADEN)
-    // Motor fault pin
-    DEFINE_PIN(GPIO_NUM_48, NFAULT)
+    DEFINE_PINS(UD_MK8_PINS)
 };
 
 // MAC prefix 0x98:0xa3:0x16:0x1a — INA219 omitted due to hardware fault on these units
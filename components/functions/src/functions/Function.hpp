@@ -85,7 +85,10 @@ FunctionFactory makeFunctionFactory(
                 params.mqttRoot->subscribe("config", [name = params.name, nvsConfig, impl](const std::string&, const JsonObject& cfgJson) {
                     LOGD("Received configuration update for function: %s", name.c_str());
                     try {
-                        nvsConfig->update(cfgJson);
+                        if (!nvsConfig->update(cfgJson)) {
+                            // Same as what we have, most likely the retained copy re-delivered after reconnecting
+                            return;
+                        }
                         if constexpr (std::is_base_of_v<HasConfig<TConfig>, Impl>) {
                             std::static_pointer_cast<HasConfig<TConfig>>(impl)->configure(nvsConfig->getConfig());
                         }
@@ -140,8 +143,8 @@ public:
         manager.registerFactory(std::move(factory));
     }
 
-    void shutdown() {
-        manager.shutdown();
+    void shutdown(const ShutdownParameters& parameters) {
+        manager.shutdown(parameters);
     }
 
 private:
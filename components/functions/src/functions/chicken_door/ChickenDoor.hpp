@@ -14,6 +14,7 @@
 #include <scheduling/DelayScheduler.hpp>
 #include <scheduling/LightSensorScheduler.hpp>
 #include <scheduling/OverrideScheduler.hpp>
+#include <scheduling/SolarScheduler.hpp>
 
 using namespace farmhub::peripherals::api;
 using namespace farmhub::utils::scheduling;
@@ -34,6 +35,27 @@ struct LightTarget : ConfigurationSection {
     Property<Lux> close { this, "close", 10 };
 };
 
+struct SolarTarget : ConfigurationSection {
+    /**
+     * @brief Coordinates of the door in degrees; solar scheduling is only used when both are set.
+     */
+    Property<double> latitude { this, "latitude" };
+    Property<double> longitude { this, "longitude" };
+
+    /**
+     * @brief Open at civil dawn and close at civil dusk instead of sunrise and sunset.
+     */
+    Property<bool> civilTwilight { this, "civilTwilight", false };
+
+    Property<seconds> openOffset { this, "openOffset", 0s };
+    Property<seconds> closeOffset { this, "closeOffset", 0s };
+
+    /**
+     * @brief Let the light sensor decide this close to sunrise and sunset; zero to rely on the sun alone.
+     */
+    Property<seconds> lightWindow { this, "lightWindow", 30min };
+};
+
 struct DelayTarget : ConfigurationSection {
     Property<seconds> open { this, "open", 0s };
 
@@ -49,6 +71,11 @@ struct ChickenDoorConfig : ConfigurationSection {
      */
     NamedConfigurationEntry<LightTarget> lightTarget { this, "lightTarget" };
 
+    /**
+     * @brief Open and close based on the position of the sun, optionally refined by the light sensor.
+     */
+    NamedConfigurationEntry<SolarTarget> solarTarget { this, "solarTarget" };
+
     /**
      * @brief Delays after opening or closing the door.
      */
@@ -65,6 +92,20 @@ struct ChickenDoorConfig : ConfigurationSection {
     Property<time_point<system_clock>> overrideUntil { this, "overrideUntil" };
 };
 
+struct NoOpLightSensor : virtual ILightSensor, Named {
+    NoOpLightSensor(const std::string& name)
+        : Named(name) {
+    }
+
+    Lux getLightLevel() override {
+        return -999;
+    }
+
+    const std::string& getName() const override {
+        return Named::name;
+    }
+};
+
 class ChickenDoor final
     : public Named,
       public HasConfig<ChickenDoorConfig> {
@@ -72,6 +113,7 @@ public:
     ChickenDoor(
         const std::string& name,
         const std::shared_ptr<IDoor>& door,
+        // Can be nullptr if there is no light sensor
         const std::shared_ptr<ILightSensor>& lightSensor,
         const std::shared_ptr<TelemetryPublisher>& telemetryPublisher)
         : Named(name) {
@@ -80,8 +122,15 @@ public:
             door->getName().c_str());
 
         auto overrideScheduler = std::make_shared<OverrideScheduler>();
-        auto lightSensorScheduler = std::make_shared<LightSensorScheduler>(lightSensor);
-        auto delayScheduler = std::make_shared<DelayScheduler>(lightSensorScheduler);
+        auto solarScheduler = std::make_shared<SolarScheduler>(lightSensor);
+        auto lightSensorScheduler = std::make_shared<LightSensorScheduler>(lightSensor == nullptr
+                ? std::make_shared<NoOpLightSensor>(name + ":light")
+                : lightSensor);
+        // The sun takes precedence when configured
+        auto delayScheduler = std::make_shared<DelayScheduler>(std::make_shared<CompositeScheduler>(std::list<std::shared_ptr<IScheduler>> {
+            solarScheduler,
+            lightSensorScheduler,
+        }));
 
         auto compositeScheduler = std::make_shared<CompositeScheduler>(std::list<std::shared_ptr<IScheduler>> {
             overrideScheduler,
@@ -95,8 +144,9 @@ public:
             compositeScheduler,
             telemetryPublisher,
             configQueue,
-            [overrideScheduler, lightSensorScheduler, delayScheduler](const ConfigSpec& config) {
+            [overrideScheduler, solarScheduler, lightSensorScheduler, delayScheduler](const ConfigSpec& config) {
                 overrideScheduler->setOverride(config.overrideTarget);
+                solarScheduler->setTarget(config.solarTarget);
                 lightSensorScheduler->setTarget(config.lightTarget);
                 delayScheduler->setTarget(config.delayTarget);
             });
@@ -110,12 +160,28 @@ public:
                   .until = config->overrideUntil.get(),
               })
             : std::nullopt;
+        LightSensorSchedule lightTarget {
+            .open = config->lightTarget.get()->open.get(),
+            .close = config->lightTarget.get()->close.get(),
+        };
+        auto solarConfig = config->solarTarget.get();
+        auto latitude = solarConfig->latitude.getIfPresent();
+        auto longitude = solarConfig->longitude.getIfPresent();
+        auto solarTarget = latitude.has_value() && longitude.has_value()
+            ? std::make_optional<SolarSchedule>({
+                  .latitude = *latitude,
+                  .longitude = *longitude,
+                  .twilight = solarConfig->civilTwilight.get() ? Twilight::Civil : Twilight::Official,
+                  .openOffset = solarConfig->openOffset.get(),
+                  .closeOffset = solarConfig->closeOffset.get(),
+                  .lightWindow = solarConfig->lightWindow.get(),
+                  .light = lightTarget,
+              })
+            : std::nullopt;
         configQueue.put(ConfigSpec {
             .overrideTarget = overrideTarget,
-            .lightTarget = {
-                .open = config->lightTarget.get()->open.get(),
-                .close = config->lightTarget.get()->close.get(),
-            },
+            .solarTarget = solarTarget,
+            .lightTarget = lightTarget,
             .delayTarget = {
                 .open = config->delayTarget.get()->open.get(),
                 .close = config->delayTarget.get()->close.get(),
@@ -126,6 +192,7 @@ public:
 private:
     struct ConfigSpec {
         std::optional<OverrideSchedule> overrideTarget;
+        std::optional<SolarSchedule> solarTarget;
         LightSensorSchedule lightTarget;
         DelaySchedule delayTarget;
     };
@@ -137,20 +204,6 @@ struct ChickenDoorSettings : ConfigurationSection {
     Property<std::string> lightSensor { this, "lightSensor" };
 };
 
-struct NoOpLightSensor : virtual ILightSensor, Named {
-    NoOpLightSensor(const std::string& name)
-        : Named(name) {
-    }
-
-    Lux getLightLevel() override {
-        return -999;
-    }
-
-    const std::string& getName() const override {
-        return Named::name;
-    }
-};
-
 inline FunctionFactory makeFactory() {
     return makeFunctionFactory<ChickenDoor, ChickenDoorSettings, ChickenDoorConfig>(
         "chicken-door",
@@ -158,7 +211,7 @@ inline FunctionFactory makeFactory() {
             auto door = params.peripheral<IDoor>(settings->door.get());
             auto lightSensor = settings->lightSensor.hasValue()
                 ? params.peripheral<ILightSensor>(settings->lightSensor.get())
-                : std::make_shared<NoOpLightSensor>(params.name + ":light");
+                : nullptr;
             return std::make_shared<ChickenDoor>(
                 params.name,
                 door,
@@ -0,0 +1,66 @@
+#include <chrono>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <Configuration.hpp>
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+using namespace farmhub::kernel;
+
+namespace {
+
+// Shaped like the settings of a typical peripheral
+struct BenchmarkNestedConfig : ConfigurationSection {
+    Property<std::string> pin { this, "pin" };
+    Property<double> qMoist { this, "qMoist", 1e-4 };
+    Property<double> qBeta { this, "qBeta", 1e-6 };
+};
+
+struct BenchmarkConfig : ConfigurationSection {
+    Property<std::string> name { this, "name" };
+    Property<bool> enabled { this, "enabled", true };
+    Property<int> low { this, "low", 60 };
+    Property<int> high { this, "high", 80 };
+    Property<seconds> interval { this, "interval", 10s };
+    Property<milliseconds> switchDuration { this, "switchDuration", 250ms };
+    NamedConfigurationEntry<BenchmarkNestedConfig> sensor { this, "sensor" };
+};
+
+}    // namespace
+
+TEST_CASE("configuration", "[benchmark][config]") {
+    std::string json = R"({
+        "name": "plot-1",
+        "enabled": true,
+        "low": 62,
+        "high": 78,
+        "interval": 30,
+        "switchDuration": 200,
+        "sensor": { "pin": "A1", "qMoist": 0.0002, "qBeta": 0.000002 }
+    })";
+    JsonDocument source;
+    deserializeJson(source, json);
+
+    BenchmarkConfig config;
+    config.load(source.as<JsonObject>());
+    REQUIRE(config.low.get() == 62);
+    REQUIRE(config.sensor.get()->pin.get() == "A1");
+
+    BENCHMARK("load from JSON object") {
+        config.load(source.as<JsonObject>());
+        return config.high.get();
+    };
+    BENCHMARK("load from string") {
+        config.loadFromString(json);
+        return config.high.get();
+    };
+    BENCHMARK("store") {
+        JsonDocument target;
+        auto root = target.to<JsonObject>();
+        config.store(root);
+        return target.size();
+    };
+}
@@ -0,0 +1,72 @@
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <InstanceRegistry.hpp>
+
+using namespace farmhub::kernel;
+
+namespace {
+
+struct Valve {
+    int state = 0;
+};
+
+/**
+ * @brief How `Manager` looked up instances by name before: under a lock, checking the type every time.
+ */
+class NamedLookup {
+public:
+    void add(const std::string& name, const std::shared_ptr<Valve>& instance) {
+        std::lock_guard lock(mutex);
+        instances.emplace(name, Entry { std::static_pointer_cast<void>(instance), &TypeTokenVar<Valve> });
+    }
+
+    template <typename T>
+    std::shared_ptr<T> getInstance(const std::string& name) const {
+        std::lock_guard lock(mutex);
+        auto it = instances.find(name);
+        if (it != instances.end() && it->second.typeTag == &TypeTokenVar<T>) {
+            return std::static_pointer_cast<T>(it->second.holder);
+        }
+        return nullptr;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<void> holder;
+        const void* typeTag;
+    };
+
+    mutable std::recursive_mutex mutex;
+    std::unordered_map<std::string, Entry> instances;
+};
+
+}    // namespace
+
+TEST_CASE("instance lookup", "[benchmark][manager]") {
+    // A device with a few dozen peripherals, so the registry spans several segments
+    NamedLookup lookup;
+    InstanceRegistry registry;
+    uint32_t lastIndex = 0;
+    for (int i = 0; i < 40; i++) {
+        auto valve = std::make_shared<Valve>();
+        lookup.add("valve-" + std::to_string(i), valve);
+        lastIndex = registry.add(valve, &TypeTokenVar<Valve>);
+    }
+
+    std::string name = "valve-39";
+    auto ref = registry.ref<Valve>(lastIndex);
+    REQUIRE(lookup.getInstance<Valve>(name).get() == &*ref);
+
+    BENCHMARK("by name under lock") {
+        return lookup.getInstance<Valve>(name)->state;
+    };
+    BENCHMARK("resolved reference") {
+        return ref->state;
+    };
+}
@@ -0,0 +1,21 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <LogLevels.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("log level checks", "[benchmark][log]") {
+    static LogLevelTable<32> table;
+    auto index = table.registerTag("farmhub:benchmark", 4, 2);
+
+    BENCHMARK("disabled") {
+        return table.isEnabled(index, 3);
+    };
+    BENCHMARK("enabled") {
+        return table.isEnabled(index, 1);
+    };
+    BENCHMARK("lookup by name") {
+        return table.find("farmhub:benchmark");
+    };
+}
@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <Lzss.hpp>
+
+using namespace farmhub::kernel;
+
+namespace {
+
+// Payloads as published by a device with a valve, a flow meter and a soil moisture sensor
+const std::string TELEMETRY = R"({"uptime":86400123,"timestamp":1760000000,"battery":{"voltage":3.921,"percentage":78},)"
+                              R"("features":[{"type":"flow","peripheral":"flow-meter","name":"flow","value":0.125},)"
+                              R"({"type":"volume","peripheral":"flow-meter","name":"volume","value":12.5},)"
+                              R"({"type":"moisture","peripheral":"soil-moisture","name":"moisture","value":61.25},)"
+                              R"({"type":"temperature","peripheral":"soil-moisture","name":"temperature","value":18.5},)"
+                              R"({"type":"valve","peripheral":"valve","name":"state","value":"closed"}],)"
+                              R"("wifi":{"rssi":-67,"disconnects":0,"roams":0},)"
+                              R"("mqtt":{"disconnects":0,"batching":{"enabled":true,"radio-on":1532,"bursts":12,"messages":37},)"
+                              R"("command-latency":{"bound":2000,"count":0}},)"
+                              R"("energy":{"wifi":{"active":12345,"energy":4.25},"mqtt":{"active":2345,"energy":0.75},)"
+                              R"("valve:valve":{"active":0,"energy":0.0}},)"
+                              R"("rtc":{"offset":-12,"drift":0.5,"syncs":1},)"
+                              R"("pm":{"locks":{"cpu":{"count":3,"time":120}}},)"
+                              R"("log":{"crash-log":{"writes":42,"average-cycles":812,"max-cycles":2450,"max-us":15},"suppressed":0,"repeated":0},)"
+                              R"("memory":{"free-heap":123456,"min-free-heap":98765,"largest-free-block":65536},)"
+                              R"("serialization":{"budget":4000,"arena":8000,"peak":3120}})";
+
+std::string nvsList() {
+    std::string json = R"({"entries":[)";
+    for (int i = 0; i < 60; i++) {
+        json += (i == 0 ? "" : ",");
+        json += R"({"key":"p:valve-)" + std::to_string(i) + R"("},{"key":"f:plot-)" + std::to_string(i) + R"("})";
+    }
+    json += "]}";
+    return json;
+}
+
+std::string logHistory() {
+    std::string json = "[";
+    for (int i = 0; i < 40; i++) {
+        json += (i == 0 ? "" : ",");
+        json += R"({"level":4,"message":"I ()" + std::to_string(1000 + i * 5137)
+            + R"() farmhub:plot-ctrl: Function 'plot-1' stayed in state closed, will evaluate again after 30 s"})";
+    }
+    json += "]";
+    return json;
+}
+
+void benchmarkPayload(const char* name, const std::string& payload) {
+    LzssCompressor compressor;
+    std::string compressed;
+    REQUIRE(compressor.compress(payload, compressed));
+    std::string decompressed;
+    REQUIRE(LzssCompressor::decompress(compressed, decompressed));
+    REQUIRE(decompressed == payload);
+    std::printf("%s: %zu -> %zu bytes, ratio %.2f\n",
+        name, payload.size(), compressed.size(), static_cast<double>(compressed.size()) / static_cast<double>(payload.size()));
+
+    BENCHMARK(std::string("compress ") + name) {
+        compressor.compress(payload, compressed);
+        return compressed.size();
+    };
+    BENCHMARK(std::string("decompress ") + name) {
+        LzssCompressor::decompress(compressed, decompressed);
+        return decompressed.size();
+    };
+}
+
+}    // namespace
+
+TEST_CASE("payload compression", "[benchmark][mqtt]") {
+    benchmarkPayload("telemetry", TELEMETRY);
+    benchmarkPayload("nvs list", nvsList());
+    benchmarkPayload("log history", logHistory());
+}
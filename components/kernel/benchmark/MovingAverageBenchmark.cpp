@@ -0,0 +1,16 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <MovingAverage.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("moving average", "[benchmark]") {
+    BENCHMARK_ADVANCED("record")(Catch::Benchmark::Chronometer meter) {
+        MovingAverage<int, double> average(16);
+        meter.measure([&](int i) {
+            average.record(i);
+            return average.getAverage();
+        });
+    };
+}
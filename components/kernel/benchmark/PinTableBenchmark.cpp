@@ -0,0 +1,60 @@
+#include <map>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <PinTable.hpp>
+
+using namespace farmhub::kernel;
+
+// The pins of an MK8 board
+static constexpr PinTable PINS { std::to_array<PinDefinition>({
+    { "BOOT", 0 }, { "STATUS", 45 }, { "SDA", 1 }, { "SCL", 2 }, { "WDI", 3 },
+    { "B3", 4 }, { "B1", 5 }, { "B2", 6 }, { "B4", 7 }, { "BAT_GAUGE", 8 },
+    { "SBUSY", 9 }, { "SCS", 10 }, { "SSDI", 11 }, { "SSCLK", 12 }, { "SRES", 13 }, { "SDC", 14 },
+    { "A3", 15 }, { "A1", 16 }, { "A2", 17 }, { "A4", 18 }, { "D-", 19 }, { "D+", 20 },
+    { "DAIN2", 35 }, { "DAIN1", 36 }, { "DBIN1", 37 }, { "DBIN2", 38 },
+    { "TCK", 39 }, { "TDO", 40 }, { "TDI", 41 }, { "TMS", 42 }, { "RXD0", 43 }, { "TXD0", 44 },
+    { "STATUS2", 46 }, { "LOADEN", 47 }, { "NFAULT", 48 },
+}) };
+
+TEST_CASE("pin lookup", "[benchmark][pins]") {
+    // What we used to do: a map from name to pin, filled while booting
+    std::map<std::string, int> byName;
+    std::map<int, std::string> byGpio;
+    for (const auto& pin : PINS.view().getPins()) {
+        byName.emplace(std::string(pin.name), pin.gpio);
+        byGpio.emplace(pin.gpio, std::string(pin.name));
+    }
+
+    std::string name = "NFAULT";
+    std::string unknown = "C1";
+    REQUIRE(PINS.findGpio(name) == byName.at(name));
+
+    BENCHMARK("map by name") {
+        return byName.find(name)->second;
+    };
+    BENCHMARK("table by name") {
+        return *PINS.findGpio(name);
+    };
+    BENCHMARK("map by unknown name") {
+        return byName.find(unknown) == byName.end();
+    };
+    BENCHMARK("table by unknown name") {
+        return PINS.findGpio(unknown).has_value();
+    };
+    BENCHMARK("map by GPIO") {
+        return byGpio.find(48)->second.size();
+    };
+    BENCHMARK("table by GPIO") {
+        return PINS.findName(48)->size();
+    };
+    BENCHMARK("building the maps") {
+        std::map<std::string, int> map;
+        for (const auto& pin : PINS.view().getPins()) {
+            map.emplace(std::string(pin.name), pin.gpio);
+        }
+        return map.size();
+    };
+}
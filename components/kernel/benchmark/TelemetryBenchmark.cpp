@@ -0,0 +1,106 @@
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <MemoryClass.hpp>
+#include <TelemetryDocument.hpp>
+
+using namespace farmhub::kernel;
+
+namespace {
+
+// Shaped like what the device publishes every minute
+void populateWifi(JsonObject& json) {
+    json["rssi"] = -67;
+    json["disconnects"] = 0;
+    json["roams"] = 1;
+    auto roam = json["last-roam"].to<JsonObject>();
+    roam["rssi-before"] = -81;
+    roam["rssi-after"] = -64;
+}
+
+void populateMqtt(JsonObject& json) {
+    auto batching = json["batching"].to<JsonObject>();
+    batching["enabled"] = true;
+    batching["radio-on"] = 1532;
+    batching["bursts"] = 12;
+    batching["messages"] = 37;
+    auto latency = json["command-latency"].to<JsonObject>();
+    latency["bound"] = 2000;
+    latency["count"] = 3;
+    latency["average"] = 412;
+    latency["max"] = 1180;
+}
+
+void populateEnergy(JsonObject& json) {
+    for (const auto* consumer : { "wifi", "mqtt", "valve:main", "door", "pm" }) {
+        auto entry = json[consumer].to<JsonObject>();
+        entry["active"] = 12345;
+        entry["energy"] = 4.25;
+    }
+}
+
+void populateMemory(JsonObject& json) {
+    json["free-heap"] = 123456;
+    json["min-free-heap"] = 98765;
+    json["largest-free-block"] = 65536;
+}
+
+void populate(JsonObject& root) {
+    root["uptime"] = 86400123;
+    root["timestamp"] = 1760000000;
+    auto wifi = root["wifi"].to<JsonObject>();
+    populateWifi(wifi);
+    auto mqtt = root["mqtt"].to<JsonObject>();
+    populateMqtt(mqtt);
+    auto energy = root["energy"].to<JsonObject>();
+    populateEnergy(energy);
+    auto memory = root["memory"].to<JsonObject>();
+    populateMemory(memory);
+}
+
+}    // namespace
+
+TEST_CASE("telemetry", "[benchmark][telemetry]") {
+    BENCHMARK("build and serialize with a fresh document") {
+        JsonDocument doc;
+        auto root = doc.to<JsonObject>();
+        populate(root);
+        std::string output;
+        serializeJson(doc, output);
+        return output.size();
+    };
+
+    // Accounting overhead of the allocator used for init messages and command responses
+    BENCHMARK("build and serialize with a fresh bulk document") {
+        JsonDocument doc(bulkJsonAllocator());
+        auto root = doc.to<JsonObject>();
+        populate(root);
+        std::string output;
+        serializeJson(doc, output);
+        return output.size();
+    };
+
+    TelemetryDocument telemetry(4000);
+    BENCHMARK("build and serialize with a persistent document") {
+        auto root = telemetry.begin();
+        root["uptime"] = 86400123;
+        root["timestamp"] = 1760000000;
+        telemetry.add<JsonObject>("wifi", populateWifi);
+        telemetry.add<JsonObject>("mqtt", populateMqtt);
+        telemetry.add<JsonObject>("energy", populateEnergy);
+        telemetry.add<JsonObject>("memory", populateMemory);
+        return telemetry.serialize().size();
+    };
+
+    JsonDocument doc;
+    auto root = doc.to<JsonObject>();
+    populate(root);
+    std::string output;
+    BENCHMARK("serialize only") {
+        output.clear();
+        serializeJson(doc, output);
+        return output.size();
+    };
+}
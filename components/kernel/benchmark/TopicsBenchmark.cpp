@@ -0,0 +1,63 @@
+#include <list>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <mqtt/Topics.hpp>
+
+using namespace farmhub::kernel::mqtt;
+
+TEST_CASE("topic matching", "[benchmark][mqtt]") {
+    BENCHMARK("literal") {
+        return topicMatches("devices/ugly-duckling/garden/commands/ping", "devices/ugly-duckling/garden/commands/ping");
+    };
+    BENCHMARK("literal mismatch at the end") {
+        return topicMatches("devices/ugly-duckling/garden/commands/ping", "devices/ugly-duckling/garden/commands/pong");
+    };
+    BENCHMARK("single level wildcard") {
+        return topicMatches("devices/ugly-duckling/+/commands/ping", "devices/ugly-duckling/garden/commands/ping");
+    };
+    BENCHMARK("multi level wildcard") {
+        return topicMatches("devices/ugly-duckling/garden/#", "devices/ugly-duckling/garden/commands/nvs/list");
+    };
+}
+
+TEST_CASE("subscription dispatch", "[benchmark][mqtt]") {
+    // Roughly what a device with a couple of peripherals and functions subscribes to
+    std::list<std::string> subscriptions;
+    for (const auto* command : { "restart", "sleep", "nvs/list", "nvs/read", "nvs/write", "nvs/remove",
+             "log/level", "log/benchmark", "update", "ping", "config" }) {
+        subscriptions.push_back(std::string("devices/ugly-duckling/garden/commands/") + command);
+    }
+    for (const auto* peripheral : { "valve", "flow-meter", "soil-moisture", "env", "door" }) {
+        subscriptions.push_back(std::string("devices/ugly-duckling/garden/peripherals/") + peripheral + "/config");
+        subscriptions.push_back(std::string("devices/ugly-duckling/garden/peripherals/") + peripheral + "/commands/#");
+    }
+
+    auto dispatch = [&](const std::string& topic) {
+        for (const auto& subscription : subscriptions) {
+            if (topicMatches(subscription.c_str(), topic.c_str())) {
+                return &subscription;
+            }
+        }
+        return static_cast<const std::string*>(nullptr);
+    };
+
+    std::string first = "devices/ugly-duckling/garden/commands/restart";
+    std::string last = "devices/ugly-duckling/garden/peripherals/door/commands/override";
+    std::string unknown = "devices/ugly-duckling/garden/functions/plot/config";
+    REQUIRE(dispatch(first) != nullptr);
+    REQUIRE(dispatch(last) != nullptr);
+    REQUIRE(dispatch(unknown) == nullptr);
+
+    BENCHMARK("first subscription") {
+        return dispatch(first);
+    };
+    BENCHMARK("last subscription") {
+        return dispatch(last);
+    };
+    BENCHMARK("no subscription") {
+        return dispatch(unknown);
+    };
+}
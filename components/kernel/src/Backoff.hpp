@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Produces exponentially growing delays between retries of a failing operation.
+ */
+class ExponentialBackoff {
+public:
+    ExponentialBackoff(milliseconds initialDelay, milliseconds maxDelay, double multiplier = 2.0)
+        : initialDelay(initialDelay)
+        , maxDelay(maxDelay)
+        , multiplier(multiplier)
+        , currentDelay(initialDelay) {
+    }
+
+    /**
+     * @brief Returns the delay to wait before the next attempt, and grows it for the one after.
+     */
+    milliseconds next() {
+        auto delay = currentDelay;
+        currentDelay = std::min(maxDelay, duration_cast<milliseconds>(currentDelay * multiplier));
+        attempts++;
+        return delay;
+    }
+
+    /**
+     * @brief Call after a successful attempt to start over from the initial delay.
+     */
+    void reset() {
+        currentDelay = initialDelay;
+        attempts = 0;
+    }
+
+    /**
+     * @brief Number of failed attempts since the last reset.
+     */
+    int getAttempts() const {
+        return attempts;
+    }
+
+private:
+    const milliseconds initialDelay;
+    const milliseconds maxDelay;
+    const double multiplier;
+
+    milliseconds currentDelay;
+    int attempts = 0;
+};
+
+}    // namespace farmhub::kernel
@@ -64,24 +64,57 @@ public:
 
 private:
     void checkBatteryVoltage(Task& task) {
-                auto currentVoltage = battery->getVoltage();
+        auto currentVoltage = battery->getVoltage();
+
+        // Don't wait for the average to catch up when the voltage is collapsing
+        if (isCritical(currentVoltage)) {
+            currentVoltage = confirmCritical();
+            if (isCritical(currentVoltage)) {
+                LOGE("Battery voltage critical (%d mV < %d mV), shutting down immediately",
+                    currentVoltage, battery->parameters.shutdownThreshold - EMERGENCY_SHUTDOWN_MARGIN);
+                shutdownManager->emergencyShutdown();
+                enterLowPowerDeepSleep();
+            }
+        }
+
         batteryVoltage.record(currentVoltage);
         auto voltage = batteryVoltage.getAverage();
 
         if (voltage != 0 && voltage < battery->parameters.shutdownThreshold) {
-            LOGI("Battery voltage low (%d mV < %d mV), starting shutdown process, will go to deep sleep in %lld seconds",
+            LOGI("Battery voltage low (%d mV < %d mV), starting shutdown process, will go to deep sleep in at most %lld seconds",
                 voltage, battery->parameters.shutdownThreshold, duration_cast<seconds>(LOW_BATTERY_SHUTDOWN_TIMEOUT).count());
 
             // TODO Publish all MQTT messages, then shut down WiFi, and _then_ start shutting down peripherals
             //      Doing so would result in less of a power spike, which can be important if the battery is already low
 
-            shutdownManager->startShutdown();
-            Task::delay(LOW_BATTERY_SHUTDOWN_TIMEOUT);
+            shutdownManager->shutdown(LOW_BATTERY_SHUTDOWN_TIMEOUT, false);
             enterLowPowerDeepSleep();
         }
         task.delayUntil(LOW_POWER_CHECK_INTERVAL);
     };
 
+    bool isCritical(int voltage) const {
+        return voltage > 0 && voltage < battery->parameters.shutdownThreshold - EMERGENCY_SHUTDOWN_MARGIN;
+    }
+
+    /**
+     * @brief Take a few more readings, so an ADC glitch or a load spike like a motor starting doesn't shut us down.
+     *
+     * @return the first reading that is not critical, or the last one if all of them are.
+     */
+    int confirmCritical() {
+        int voltage = 0;
+        for (int reading = 1; reading < EMERGENCY_SHUTDOWN_READINGS; reading++) {
+            Task::delay(EMERGENCY_SHUTDOWN_READING_INTERVAL);
+            voltage = battery->getVoltage();
+            if (!isCritical(voltage)) {
+                LOGD("Battery voltage recovered to %d mV, ignoring critical reading", voltage);
+                break;
+            }
+        }
+        return voltage;
+    }
+
     const std::shared_ptr<BatteryDriver> battery;
     const std::shared_ptr<ShutdownManager> shutdownManager;
 
@@ -98,6 +131,17 @@ private:
      * @brief Time to wait for shutdown process to finish before going to deep sleep.
      */
     static constexpr auto LOW_BATTERY_SHUTDOWN_TIMEOUT = 10s;
+
+    /**
+     * @brief Shut down right away when readings are this much below the shutdown threshold, in mV.
+     */
+    static constexpr int EMERGENCY_SHUTDOWN_MARGIN = 200;
+
+    /**
+     * @brief Consecutive critical readings needed for an emergency shutdown, taken in quick succession.
+     */
+    static constexpr int EMERGENCY_SHUTDOWN_READINGS = 3;
+    static constexpr milliseconds EMERGENCY_SHUTDOWN_READING_INTERVAL = 250ms;
 };
 
 }    // namespace farmhub::kernel
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Estimates the frequency error of the local clock from the offsets measured at each time sync.
+ *
+ * Between syncs the estimated drift is handed out as small corrections to slew the clock with.
+ * The more stable the estimate, the longer we can wait before the next sync.
+ */
+class ClockDiscipline {
+public:
+    ClockDiscipline(milliseconds minResyncInterval, milliseconds maxResyncInterval)
+        : minResyncInterval(minResyncInterval)
+        , maxResyncInterval(maxResyncInterval)
+        , resyncInterval(minResyncInterval) {
+    }
+
+    /**
+     * @brief Record the offset a successful sync applied to the clock.
+     *
+     * @param offset Reference time minus local time at the moment of the sync.
+     */
+    void recordSync(microseconds offset, steady_clock::time_point now) {
+        syncCount++;
+        lastOffset = offset;
+
+        if (lastSync.has_value() && std::chrono::abs(offset) <= MAX_DRIFT_OFFSET) {
+            auto elapsed = now - *lastSync;
+            if (elapsed >= MIN_DRIFT_INTERVAL) {
+                // The total error accrued is what we corrected ourselves plus what the sync had to fix
+                double measuredPpm = static_cast<double>((offset + appliedCorrection).count())
+                    / static_cast<double>(duration_cast<microseconds>(elapsed).count()) * 1e6;
+                updateEstimate(measuredPpm);
+            }
+        } else {
+            // The clock was stepped (e.g. set for the first time), we cannot infer drift from it
+            resyncInterval = minResyncInterval;
+        }
+
+        lastSync = now;
+        lastCorrection = now;
+        appliedCorrection = microseconds::zero();
+    }
+
+    /**
+     * @brief Returns the correction to apply to the clock for the time elapsed since the previous call.
+     */
+    microseconds takeCorrection(steady_clock::time_point now) {
+        if (!driftPpm.has_value() || !lastCorrection.has_value()) {
+            return microseconds::zero();
+        }
+        auto elapsed = duration_cast<microseconds>(now - *lastCorrection);
+        auto correction = microseconds(std::lround(*driftPpm * 1e-6 * static_cast<double>(elapsed.count())));
+        lastCorrection = now;
+        appliedCorrection += correction;
+        return correction;
+    }
+
+    std::optional<double> getDriftPpm() const {
+        return driftPpm;
+    }
+
+    microseconds getLastOffset() const {
+        return lastOffset;
+    }
+
+    int getSyncCount() const {
+        return syncCount;
+    }
+
+    milliseconds getResyncInterval() const {
+        return resyncInterval;
+    }
+
+private:
+    void updateEstimate(double measuredPpm) {
+        if (std::abs(measuredPpm) > MAX_DRIFT_PPM) {
+            // Not a plausible oscillator error, start learning from scratch
+            driftPpm.reset();
+            resyncInterval = minResyncInterval;
+            return;
+        }
+
+        if (!driftPpm.has_value()) {
+            driftPpm = measuredPpm;
+            return;
+        }
+
+        double residual = measuredPpm - *driftPpm;
+        *driftPpm += ESTIMATE_GAIN * residual;
+        if (std::abs(residual) < STABLE_PPM) {
+            resyncInterval = std::min(maxResyncInterval, resyncInterval * 2);
+        } else {
+            resyncInterval = minResyncInterval;
+        }
+    }
+
+    /**
+     * @brief Offsets larger than this are treated as the clock being set rather than drifting.
+     */
+    static constexpr microseconds MAX_DRIFT_OFFSET = 10s;
+
+    /**
+     * @brief Syncs closer than this to each other are too noisy to measure drift with.
+     */
+    static constexpr steady_clock::duration MIN_DRIFT_INTERVAL = 10min;
+
+    /**
+     * @brief Crystal oscillators are within ±100 ppm, even the internal RC one is well within this.
+     */
+    static constexpr double MAX_DRIFT_PPM = 500.0;
+
+    /**
+     * @brief When the residual after correction is below this, we consider the estimate stable.
+     */
+    static constexpr double STABLE_PPM = 2.0;
+
+    static constexpr double ESTIMATE_GAIN = 0.5;
+
+    const milliseconds minResyncInterval;
+    const milliseconds maxResyncInterval;
+
+    milliseconds resyncInterval;
+    std::optional<double> driftPpm;
+    std::optional<steady_clock::time_point> lastSync;
+    std::optional<steady_clock::time_point> lastCorrection;
+    microseconds appliedCorrection = microseconds::zero();
+    microseconds lastOffset = microseconds::zero();
+    int syncCount = 0;
+};
+
+}    // namespace farmhub::kernel
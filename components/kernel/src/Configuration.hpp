@@ -2,14 +2,18 @@
 
 #include <chrono>
 #include <concepts>
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <utility>
 
 #include <ArduinoJson.h>
 
+#include <Hash.hpp>
+
 using std::list;
 using std::ref;
 using std::reference_wrapper;
@@ -117,6 +121,17 @@ private:
 
 class EmptyConfiguration : public ConfigurationSection { };
 
+/**
+ * @brief Hash of configuration JSON, to tell if an update changes anything.
+ *
+ * Keys are hashed in the order they appear, which is stable for repeated deliveries of the same message.
+ */
+inline uint32_t hashConfigurationJson(JsonVariantConst json) {
+    std::string serialized;
+    serializeJson(json, serialized);
+    return fnv1a(serialized);
+}
+
 // Interface indicating the implementation supports configuration via TConfig
 template <std::derived_from<ConfigurationSection> TConfig>
 class HasConfig {
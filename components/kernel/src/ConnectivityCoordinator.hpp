@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include <ArduinoJson.h>
+
+#include <Backoff.hpp>
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+namespace farmhub::kernel {
+
+enum class Connection : uint8_t {
+    WiFi,
+    Mqtt,
+    Ntp,
+};
+
+/**
+ * @brief Decides when each network connection may try to (re)connect.
+ *
+ * Connections retry with exponential backoff, randomly shortened by up to half so that devices
+ * that lost the same AP or broker don't retry in lockstep. MQTT and NTP depend on WiFi: they are
+ * held back until WiFi has an IP, and when it gets one, they may try again right away, so the
+ * device recovers quickly.
+ *
+ * Attempts are counted per connection, and during outages (from losing WiFi or MQTT until
+ * MQTT is connected again) the time spent in connection attempts is tallied as radio-on time.
+ */
+class ConnectivityCoordinator {
+public:
+    /**
+     * @brief Produces uniformly distributed random numbers, like `esp_random()`.
+     */
+    using RandomSource = std::function<uint32_t()>;
+
+    ConnectivityCoordinator(RandomSource random, steady_clock::time_point now = steady_clock::now())
+        : random(std::move(random))
+        , outageReportedAt(now)
+        , lastReported(now) {
+        for (auto& link : links) {
+            link.nextAttemptAt = now;
+        }
+    }
+
+    /**
+     * @brief How long the connection should wait before its next attempt.
+     *
+     * @return zero if it can go ahead, or std::nullopt if it has to wait for WiFi to come up first.
+     */
+    std::optional<milliseconds> untilNextAttempt(Connection connection, steady_clock::time_point now = steady_clock::now()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (connection != Connection::WiFi && !linkOf(Connection::WiFi).up) {
+            return std::nullopt;
+        }
+        auto& link = linkOf(connection);
+        if (now >= link.nextAttemptAt) {
+            return 0ms;
+        }
+        return duration_cast<milliseconds>(link.nextAttemptAt - now);
+    }
+
+    void attemptStarted(Connection connection, steady_clock::time_point now = steady_clock::now()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& link = linkOf(connection);
+        link.attempts++;
+        link.attemptStartedAt = now;
+    }
+
+    /**
+     * @brief Record the outcome of an attempt; failures push the next attempt out with the backoff.
+     */
+    void attemptFinished(Connection connection, bool success, steady_clock::time_point now = steady_clock::now()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& link = linkOf(connection);
+        if (link.attemptStartedAt.has_value()) {
+            if (outageStartedAt.has_value()) {
+                radioOnTime += duration_cast<milliseconds>(now - *link.attemptStartedAt);
+            }
+            link.attemptStartedAt.reset();
+        }
+
+        if (!success) {
+            link.nextAttemptAt = now + jittered(link.backoff.next());
+            return;
+        }
+
+        bool wasUp = link.up;
+        link.up = true;
+        link.backoff.reset();
+        if (connection == Connection::WiFi && !wasUp) {
+            // Anything waiting on the network can try again right away
+            for (auto dependent : { Connection::Mqtt, Connection::Ntp }) {
+                auto& dependentLink = linkOf(dependent);
+                dependentLink.backoff.reset();
+                dependentLink.nextAttemptAt = now;
+            }
+        }
+        if (connection == Connection::Mqtt) {
+            endOutage(now);
+        }
+    }
+
+    /**
+     * @brief Record an established connection dropping; the first retry comes after the initial delay.
+     */
+    void connectionLost(Connection connection, steady_clock::time_point now = steady_clock::now()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& link = linkOf(connection);
+        if (!link.up) {
+            return;
+        }
+        link.up = false;
+        link.backoff.reset();
+        link.nextAttemptAt = now + jittered(link.backoff.next());
+        if (connection != Connection::Ntp && !outageStartedAt.has_value()) {
+            outageStartedAt = now;
+            outageReportedAt = now;
+            outageCount++;
+        }
+    }
+
+    /**
+     * @brief Reports attempts and outages since the last call.
+     */
+    void populateTelemetry(JsonObject& json, steady_clock::time_point now = steady_clock::now()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto interval = now - lastReported;
+        lastReported = now;
+
+        for (auto connection : { Connection::WiFi, Connection::Mqtt, Connection::Ntp }) {
+            auto& link = linkOf(connection);
+            auto linkJson = json[nameOf(connection)].to<JsonObject>();
+            linkJson["up"] = link.up;
+            linkJson["attempts"] = link.attempts;
+            if (interval > 0s) {
+                linkJson["attempts-per-hour"] = link.attempts * duration<double>(1h) / interval;
+            }
+            link.attempts = 0;
+        }
+
+        auto outageJson = json["outage"].to<JsonObject>();
+        auto reportedOutageTime = outageTime;
+        auto reportedRadioOnTime = radioOnTime;
+        if (outageStartedAt.has_value()) {
+            // Count the ongoing outage up to now, and continue from here next time
+            reportedOutageTime += duration_cast<milliseconds>(now - outageReportedAt);
+            outageReportedAt = now;
+            for (auto& link : links) {
+                if (link.attemptStartedAt.has_value()) {
+                    reportedRadioOnTime += duration_cast<milliseconds>(now - *link.attemptStartedAt);
+                    link.attemptStartedAt = now;
+                }
+            }
+        }
+        outageJson["count"] = outageCount;
+        outageJson["time"] = reportedOutageTime.count();
+        outageJson["radio-on"] = reportedRadioOnTime.count();
+        outageCount = 0;
+        outageTime = 0ms;
+        radioOnTime = 0ms;
+    }
+
+private:
+    struct Link {
+        ExponentialBackoff backoff;
+        bool up = false;
+        steady_clock::time_point nextAttemptAt;
+        std::optional<steady_clock::time_point> attemptStartedAt;
+        uint32_t attempts = 0;
+    };
+
+    Link& linkOf(Connection connection) {
+        return links[static_cast<size_t>(connection)];
+    }
+
+    void endOutage(steady_clock::time_point now) {
+        if (!outageStartedAt.has_value()) {
+            return;
+        }
+        outageTime += duration_cast<milliseconds>(now - outageReportedAt);
+        outageStartedAt.reset();
+    }
+
+    /**
+     * @brief Shorten the delay by a random amount of up to `JITTER` of it.
+     */
+    milliseconds jittered(milliseconds delay) {
+        double fraction = static_cast<double>(random()) / static_cast<double>(UINT32_MAX);
+        return delay - duration_cast<milliseconds>(delay * JITTER * fraction);
+    }
+
+    static const char* nameOf(Connection connection) {
+        switch (connection) {
+            case Connection::WiFi:
+                return "wifi";
+            case Connection::Mqtt:
+                return "mqtt";
+            case Connection::Ntp:
+            default:
+                return "ntp";
+        }
+    }
+
+    static constexpr double JITTER = 0.5;
+
+    const RandomSource random;
+
+    std::mutex mutex;
+    std::array<Link, 3> links {
+        // WiFi: give up on a missing AP slowly, but check back every few minutes
+        Link { .backoff = ExponentialBackoff(2s, 5min) },
+        // MQTT: the broker might be down for longer
+        Link { .backoff = ExponentialBackoff(2s, 10min) },
+        // NTP: the clock keeps running fine for a while without syncing
+        Link { .backoff = ExponentialBackoff(10s, 30min) },
+    };
+
+    std::optional<steady_clock::time_point> outageStartedAt;
+    steady_clock::time_point outageReportedAt;
+    uint32_t outageCount = 0;
+    milliseconds outageTime = 0ms;
+    milliseconds radioOnTime = 0ms;
+
+    steady_clock::time_point lastReported;
+};
+
+}    // namespace farmhub::kernel
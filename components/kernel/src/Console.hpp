@@ -1,8 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <driver/uart.h>
+#include <driver/uart_vfs.h>
+#include <esp_attr.h>
+#include <esp_cpu.h>
+#include <esp_rom_sys.h>
+
+#include <ArduinoJson.h>
+
 #include <Concurrent.hpp>
+#include <ConsoleBuffer.hpp>
 #include <Log.hpp>
-#include <utility>
+#include <LogRing.hpp>
+#include <Task.hpp>
 
 namespace farmhub::kernel {
 
@@ -17,15 +33,97 @@ namespace farmhub::kernel {
 #define FARMHUB_LOG_BOLD(COLOR) "\033[1;" COLOR "m"
 #define FARMHUB_LOG_RESET_COLOR "\033[0m"
 
+/**
+ * @brief The last log lines, kept in RTC memory so we can report them after a crash.
+ */
+using CrashLog = LogRing<2048>;
+static RTC_NOINIT_ATTR CrashLog::Storage crashLogStorage;
+
 class ConsoleProvider {
 public:
-    static void init(std::shared_ptr<Queue<LogRecord>> logRecords, Level recordedLevel) {
+    /**
+     * @param outputBufferSize buffer console output of this many bytes, and write it from a separate task;
+     *     0 to write synchronously from the logging task.
+     */
+    static void init(std::shared_ptr<Queue<LogRecord>> logRecords, Level recordedLevel, size_t outputBufferSize = 0, ConsoleOverflow overflow = ConsoleOverflow::DropOldest) {
         ConsoleProvider::logRecords = std::move(logRecords);
         ConsoleProvider::recordedLevel = recordedLevel;
+
+        if (outputBufferSize > 0) {
+            startOutputTask(outputBufferSize, overflow);
+        }
+
+        // Keep what was logged before the restart, then start over
+        {
+            std::lock_guard<std::mutex> lock(crashLogMutex);
+            if (crashLog.isValid()) {
+                for (auto& record : crashLog.read()) {
+                    previousLog.push_back(std::move(record.message));
+                }
+            }
+            crashLog.reset();
+        }
+
         ConsoleProvider::originalVprintf = esp_log_set_vprintf(ConsoleProvider::processLogFunc);
     }
 
+    /**
+     * @brief Returns the log lines recorded before the last restart, oldest first.
+     */
+    static std::vector<std::string> takePreviousLog() {
+        std::lock_guard<std::mutex> lock(crashLogMutex);
+        return std::exchange(previousLog, {});
+    }
+
+    static void populateTelemetry(JsonObject& json) {
+        std::lock_guard<std::mutex> lock(crashLogMutex);
+        auto crashLogJson = json["crash-log"].to<JsonObject>();
+        crashLogJson["writes"] = crashLogWrites;
+        if (crashLogWrites > 0) {
+            crashLogJson["average-cycles"] = crashLogWriteCycles / crashLogWrites;
+            crashLogJson["max-cycles"] = crashLogMaxWriteCycles;
+            crashLogJson["max-us"] = static_cast<double>(crashLogMaxWriteCycles) / esp_rom_get_cpu_ticks_per_us();
+        }
+        crashLogWrites = 0;
+        crashLogWriteCycles = 0;
+        crashLogMaxWriteCycles = 0;
+
+        json["suppressed"] = LogRateLimiter::takeTotalSuppressed();
+        json["repeated"] = repeatedLogCollapser.takeTotalRepeats();
+
+        if (output != nullptr) {
+            auto stats = output->takeStats();
+            auto outputJson = json["console"].to<JsonObject>();
+            outputJson["dropped"] = stats.droppedBytes;
+            outputJson["blocked"] = duration_cast<milliseconds>(stats.blockedTime).count();
+            outputJson["high-water"] = stats.highWater;
+        }
+    }
+
 private:
+    static void startOutputTask(size_t outputBufferSize, ConsoleOverflow overflow) {
+#if CONFIG_ESP_CONSOLE_UART
+        // Let the driver's interrupt drain the UART, and route everything else printed through it, too,
+        // so it doesn't interleave with what we write
+        ESP_ERROR_CHECK(uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, UART_RX_BUFFER_SIZE, UART_TX_BUFFER_SIZE, 0, nullptr, 0));
+        uart_vfs_dev_use_driver(CONFIG_ESP_CONSOLE_UART_NUM);
+#endif
+        output = std::make_unique<ConsoleBuffer>(outputBufferSize, overflow);
+        Task::loop("console", 2048, [](Task& /*task*/) {
+            std::array<char, 256> chunk {};
+            auto length = output->read(chunk.data(), chunk.size(), 1s);
+            if (length == 0) {
+                return;
+            }
+#if CONFIG_ESP_CONSOLE_UART
+            uart_write_bytes(CONFIG_ESP_CONSOLE_UART_NUM, chunk.data(), length);
+#else
+            fwrite(chunk.data(), 1, length, stdout);
+            fflush(stdout);
+#endif
+        });
+    }
+
     static int processLogFunc(const char* format, va_list args) {
         std::string message = renderMessage(format, args);
         return processLog(message);
@@ -56,49 +154,90 @@ private:
 
     static int processLogLine(const std::string& message) {
         Level level = getLevel(message);
+        Level previousLevel;
+        uint32_t repeats;
+        {
+            std::lock_guard<std::mutex> lock(partialMessageMutex);
+            if (repeatedLogCollapser.isRepeat(message)) {
+                return 0;
+            }
+            repeats = repeatedLogCollapser.takePendingRepeats();
+            previousLevel = lastLevel;
+            lastLevel = level;
+        }
+        int count = 0;
+        if (repeats > 0) {
+            count += processLogMessage(previousLevel, "Last message repeated " + std::to_string(repeats) + " times\n");
+        }
+        return count + processLogMessage(level, message);
+    }
+
+    static int processLogMessage(Level level, const std::string& message) {
         if (level <= recordedLevel) {
             logRecords->offer(level, message);
         }
+        if (level <= Level::Debug) {
+            recordInCrashLog(level, message);
+        }
 
-        int count = 0;
+        std::string line;
 #ifdef FARMHUB_DEBUG
         // Erase the current line
-        count += printf("\033[1G\033[0K");
+        line += "\033[1G\033[0K";
         switch (level) {
             case Level::Error:
-                count += printf(FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_RED));
+                line += FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_RED);
                 break;
             case Level::Warning:
-                count += printf(FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_BROWN));
+                line += FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_BROWN);
                 break;
             case Level::Info:
-                count += printf(FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_GREEN));
+                line += FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_GREEN);
                 break;
             case Level::Debug:
-                count += printf(FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_CYAN));
+                line += FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_CYAN);
                 break;
             case Level::Verbose:
-                count += printf(FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_BLUE));
+                line += FARMHUB_LOG_COLOR(FARMHUB_LOG_COLOR_BLUE);
                 break;
             default:
                 break;
         }
-#endif
-
-        count += printf("%s", message.c_str());
-
-#ifdef FARMHUB_DEBUG
+        line += message;
         switch (level) {
             case Level::Error:
             case Level::Warning:
             case Level::Info:
-                count += printf(FARMHUB_LOG_RESET_COLOR);
+                line += FARMHUB_LOG_RESET_COLOR;
                 break;
             default:
                 break;
         }
+#else
+        const std::string& line = message;
 #endif
-        return count;
+
+        if (output != nullptr) {
+            output->write(line);
+            return static_cast<int>(line.length());
+        }
+        return printf("%s", line.c_str());
+    }
+
+    static void recordInCrashLog(Level level, const std::string& message) {
+        // Leave out the trailing newline
+        size_t length = message.length();
+        if (length > 0 && message[length - 1] == '\n') {
+            length--;
+        }
+
+        std::lock_guard<std::mutex> lock(crashLogMutex);
+        auto startCycles = esp_cpu_get_cycle_count();
+        crashLog.write(static_cast<uint8_t>(level), message.data(), length);
+        uint32_t cycles = esp_cpu_get_cycle_count() - startCycles;
+        crashLogWrites++;
+        crashLogWriteCycles += cycles;
+        crashLogMaxWriteCycles = std::max(crashLogMaxWriteCycles, cycles);
     }
 
     static std::string renderMessage(const char* format, va_list args) {
@@ -145,7 +284,11 @@ private:
         }
     }
 
+    static constexpr int UART_RX_BUFFER_SIZE = 256;
+    static constexpr int UART_TX_BUFFER_SIZE = 1024;
+
     static vprintf_like_t originalVprintf;
+    static std::unique_ptr<ConsoleBuffer> output;
     static std::shared_ptr<Queue<LogRecord>> logRecords;
     static Level recordedLevel;
     static std::mutex bufferMutex;
@@ -154,14 +297,37 @@ private:
 
     static std::mutex partialMessageMutex;
     static std::string partialMessage;
+
+    /**
+     * @brief Print a summary for a run of repeated lines at least this often.
+     */
+    static constexpr uint32_t MAX_COLLAPSED_REPEATS = 100;
+    static RepeatedLogCollapser repeatedLogCollapser;
+    static Level lastLevel;
+
+    static std::mutex crashLogMutex;
+    static CrashLog crashLog;
+    static std::vector<std::string> previousLog;
+    static uint32_t crashLogWrites;
+    static uint64_t crashLogWriteCycles;
+    static uint32_t crashLogMaxWriteCycles;
 };
 
 vprintf_like_t ConsoleProvider::originalVprintf;
+std::unique_ptr<ConsoleBuffer> ConsoleProvider::output;
 std::shared_ptr<Queue<LogRecord>> ConsoleProvider::logRecords;
 Level ConsoleProvider::recordedLevel;
 std::mutex ConsoleProvider::bufferMutex;
 char ConsoleProvider::buffer[BUFFER_SIZE];
 std::mutex ConsoleProvider::partialMessageMutex;
 std::string ConsoleProvider::partialMessage;
+RepeatedLogCollapser ConsoleProvider::repeatedLogCollapser { ConsoleProvider::MAX_COLLAPSED_REPEATS };
+Level ConsoleProvider::lastLevel;
+std::mutex ConsoleProvider::crashLogMutex;
+CrashLog ConsoleProvider::crashLog { crashLogStorage };
+std::vector<std::string> ConsoleProvider::previousLog;
+uint32_t ConsoleProvider::crashLogWrites;
+uint64_t ConsoleProvider::crashLogWriteCycles;
+uint32_t ConsoleProvider::crashLogMaxWriteCycles;
 
 }    // namespace farmhub::kernel
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+#include <MemoryClass.hpp>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel {
+
+enum class ConsoleOverflow : uint8_t {
+    /**
+     * @brief Make room by discarding the oldest output, whole lines at a time.
+     */
+    DropOldest,
+    /**
+     * @brief Wait for the output to drain, up to a limit, then drop the oldest output.
+     */
+    Block,
+};
+
+/**
+ * @brief Ring buffer between the tasks that log and the one that writes to the console.
+ *
+ * Logging only costs a copy into the buffer, a single task drains it at the speed of the console.
+ * The buffer is bulk memory, so it lives in PSRAM on boards that have it.
+ */
+class ConsoleBuffer {
+public:
+    struct Stats {
+        uint32_t droppedBytes;
+        microseconds blockedTime;
+        size_t highWater;
+    };
+
+    ConsoleBuffer(size_t capacity, ConsoleOverflow overflow, milliseconds maxBlockTime = 100ms)
+        : buffer(allocateBlock(MemoryClass::Bulk, capacity))
+        , capacity(capacity)
+        , overflow(overflow)
+        , maxBlockTime(maxBlockTime) {
+    }
+
+    void write(std::string_view data) {
+        std::unique_lock lock(mutex);
+        if (data.size() > capacity) {
+            // Only the end of the output fits
+            droppedBytes += data.size() - capacity;
+            data.remove_prefix(data.size() - capacity);
+        }
+        if (overflow == ConsoleOverflow::Block && free() < data.size()) {
+            auto start = steady_clock::now();
+            spaceAvailable.wait_for(lock, maxBlockTime, [&] { return free() >= data.size(); });
+            blockedTime += duration_cast<microseconds>(steady_clock::now() - start);
+        }
+        if (free() < data.size()) {
+            dropOldest(data.size() - free());
+        }
+
+        size_t tail = (head + size) % capacity;
+        size_t first = std::min(data.size(), capacity - tail);
+        std::copy_n(data.data(), first, buffer.get() + tail);
+        std::copy_n(data.data() + first, data.size() - first, buffer.get());
+        size += data.size();
+        highWater = std::max(highWater, size);
+        dataAvailable.notify_one();
+    }
+
+    /**
+     * @brief Take buffered output, waiting for some to arrive if there is none.
+     *
+     * @return the number of bytes copied, 0 if nothing arrived in time.
+     */
+    size_t read(char* output, size_t maxLength, milliseconds timeout) {
+        std::unique_lock lock(mutex);
+        if (!dataAvailable.wait_for(lock, timeout, [&] { return size > 0; })) {
+            return 0;
+        }
+        size_t length = std::min({ size, maxLength, capacity - head });
+        std::copy_n(buffer.get() + head, length, output);
+        head = (head + length) % capacity;
+        size -= length;
+        spaceAvailable.notify_all();
+        return length;
+    }
+
+    Stats takeStats() {
+        std::lock_guard lock(mutex);
+        Stats stats {
+            .droppedBytes = droppedBytes,
+            .blockedTime = blockedTime,
+            .highWater = highWater,
+        };
+        droppedBytes = 0;
+        blockedTime = microseconds::zero();
+        highWater = size;
+        return stats;
+    }
+
+private:
+    size_t free() const {
+        return capacity - size;
+    }
+
+    /**
+     * @brief Drop at least the given number of bytes, and then up to the end of the line,
+     * so the console doesn't show half a line.
+     */
+    void dropOldest(size_t length) {
+        size_t dropped = 0;
+        while (size > 0 && (dropped < length || buffer[(head + capacity - 1) % capacity] != '\n')) {
+            head = (head + 1) % capacity;
+            size--;
+            dropped++;
+        }
+        droppedBytes += dropped;
+    }
+
+    MemoryBlock buffer;
+    const size_t capacity;
+    const ConsoleOverflow overflow;
+    const milliseconds maxBlockTime;
+
+    std::mutex mutex;
+    std::condition_variable dataAvailable;
+    std::condition_variable spaceAvailable;
+    size_t head = 0;
+    size_t size = 0;
+
+    uint32_t droppedBytes = 0;
+    microseconds blockedTime = microseconds::zero();
+    size_t highWater = 0;
+};
+
+}    // namespace farmhub::kernel
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <esp_core_dump.h>
+#include <esp_system.h>
 #include <mbedtls/base64.h>
 
 #include <ArduinoJson.h>
@@ -14,7 +18,9 @@ LOGGING_TAG(CRASH, "crash")
 
 class CrashManager {
 public:
-    static void handleCrashReport(JsonObject& json) {
+    static void handleCrashReport(JsonObject& json, const std::vector<std::string>& previousLog) {
+        reportPreviousLog(json, previousLog);
+
         NvsStore nvs("crash-report");
         switch (getCoreDumpStatus()) {
             case CoreDumpStatus::NoDump: {
@@ -38,6 +44,34 @@ public:
     }
 
 private:
+    /**
+     * @brief Ship the last log lines before an abnormal restart.
+     */
+    static void reportPreviousLog(JsonObject& json, const std::vector<std::string>& previousLog) {
+        switch (esp_reset_reason()) {
+            case ESP_RST_PANIC:
+            case ESP_RST_INT_WDT:
+            case ESP_RST_TASK_WDT:
+            case ESP_RST_WDT:
+            case ESP_RST_BROWNOUT:
+                break;
+            default:
+                return;
+        }
+        if (previousLog.empty()) {
+            return;
+        }
+        auto previousLogJson = json["previous-log"].to<JsonArray>();
+        auto first = previousLog.size() > MAX_PREVIOUS_LOG_LINES
+            ? previousLog.end() - MAX_PREVIOUS_LOG_LINES
+            : previousLog.begin();
+        for (auto it = first; it != previousLog.end(); it++) {
+            previousLogJson.add(*it);
+        }
+    }
+
+    static constexpr size_t MAX_PREVIOUS_LOG_LINES = 16;
+
     static void reportPreviousCrash(JsonObject& json, const std::string& crashedFirmwareVersion) {
         esp_core_dump_summary_t summary {};
         esp_err_t err = esp_core_dump_get_summary(&summary);
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <ArduinoJson.h>
+
+#include <Concurrent.hpp>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel {
+
+/**
+ * @brief A subsystem whose energy use is tracked by the EnergyLedger.
+ *
+ * Energy is modeled as the time the consumer is active multiplied by its typical current draw
+ * on top of the device's baseline. Activity can be reported either as explicit begin/end
+ * calls (overlapping activity is only counted once), or as a duration after the fact.
+ */
+class EnergyConsumer {
+public:
+    EnergyConsumer(std::string name, double modeledCurrent)
+        : name(std::move(name))
+        , modeledCurrent(modeledCurrent) {
+    }
+
+    void begin(steady_clock::time_point now = steady_clock::now()) {
+        Lock lock(mutex);
+        if (activeCount++ == 0) {
+            activeSince = now;
+        }
+    }
+
+    void end(steady_clock::time_point now = steady_clock::now()) {
+        Lock lock(mutex);
+        if (activeCount == 0) {
+            return;
+        }
+        if (--activeCount == 0) {
+            activeTime += duration_cast<microseconds>(now - activeSince);
+        }
+    }
+
+    void recordActive(microseconds duration) {
+        Lock lock(mutex);
+        activeTime += duration;
+    }
+
+    /**
+     * @brief Returns the time spent active since the last call, including ongoing activity.
+     */
+    microseconds drainActiveTime(steady_clock::time_point now) {
+        Lock lock(mutex);
+        auto result = activeTime;
+        activeTime = microseconds::zero();
+        if (activeCount > 0) {
+            result += duration_cast<microseconds>(now - activeSince);
+            activeSince = now;
+        }
+        return result;
+    }
+
+    const std::string name;
+
+    /**
+     * @brief Typical current draw while active, in mA.
+     */
+    const double modeledCurrent;
+
+private:
+    Mutex mutex;
+    int activeCount = 0;
+    steady_clock::time_point activeSince;
+    microseconds activeTime = microseconds::zero();
+};
+
+/**
+ * @brief Marks a consumer active for the lifetime of the guard; a null consumer is ignored.
+ */
+class EnergyActivity {
+public:
+    EnergyActivity(const std::shared_ptr<EnergyConsumer>& consumer)
+        : consumer(consumer) {
+        if (consumer != nullptr) {
+            consumer->begin();
+        }
+    }
+
+    ~EnergyActivity() {
+        if (consumer != nullptr) {
+            consumer->end();
+        }
+    }
+
+    // Delete copy constructor and assignment operator to prevent copying
+    EnergyActivity(const EnergyActivity&) = delete;
+    EnergyActivity& operator=(const EnergyActivity&) = delete;
+
+private:
+    const std::shared_ptr<EnergyConsumer> consumer;
+};
+
+/**
+ * @brief Integrates the modeled charge used by each registered subsystem per telemetry interval.
+ *
+ * When the battery can measure its discharge current, the model is continuously scaled
+ * to match the measurement.
+ */
+class EnergyLedger {
+public:
+    EnergyLedger(double baselineCurrent, steady_clock::time_point now = steady_clock::now())
+        : baselineCurrent(baselineCurrent)
+        , lastReported(now) {
+    }
+
+    std::shared_ptr<EnergyConsumer> registerConsumer(const std::string& name, double modeledCurrent) {
+        auto consumer = std::make_shared<EnergyConsumer>(name, modeledCurrent);
+        Lock lock(mutex);
+        consumers.push_back(consumer);
+        return consumer;
+    }
+
+    /**
+     * @brief Reports charge used since the last call.
+     *
+     * @param measuredCurrent Battery current in mA as reported by the fuel gauge, negative when discharging.
+     */
+    void populateTelemetry(JsonObject& json, std::optional<double> measuredCurrent, steady_clock::time_point now = steady_clock::now()) {
+        Lock lock(mutex);
+        auto interval = duration_cast<microseconds>(now - lastReported);
+        lastReported = now;
+        if (interval <= microseconds::zero()) {
+            return;
+        }
+
+        auto consumersJson = json["consumers"].to<JsonObject>();
+        double modeledCharge = charge(baselineCurrent, interval);
+        consumersJson["baseline"]["charge"] = modeledCharge * calibration;
+        for (auto& consumer : consumers) {
+            auto activeTime = consumer->drainActiveTime(now);
+            if (activeTime <= microseconds::zero()) {
+                continue;
+            }
+            double consumerCharge = charge(consumer->modeledCurrent, activeTime);
+            modeledCharge += consumerCharge;
+            auto consumerJson = consumersJson[consumer->name].to<JsonObject>();
+            consumerJson["active"] = duration_cast<milliseconds>(activeTime).count();
+            consumerJson["charge"] = consumerCharge * calibration;
+        }
+
+        double modeledCurrent = modeledCharge / toHours(interval);
+        json["interval"] = duration_cast<milliseconds>(interval).count();
+        json["charge"] = modeledCharge * calibration;
+        json["modeled-current"] = modeledCurrent * calibration;
+
+        // Only a discharging battery tells us about our own consumption
+        if (measuredCurrent.has_value() && *measuredCurrent < 0.0 && interval >= MIN_CALIBRATION_INTERVAL) {
+            json["measured-current"] = -*measuredCurrent;
+            calibrate(-*measuredCurrent, modeledCurrent);
+        }
+        json["calibration"] = calibration;
+    }
+
+    double getCalibration() const {
+        return calibration;
+    }
+
+private:
+    void calibrate(double measuredCurrent, double modeledCurrent) {
+        if (modeledCurrent <= 0.0) {
+            return;
+        }
+        double ratio = std::clamp(measuredCurrent / modeledCurrent, MIN_CALIBRATION, MAX_CALIBRATION);
+        calibration += CALIBRATION_GAIN * (ratio - calibration);
+    }
+
+    /**
+     * @brief Charge in mAh used by drawing the given current (mA) for the given time.
+     */
+    static double charge(double current, microseconds time) {
+        return current * toHours(time);
+    }
+
+    static double toHours(microseconds time) {
+        return duration_cast<duration<double, std::ratio<3600>>>(time).count();
+    }
+
+    /**
+     * @brief How quickly the model follows the measured current.
+     */
+    static constexpr double CALIBRATION_GAIN = 0.2;
+    static constexpr double MIN_CALIBRATION = 0.25;
+    static constexpr double MAX_CALIBRATION = 4.0;
+    static constexpr microseconds MIN_CALIBRATION_INTERVAL = 1s;
+
+    const double baselineCurrent;
+
+    Mutex mutex;
+    std::list<std::shared_ptr<EnergyConsumer>> consumers;
+    steady_clock::time_point lastReported;
+    double calibration = 1.0;
+};
+
+}    // namespace farmhub::kernel
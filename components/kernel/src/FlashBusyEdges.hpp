@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <esp_attr.h>
+
+#ifdef FARMHUB_COUNT_FLASH_BUSY_EDGES
+#include <esp_private/cache_utils.h>
+#endif
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Counts edges our GPIO interrupt handlers saw while the flash cache was disabled.
+ *
+ * NVS commits, OTA writes and similar flash operations disable the cache, and only IRAM-resident
+ * interrupt handlers run in the meantime. A non-zero count shows that edges did arrive during
+ * such windows, and were not lost.
+ *
+ * Only counts when built with `FARMHUB_COUNT_FLASH_BUSY_EDGES`, otherwise recording is a no-op.
+ */
+class FlashBusyEdges {
+public:
+    static constexpr bool ENABLED =
+#ifdef FARMHUB_COUNT_FLASH_BUSY_EDGES
+        true;
+#else
+        false;
+#endif
+
+    /**
+     * @brief Call from an interrupt handler for each edge it handles.
+     */
+    static IRAM_ATTR void record() {
+#ifdef FARMHUB_COUNT_FLASH_BUSY_EDGES
+        if (!spi_flash_cache_enabled()) {
+            count.fetch_add(1, std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    /**
+     * @brief Number of edges seen with the flash cache disabled since the last call.
+     */
+    static uint32_t take() {
+        return count.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    inline static std::atomic<uint32_t> count { 0 };
+};
+
+}    // namespace farmhub::kernel
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief 32-bit FNV-1a hash, usable at compile time.
+ *
+ * The seed is mixed into the offset basis, so different seeds give independent-ish hash functions.
+ */
+constexpr uint32_t fnv1a(std::string_view data, uint32_t seed = 0) {
+    uint32_t hash = 2166136261U ^ seed;
+    for (char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * @brief Final mixing step of MurmurHash3, spreading every input bit across the whole result.
+ *
+ * FNV-1a alone changes little in the top bits for names that only differ in their last character.
+ */
+constexpr uint32_t mix32(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BU;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35U;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+}    // namespace farmhub::kernel
@@ -10,6 +10,7 @@
 
 #include <Log.hpp>
 #include <NvsStore.hpp>
+#include <PowerManager.hpp>
 #include <Watchdog.hpp>
 #include <drivers/WiFiDriver.hpp>
 #include <utility>
@@ -83,7 +84,13 @@ private:
         esp_https_ota_config_t otaConfig = {};
         otaConfig.http_config = &httpConfig;
 
-        esp_err_t ret = esp_https_ota(&otaConfig);
+        esp_err_t ret;
+        {
+            // Downloading over TLS and verifying the image are both CPU-heavy
+            PerformanceLock updateLock("ota-update");
+            PowerManagementLockGuard burst(updateLock);
+            ret = esp_https_ota(&otaConfig);
+        }
         if (ret == ESP_OK) {
             LOGTI(UPDATE, "Update succeeded, rebooting in 5 seconds...");
             Task::delay(5s);
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace farmhub::kernel {
+
+// Generic, TU-stable type tokens: address of per-type inline variable
+template <typename T>
+inline constexpr char TypeTokenVar = 0;
+
+class InstanceRegistry;
+
+/**
+ * @brief A typed, stable reference to an instance in an `InstanceRegistry`.
+ *
+ * Obtained once by resolving a name, after which the instance can be accessed
+ * without locking or any further lookup. A default-constructed reference refers to nothing.
+ */
+template <typename T>
+class InstanceRef {
+public:
+    InstanceRef() = default;
+
+    explicit operator bool() const {
+        return registry != nullptr;
+    }
+
+    T& operator*() const;
+
+    T* operator->() const {
+        return &**this;
+    }
+
+    /**
+     * @brief Share ownership of the instance, for components that keep a `shared_ptr` to it.
+     */
+    std::shared_ptr<T> share() const;
+
+private:
+    InstanceRef(const InstanceRegistry* registry, uint32_t index)
+        : registry(registry)
+        , index(index) {
+    }
+
+    const InstanceRegistry* registry = nullptr;
+    uint32_t index = 0;
+
+    friend class InstanceRegistry;
+};
+
+/**
+ * @brief Append-only table of instances, indexed by the order they were added in.
+ *
+ * Slots are kept in segments that double in size, so the table grows without moving existing
+ * slots. Adding and resolving must happen under the owner's lock. As slots are never changed once
+ * written, accessing an instance needs no lock: a reference can only be obtained after its slot
+ * was written, and the owner's lock orders the two.
+ *
+ * The registry shares ownership of the instances with their owner; references must not outlive it.
+ */
+class InstanceRegistry {
+public:
+    InstanceRegistry() = default;
+    InstanceRegistry(const InstanceRegistry&) = delete;
+    InstanceRegistry& operator=(const InstanceRegistry&) = delete;
+
+    /**
+     * @brief Add an instance of the type identified by `typeTag`, returning its index.
+     */
+    uint32_t add(std::shared_ptr<void> instance, const void* typeTag) {
+        auto [segment, offset] = locate(count);
+        if (segment == SEGMENTS) {
+            throw std::length_error("Cannot register more than " + std::to_string(count) + " instances");
+        }
+        if (segments[segment] == nullptr) {
+            segments[segment] = std::make_unique<Slot[]>(FIRST_SEGMENT_SIZE << segment);
+        }
+        segments[segment][offset] = Slot { std::move(instance), typeTag };
+        return count++;
+    }
+
+    /**
+     * @brief Create a typed reference to the instance at the given index, checking its type once.
+     */
+    template <typename T>
+    InstanceRef<T> ref(uint32_t index) const {
+        if (index >= count) {
+            throw std::out_of_range("No instance at index " + std::to_string(index));
+        }
+        if (slot(index).typeTag != &TypeTokenVar<T>) {
+            throw std::runtime_error("Instance at index " + std::to_string(index) + " is not of the required type");
+        }
+        return InstanceRef<T>(this, index);
+    }
+
+    template <typename T>
+    T& get(InstanceRef<T> ref) const {
+        return *static_cast<T*>(slot(ref.index).instance.get());
+    }
+
+    template <typename T>
+    std::shared_ptr<T> share(InstanceRef<T> ref) const {
+        return std::static_pointer_cast<T>(slot(ref.index).instance);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+private:
+    struct Slot {
+        std::shared_ptr<void> instance;
+        const void* typeTag = nullptr;
+    };
+
+    static constexpr uint32_t FIRST_SEGMENT_SIZE = 8;
+    // Enough for over 100 million instances, i.e. no practical limit
+    static constexpr size_t SEGMENTS = 24;
+
+    struct Location {
+        size_t segment;
+        uint32_t offset;
+    };
+
+    /**
+     * @brief Segment `n` holds indices from `FIRST_SEGMENT_SIZE * (2^n - 1)` on.
+     */
+    static Location locate(uint32_t index) {
+        auto block = index / FIRST_SEGMENT_SIZE + 1;
+        auto segment = static_cast<size_t>(std::bit_width(block) - 1);
+        auto offset = index - FIRST_SEGMENT_SIZE * ((uint32_t { 1 } << segment) - 1);
+        return { segment, offset };
+    }
+
+    const Slot& slot(uint32_t index) const {
+        auto [segment, offset] = locate(index);
+        return segments[segment][offset];
+    }
+
+    std::array<std::unique_ptr<Slot[]>, SEGMENTS> segments {};
+    uint32_t count = 0;
+};
+
+template <typename T>
+T& InstanceRef<T>::operator*() const {
+    return registry->get(*this);
+}
+
+template <typename T>
+std::shared_ptr<T> InstanceRef<T>::share() const {
+    return registry->share(*this);
+}
+
+}    // namespace farmhub::kernel
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <ArduinoJson.h>
+
+#include <MemoryClass.hpp>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Bump allocator for ArduinoJson documents that are rebuilt over and over again.
+ *
+ * Memory is handed out from a single block that is kept between uses, so building
+ * a document does not touch the general heap. Freed memory is reclaimed when it was
+ * the most recent allocation, or when everything has been freed. Allocations beyond
+ * the capacity fail, which ArduinoJson reports via `overflowed()`.
+ *
+ * Between uses the block is grown to fit the observed high-water mark, up to a maximum.
+ * The block is bulk memory, so it lives in PSRAM on boards that have it.
+ */
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    JsonArena(size_t initialCapacity, size_t maxCapacity)
+        : maxCapacity(maxCapacity) {
+        resize(std::min(initialCapacity, maxCapacity));
+    }
+
+    void* allocate(size_t size) override {
+        size_t needed = HEADER_SIZE + align(size);
+        if (needed > capacity - used) {
+            exhausted = true;
+            return nullptr;
+        }
+        uint8_t* block = buffer.get() + used;
+        setBlockSize(block, size);
+        used += needed;
+        highWater = std::max(highWater, used);
+        liveAllocations++;
+        return block + HEADER_SIZE;
+    }
+
+    void deallocate(void* ptr) override {
+        if (ptr == nullptr) {
+            return;
+        }
+        uint8_t* block = static_cast<uint8_t*>(ptr) - HEADER_SIZE;
+        liveAllocations--;
+        if (liveAllocations == 0) {
+            used = 0;
+        } else if (isLastBlock(block)) {
+            used = block - buffer.get();
+        }
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (ptr == nullptr) {
+            return allocate(newSize);
+        }
+        uint8_t* block = static_cast<uint8_t*>(ptr) - HEADER_SIZE;
+
+        // The most recent allocation can be resized in place
+        if (isLastBlock(block)) {
+            size_t offset = block - buffer.get();
+            size_t needed = HEADER_SIZE + align(newSize);
+            if (needed > capacity - offset) {
+                exhausted = true;
+                return nullptr;
+            }
+            setBlockSize(block, newSize);
+            used = offset + needed;
+            highWater = std::max(highWater, used);
+            return ptr;
+        }
+
+        void* newPtr = allocate(newSize);
+        if (newPtr == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(newPtr, ptr, std::min(getBlockSize(block), newSize));
+        deallocate(ptr);
+        return newPtr;
+    }
+
+    /**
+     * @brief Grow the arena if the last use came close to, or ran out of, its capacity.
+     *
+     * Only has an effect when all memory has been freed. Resets the high-water mark.
+     */
+    void fit() {
+        if (liveAllocations != 0) {
+            return;
+        }
+        size_t wanted = highWater + highWater / 4;
+        if (exhausted) {
+            wanted = std::max(wanted, capacity * 2);
+        }
+        wanted = std::min(align(wanted), maxCapacity);
+        if (wanted > capacity) {
+            resize(wanted);
+        }
+        highWater = 0;
+        exhausted = false;
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    /**
+     * @brief Most bytes in use at any time since the last call to `fit()`.
+     */
+    size_t getHighWater() const {
+        return highWater;
+    }
+
+    /**
+     * @brief Whether an allocation failed since the last call to `fit()`.
+     */
+    bool isExhausted() const {
+        return exhausted;
+    }
+
+private:
+    static constexpr size_t ALIGNMENT = 8;
+    static constexpr size_t HEADER_SIZE = (sizeof(size_t) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    static size_t align(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    static size_t getBlockSize(const uint8_t* block) {
+        size_t size;
+        std::memcpy(&size, block, sizeof(size));
+        return size;
+    }
+
+    static void setBlockSize(uint8_t* block, size_t size) {
+        std::memcpy(block, &size, sizeof(size));
+    }
+
+    bool isLastBlock(const uint8_t* block) const {
+        return block + HEADER_SIZE + align(getBlockSize(block)) == buffer.get() + used;
+    }
+
+    void resize(size_t newCapacity) {
+        buffer.reset();
+        buffer = allocateBlock(MemoryClass::Bulk, newCapacity);
+        capacity = newCapacity;
+        used = 0;
+    }
+
+    const size_t maxCapacity;
+
+    MemoryBlock buffer;
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t highWater = 0;
+    size_t liveAllocations = 0;
+    bool exhausted = false;
+};
+
+}    // namespace farmhub::kernel
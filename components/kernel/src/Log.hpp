@@ -1,11 +1,14 @@
 #pragma once
 
-#include <string.h>
-
+#include <cinttypes>
 #include <string>
+#include <type_traits>
 
 #include <esp_log.h>
 
+#include <LogLevels.hpp>
+#include <LogRateLimiter.hpp>
+
 namespace farmhub::kernel {
 
 enum class Level : uint8_t {
@@ -35,43 +38,120 @@ struct LogRecord {
 #define FARMHUB_LOG_VERBOSE ""
 #endif
 
-// helper: check if substring is in comma-separated list
-inline bool loggingTagInList(const char* tag, const char* list) {
-    if (list == nullptr) {
-        return false;
+// Maximum level compiled in for specific tags, like "mqtt=info,wifi=debug"; other tags use LOG_LOCAL_LEVEL
+#ifndef FARMHUB_LOG_MAX_LEVELS
+#define FARMHUB_LOG_MAX_LEVELS ""
+#endif
+
+/**
+ * @brief Maximum number of tags with their own runtime level.
+ */
+static constexpr size_t MAX_LOG_TAGS = 48;
+
+inline constinit LogLevelTable<MAX_LOG_TAGS> logLevels;
+
+consteval esp_log_level_t compiledLogLevel(const char* name) {
+    auto level = logLevelInList(name, FARMHUB_LOG_MAX_LEVELS);
+    return static_cast<esp_log_level_t>(level.value_or(LOG_LOCAL_LEVEL));
+}
+
+consteval esp_log_level_t defaultLogLevel(const char* name) {
+    return logTagInList(name, FARMHUB_LOG_VERBOSE) ? ESP_LOG_VERBOSE : FARMHUB_LOG_LEVEL;
+}
+
+/**
+ * @brief A logging tag with its own runtime level, looked up via its slot in `logLevels`.
+ *
+ * Each translation unit using a tag constructs its own instance, all sharing the same slot.
+ */
+class LogTag {
+public:
+    LogTag(const char* name, esp_log_level_t maxLevel, esp_log_level_t defaultLevel)
+        : name(name)
+        , index(registerTag(name, maxLevel, defaultLevel)) {
     }
-    const char* p = strstr(list, tag);
-    while (p != nullptr) {
-        const char* after = p + strlen(tag);
-        if ((p == list || p[-1] == ',') && (*after == '\0' || *after == ',')) {
-            return true;
+
+    const char* const name;
+    const uint8_t index;
+
+private:
+    static uint8_t registerTag(const char* name, esp_log_level_t maxLevel, esp_log_level_t defaultLevel) {
+        bool known = logLevels.find(name).has_value();
+        auto index = logLevels.registerTag(name, maxLevel, defaultLevel);
+        if (!known) {
+            // Filtering happens in our macros, let everything we pass on through
+            esp_log_level_set(name, ESP_LOG_VERBOSE);
         }
-        p = strstr(after, tag);
+        return index;
+    }
+};
+
+/**
+ * @brief A logging tag that knows its maximum level at compile time, so that more detailed
+ * levels can be compiled out entirely.
+ */
+template <esp_log_level_t MaxLevel>
+class StaticLogTag : public LogTag {
+public:
+    static constexpr esp_log_level_t MAX_LEVEL = MaxLevel;
+
+    StaticLogTag(const char* name, esp_log_level_t defaultLevel)
+        : LogTag(name, MaxLevel, defaultLevel) {
+    }
+};
+
+template <esp_log_level_t Level, typename Tag>
+consteval bool isLogLevelCompiledIn() {
+    if constexpr (requires { Tag::MAX_LEVEL; }) {
+        return Level <= Tag::MAX_LEVEL;
+    } else {
+        return Level <= LOG_LOCAL_LEVEL;
     }
-    return false;
 }
 
 // LOGGING_TAG(varName, "tagname")
-#define LOGGING_TAG(varName, name)                             \
-    static constexpr const char* varName = "farmhub:" name;    \
-    struct varName##_LoggerInit {                              \
-        varName##_LoggerInit() {                               \
-            esp_log_level_t lvl = FARMHUB_LOG_LEVEL;           \
-            if (loggingTagInList(name, FARMHUB_LOG_VERBOSE)) { \
-                lvl = ESP_LOG_VERBOSE;                         \
-            }                                                  \
-            esp_log_level_set(varName, lvl);                   \
-        }                                                      \
-    };                                                         \
-    static const varName##_LoggerInit varName##_logger_init;
+#define LOGGING_TAG(varName, name)                                                                 \
+    static const ::farmhub::kernel::StaticLogTag<::farmhub::kernel::compiledLogLevel(name)> varName { \
+        "farmhub:" name, ::farmhub::kernel::defaultLogLevel(name)                                  \
+    };
 
 LOGGING_TAG(GLOBAL, "global")
 
-#define LOGTE(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
-#define LOGTW(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
-#define LOGTI(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
-#define LOGTD(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
-#define LOGTV(tag, format, ...) ESP_LOG_LEVEL_LOCAL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+// Levels above the tag's compile-time maximum leave no code behind; others cost a table lookup.
+// Enabled messages are written by ESP-IDF, which still checks the tag's level by name; as we set
+// every tag to verbose there, that check always passes, and it is cheap next to formatting the message.
+#define FARMHUB_LOG(level, tag, format, ...)                                                                        \
+    do {                                                                                                            \
+        if constexpr (::farmhub::kernel::isLogLevelCompiledIn<level, std::remove_cvref_t<decltype(tag)>>()) {       \
+            if (::farmhub::kernel::logLevels.isEnabled((tag).index, level)) {                                       \
+                ESP_LOG_LEVEL(level, (tag).name, format, ##__VA_ARGS__);                                            \
+            }                                                                                                       \
+        }                                                                                                           \
+    } while (0)
+
+// Rate limited per call site, reporting the number of messages suppressed with the next one let through
+#define FARMHUB_LOG_RATE_LIMITED(level, tag, format, ...)                                                           \
+    do {                                                                                                            \
+        if constexpr (::farmhub::kernel::isLogLevelCompiledIn<level, std::remove_cvref_t<decltype(tag)>>()) {       \
+            if (::farmhub::kernel::logLevels.isEnabled((tag).index, level)) {                                       \
+                static ::farmhub::kernel::LogRateLimiter farmhubLogRateLimiter;                                     \
+                if (farmhubLogRateLimiter.allow(esp_log_timestamp())) {                                             \
+                    uint32_t farmhubLogSuppressed = farmhubLogRateLimiter.takeSuppressed();                         \
+                    if (farmhubLogSuppressed > 0) {                                                                 \
+                        ESP_LOG_LEVEL(level, (tag).name, "Suppressed %" PRIu32 " messages like the next one",       \
+                            farmhubLogSuppressed);                                                                  \
+                    }                                                                                               \
+                    ESP_LOG_LEVEL(level, (tag).name, format, ##__VA_ARGS__);                                        \
+                }                                                                                                   \
+            }                                                                                                       \
+        }                                                                                                           \
+    } while (0)
+
+#define LOGTE(tag, format, ...) FARMHUB_LOG_RATE_LIMITED(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define LOGTW(tag, format, ...) FARMHUB_LOG_RATE_LIMITED(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define LOGTI(tag, format, ...) FARMHUB_LOG(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define LOGTD(tag, format, ...) FARMHUB_LOG(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define LOGTV(tag, format, ...) FARMHUB_LOG(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
 
 #define LOGE(format, ...) LOGTE(GLOBAL, format, ##__VA_ARGS__)
 #define LOGW(format, ...) LOGTW(GLOBAL, format, ##__VA_ARGS__)
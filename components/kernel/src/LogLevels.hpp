@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Log levels as numbered by ESP-IDF's `esp_log_level_t`, from none (0) to verbose (5).
+ */
+constexpr uint8_t LOG_LEVEL_NONE = 0;
+constexpr uint8_t LOG_LEVEL_VERBOSE = 5;
+
+constexpr std::optional<uint8_t> parseLogLevel(std::string_view level) {
+    if (level.size() == 1 && level[0] >= '0' && level[0] <= '0' + LOG_LEVEL_VERBOSE) {
+        return level[0] - '0';
+    }
+    constexpr std::array<std::string_view, LOG_LEVEL_VERBOSE + 1> names {
+        "none", "error", "warn", "info", "debug", "verbose"
+    };
+    for (uint8_t i = 0; i < names.size(); i++) {
+        // Accept both the full name and its first letter, e.g. "debug" or "D"
+        if (level == names[i] || (level.size() == 1 && (level[0] | 0x20) == names[i][0])) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+constexpr const char* logLevelName(uint8_t level) {
+    constexpr std::array<const char*, LOG_LEVEL_VERBOSE + 1> names {
+        "none", "error", "warn", "info", "debug", "verbose"
+    };
+    return level <= LOG_LEVEL_VERBOSE ? names[level] : "unknown";
+}
+
+/**
+ * @brief Check if the tag is in a comma-separated list, like "mqtt,wifi".
+ */
+constexpr bool logTagInList(std::string_view tag, std::string_view list) {
+    while (!list.empty()) {
+        auto end = list.find(',');
+        if (list.substr(0, end) == tag) {
+            return true;
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(end + 1);
+    }
+    return false;
+}
+
+/**
+ * @brief Look up the level of a tag in a comma-separated list, like "mqtt=debug,wifi=2".
+ *
+ * Meant to be evaluated at compile time, so the list can come from a build flag.
+ */
+constexpr std::optional<uint8_t> logLevelInList(std::string_view tag, std::string_view list) {
+    while (!list.empty()) {
+        auto end = list.find(',');
+        auto entry = list.substr(0, end);
+        auto separator = entry.find('=');
+        if (separator != std::string_view::npos && entry.substr(0, separator) == tag) {
+            return parseLogLevel(entry.substr(separator + 1));
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(end + 1);
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Runtime log levels of tags, indexed by a slot assigned to each tag when it is registered.
+ *
+ * Checking whether a level is enabled is a single array lookup; names are only compared when
+ * registering a tag, or when looking one up by name, e.g. to change its level.
+ *
+ * Tags must be registered before any other task is started, i.e. during static initialization.
+ * When the table is full, further tags share the last slot.
+ */
+template <size_t Capacity>
+class LogLevelTable {
+public:
+    static_assert(Capacity > 0 && Capacity <= UINT8_MAX, "Slots are indexed by a byte");
+
+    constexpr LogLevelTable() = default;
+
+    /**
+     * @brief Register a tag, or find its slot if it's already registered.
+     *
+     * @param maxLevel the level the tag was compiled with, the runtime level can never go above it.
+     */
+    uint8_t registerTag(const char* name, uint8_t maxLevel, uint8_t level) {
+        if (auto existing = find(name)) {
+            return *existing;
+        }
+        if (count == Capacity) {
+            return Capacity - 1;
+        }
+        auto index = static_cast<uint8_t>(count);
+        names[index] = name;
+        maxLevels[index] = maxLevel;
+        levels[index].store(level < maxLevel ? level : maxLevel, std::memory_order_relaxed);
+        count++;
+        return index;
+    }
+
+    bool isEnabled(uint8_t index, uint8_t level) const {
+        return levels[index].load(std::memory_order_relaxed) >= level;
+    }
+
+    uint8_t getLevel(uint8_t index) const {
+        return levels[index].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Change the runtime level of a tag, capped at the level it was compiled with.
+     *
+     * @return the level actually set.
+     */
+    uint8_t setLevel(uint8_t index, uint8_t level) {
+        if (level > maxLevels[index]) {
+            level = maxLevels[index];
+        }
+        levels[index].store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    uint8_t getMaxLevel(uint8_t index) const {
+        return maxLevels[index];
+    }
+
+    const char* getName(uint8_t index) const {
+        return names[index];
+    }
+
+    std::optional<uint8_t> find(std::string_view name) const {
+        for (size_t index = 0; index < count; index++) {
+            if (name == names[index]) {
+                return static_cast<uint8_t>(index);
+            }
+        }
+        return std::nullopt;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+private:
+    std::array<std::atomic<uint8_t>, Capacity> levels {};
+    std::array<uint8_t, Capacity> maxLevels {};
+    std::array<const char*, Capacity> names {};
+    size_t count = 0;
+};
+
+}    // namespace farmhub::kernel
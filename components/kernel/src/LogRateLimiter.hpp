@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Limits how many times a single logging call site can log within a time window.
+ *
+ * Each call site gets its own static instance, so checking whether to log is only
+ * a few loads, a comparison and an increment.
+ */
+class LogRateLimiter {
+public:
+    /**
+     * @brief Set how many messages each call site can log per window.
+     */
+    static void configure(uint32_t burst, uint32_t windowMs) {
+        LogRateLimiter::burst.store(burst, std::memory_order_relaxed);
+        LogRateLimiter::windowMs.store(windowMs, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Whether the call site can log now, counting the message as suppressed if not.
+     */
+    bool allow(uint32_t nowMs) {
+        if (nowMs - windowStart.load(std::memory_order_relaxed) >= windowMs.load(std::memory_order_relaxed)) {
+            windowStart.store(nowMs, std::memory_order_relaxed);
+            count.store(0, std::memory_order_relaxed);
+        }
+        if (count.fetch_add(1, std::memory_order_relaxed) < burst.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        totalSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Number of messages suppressed at this call site since the last call.
+     */
+    uint32_t takeSuppressed() {
+        return suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Number of messages suppressed at all call sites since the last call.
+     */
+    static uint32_t takeTotalSuppressed() {
+        return totalSuppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> windowStart { 0 };
+    std::atomic<uint32_t> count { 0 };
+    std::atomic<uint32_t> suppressed { 0 };
+
+    static inline std::atomic<uint32_t> burst { 10 };
+    static inline std::atomic<uint32_t> windowMs { 60 * 1000 };
+    static inline std::atomic<uint32_t> totalSuppressed { 0 };
+};
+
+/**
+ * @brief Drops log lines that repeat the previous line, only differing in their timestamp.
+ */
+class RepeatedLogCollapser {
+public:
+    explicit RepeatedLogCollapser(uint32_t maxRepeats)
+        : maxRepeats(maxRepeats) {
+    }
+
+    /**
+     * @brief Check a line about to be logged.
+     *
+     * @return true if the line is a repeat of the previous line and should be dropped.
+     */
+    bool isRepeat(std::string_view line) {
+        char level = line.empty() ? '\0' : line[0];
+        auto key = stripTimestamp(line);
+        bool same = level == lastLevel && key == lastKey;
+        if (same && repeats < maxRepeats) {
+            repeats++;
+            totalRepeats++;
+            return true;
+        }
+        pendingRepeats = repeats;
+        repeats = 0;
+        if (!same) {
+            lastLevel = level;
+            lastKey.assign(key);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Number of times the previous line was repeated before the line just checked.
+     */
+    uint32_t takePendingRepeats() {
+        auto result = pendingRepeats;
+        pendingRepeats = 0;
+        return result;
+    }
+
+    /**
+     * @brief Number of lines dropped since the last call.
+     */
+    uint32_t takeTotalRepeats() {
+        auto result = totalRepeats;
+        totalRepeats = 0;
+        return result;
+    }
+
+private:
+    /**
+     * @brief Lines look like 'E (12345) tag: message', we ignore the timestamp.
+     */
+    static std::string_view stripTimestamp(std::string_view line) {
+        if (line.length() > 3 && line[1] == ' ' && line[2] == '(') {
+            auto end = line.find(") ", 3);
+            if (end != std::string_view::npos) {
+                return line.substr(end + 2);
+            }
+        }
+        return line;
+    }
+
+    const uint32_t maxRepeats;
+    char lastLevel = '\0';
+    std::string lastKey;
+    uint32_t repeats = 0;
+    uint32_t pendingRepeats = 0;
+    uint32_t totalRepeats = 0;
+};
+
+}    // namespace farmhub::kernel
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief A compact ring of log records in a fixed block of memory that survives restarts.
+ *
+ * Each record is stored as a length byte, a level byte, and the message itself. When the ring
+ * is full, the oldest records are dropped to make room. The storage is meant to be placed in
+ * memory that is not initialized on boot, so it must be validated before it can be read.
+ */
+template <size_t Capacity>
+class LogRing {
+public:
+    struct Storage {
+        uint32_t magic;
+        uint32_t start;
+        uint32_t used;
+        uint32_t check;
+        uint8_t data[Capacity];
+    };
+
+    struct Record {
+        uint8_t level;
+        std::string message;
+    };
+
+    static constexpr size_t MAX_MESSAGE_LENGTH = 255;
+
+    explicit LogRing(Storage& storage)
+        : storage(storage) {
+    }
+
+    /**
+     * @brief Check if the storage holds a consistent ring, e.g. one written before a restart.
+     */
+    bool isValid() const {
+        if (storage.magic != MAGIC
+            || storage.start >= Capacity
+            || storage.used > Capacity
+            || storage.check != computeCheck()) {
+            return false;
+        }
+        size_t position = storage.start;
+        size_t remaining = storage.used;
+        while (remaining > 0) {
+            if (remaining < HEADER_SIZE) {
+                return false;
+            }
+            size_t size = HEADER_SIZE + storage.data[position];
+            if (size > remaining || storage.data[(position + 1) % Capacity] > MAX_LEVEL) {
+                return false;
+            }
+            position = (position + size) % Capacity;
+            remaining -= size;
+        }
+        return true;
+    }
+
+    void reset() {
+        storage.magic = MAGIC;
+        storage.start = 0;
+        storage.used = 0;
+        storage.check = computeCheck();
+    }
+
+    void write(uint8_t level, const char* message, size_t length) {
+        length = std::min(length, MAX_MESSAGE_LENGTH);
+        size_t size = HEADER_SIZE + length;
+        while (Capacity - storage.used < size) {
+            dropOldest();
+        }
+
+        size_t end = (storage.start + storage.used) % Capacity;
+        storage.data[end] = static_cast<uint8_t>(length);
+        storage.data[(end + 1) % Capacity] = level;
+        copyIn((end + HEADER_SIZE) % Capacity, message, length);
+        storage.used += size;
+        storage.check = computeCheck();
+    }
+
+    /**
+     * @brief Returns the records in the ring from oldest to newest.
+     */
+    std::vector<Record> read() const {
+        std::vector<Record> records;
+        size_t position = storage.start;
+        size_t remaining = storage.used;
+        while (remaining > 0) {
+            size_t length = storage.data[position];
+            Record record {
+                .level = storage.data[(position + 1) % Capacity],
+                .message = std::string(length, '\0'),
+            };
+            copyOut((position + HEADER_SIZE) % Capacity, record.message.data(), length);
+            records.push_back(std::move(record));
+            position = (position + HEADER_SIZE + length) % Capacity;
+            remaining -= HEADER_SIZE + length;
+        }
+        return records;
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x106B1B6E;
+    static constexpr size_t HEADER_SIZE = 2;
+    static constexpr uint8_t MAX_LEVEL = 6;
+
+    static_assert(Capacity > HEADER_SIZE + MAX_MESSAGE_LENGTH, "Ring must fit at least the longest message");
+
+    uint32_t computeCheck() const {
+        return storage.magic ^ (storage.start * 0x9E3779B1) ^ (storage.used * 0x85EBCA77);
+    }
+
+    void dropOldest() {
+        size_t size = HEADER_SIZE + storage.data[storage.start];
+        storage.start = (storage.start + size) % Capacity;
+        storage.used -= size;
+    }
+
+    void copyIn(size_t position, const char* source, size_t length) {
+        size_t first = std::min(length, Capacity - position);
+        std::memcpy(storage.data + position, source, first);
+        std::memcpy(storage.data, source + first, length - first);
+    }
+
+    void copyOut(size_t position, char* target, size_t length) const {
+        size_t first = std::min(length, Capacity - position);
+        std::memcpy(target, storage.data + position, first);
+        std::memcpy(target + first, storage.data, length - first);
+    }
+
+    Storage& storage;
+};
+
+}    // namespace farmhub::kernel
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief LZSS compression with a small fixed window, for payloads full of repeated keys like our JSON.
+ *
+ * Compressed data starts with a two-byte marker that cannot start a JSON document, followed by
+ * the uncompressed size as a 32-bit little-endian number. Then come groups of up to eight items,
+ * each group preceded by a flag byte. A set flag bit marks a back-reference of two bytes
+ * (10 bits distance, 6 bits length), a clear bit a literal byte.
+ *
+ * The compressor keeps its match-finding state between uses, so compressing never allocates
+ * beyond the output.
+ */
+class LzssCompressor {
+public:
+    static constexpr size_t WINDOW_SIZE = 1024;
+    static constexpr size_t MIN_MATCH = 3;
+    static constexpr size_t MAX_MATCH = MIN_MATCH + 63;
+
+    /**
+     * @brief Positions are tracked in 16 bits, which limits the size of the input.
+     */
+    static constexpr size_t MAX_INPUT_SIZE = UINT16_MAX - 1;
+
+    static constexpr uint8_t MARKER = 0x1F;
+    static constexpr uint8_t METHOD = 'L';
+    static constexpr size_t HEADER_SIZE = 6;
+
+    /**
+     * @brief Compress the input into the output, replacing its contents.
+     *
+     * @return false if the input is too large to compress.
+     */
+    bool compress(std::string_view input, std::string& output) {
+        if (input.size() > MAX_INPUT_SIZE) {
+            return false;
+        }
+        head.fill(NO_POSITION);
+
+        output.clear();
+        output.reserve(HEADER_SIZE + input.size() / 2);
+        output.push_back(static_cast<char>(MARKER));
+        output.push_back(static_cast<char>(METHOD));
+        for (int shift = 0; shift < 32; shift += 8) {
+            output.push_back(static_cast<char>((input.size() >> shift) & 0xFF));
+        }
+
+        size_t flagPosition = 0;
+        int flagBit = 8;
+        size_t position = 0;
+        while (position < input.size()) {
+            if (flagBit == 8) {
+                flagPosition = output.size();
+                output.push_back(0);
+                flagBit = 0;
+            }
+
+            auto match = findMatch(input, position);
+            if (match.length >= MIN_MATCH) {
+                output[flagPosition] = static_cast<char>(output[flagPosition] | (1 << flagBit));
+                auto code = static_cast<uint16_t>(((match.distance - 1) << 6) | (match.length - MIN_MATCH));
+                output.push_back(static_cast<char>(code >> 8));
+                output.push_back(static_cast<char>(code & 0xFF));
+                for (size_t i = 0; i < match.length; i++) {
+                    insert(input, position + i);
+                }
+                position += match.length;
+            } else {
+                output.push_back(input[position]);
+                insert(input, position);
+                position++;
+            }
+            flagBit++;
+        }
+        return true;
+    }
+
+    static bool isCompressed(std::string_view data) {
+        return data.size() >= HEADER_SIZE
+            && static_cast<uint8_t>(data[0]) == MARKER
+            && static_cast<uint8_t>(data[1]) == METHOD;
+    }
+
+    /**
+     * @brief Decompress the input into the output, replacing its contents.
+     *
+     * The size in the header is checked against `maxSize` before any memory is reserved for the output.
+     *
+     * @return false if the input is not valid compressed data, or it would decompress to more than `maxSize` bytes.
+     */
+    static bool decompress(std::string_view input, std::string& output, size_t maxSize = MAX_INPUT_SIZE) {
+        if (!isCompressed(input)) {
+            return false;
+        }
+        size_t size = 0;
+        for (int i = 0; i < 4; i++) {
+            size |= static_cast<size_t>(static_cast<uint8_t>(input[2 + i])) << (i * 8);
+        }
+        if (size > std::min(maxSize, MAX_INPUT_SIZE)) {
+            return false;
+        }
+
+        output.clear();
+        output.reserve(size);
+        size_t position = HEADER_SIZE;
+        while (output.size() < size) {
+            if (position >= input.size()) {
+                return false;
+            }
+            auto flags = static_cast<uint8_t>(input[position++]);
+            for (int bit = 0; bit < 8 && output.size() < size; bit++) {
+                if ((flags & (1 << bit)) != 0) {
+                    if (position + 2 > input.size()) {
+                        return false;
+                    }
+                    auto code = static_cast<uint16_t>((static_cast<uint8_t>(input[position]) << 8) | static_cast<uint8_t>(input[position + 1]));
+                    position += 2;
+                    size_t distance = (code >> 6) + 1;
+                    size_t length = (code & 0x3F) + MIN_MATCH;
+                    if (distance > output.size() || output.size() + length > size) {
+                        return false;
+                    }
+                    // Copy byte by byte, as the source may overlap what we are writing
+                    size_t from = output.size() - distance;
+                    for (size_t i = 0; i < length; i++) {
+                        output.push_back(output[from + i]);
+                    }
+                } else {
+                    if (position >= input.size()) {
+                        return false;
+                    }
+                    output.push_back(input[position++]);
+                }
+            }
+        }
+        return position == input.size();
+    }
+
+private:
+    static constexpr size_t HASH_BITS = 10;
+    static constexpr size_t HASH_SIZE = 1 << HASH_BITS;
+
+    /**
+     * @brief How many earlier occurrences to try per position, trading ratio for speed.
+     */
+    static constexpr int MAX_CHAIN_LENGTH = 16;
+
+    static constexpr uint16_t NO_POSITION = UINT16_MAX;
+
+    struct Match {
+        size_t length;
+        size_t distance;
+    };
+
+    static size_t hash(std::string_view input, size_t position) {
+        uint32_t value = static_cast<uint8_t>(input[position])
+            | (static_cast<uint8_t>(input[position + 1]) << 8)
+            | (static_cast<uint8_t>(input[position + 2]) << 16);
+        return (value * 2654435761U) >> (32 - HASH_BITS);
+    }
+
+    void insert(std::string_view input, size_t position) {
+        if (position + MIN_MATCH > input.size()) {
+            return;
+        }
+        auto slot = hash(input, position);
+        previous[position % WINDOW_SIZE] = head[slot];
+        head[slot] = static_cast<uint16_t>(position);
+    }
+
+    Match findMatch(std::string_view input, size_t position) const {
+        Match best { 0, 0 };
+        if (position + MIN_MATCH > input.size()) {
+            return best;
+        }
+        size_t maxLength = std::min(MAX_MATCH, input.size() - position);
+        size_t candidate = head[hash(input, position)];
+        for (int chain = 0; chain < MAX_CHAIN_LENGTH && candidate != NO_POSITION; chain++) {
+            if (position - candidate > WINDOW_SIZE) {
+                break;
+            }
+            size_t length = 0;
+            while (length < maxLength && input[candidate + length] == input[position + length]) {
+                length++;
+            }
+            if (length > best.length) {
+                best = { length, position - candidate };
+                if (length == maxLength) {
+                    break;
+                }
+            }
+            size_t next = previous[candidate % WINDOW_SIZE];
+            // Older positions in the slot have been overwritten by newer ones
+            if (next == NO_POSITION || next >= candidate) {
+                break;
+            }
+            candidate = next;
+        }
+        return best;
+    }
+
+    std::array<uint16_t, HASH_SIZE> head {};
+    std::array<uint16_t, WINDOW_SIZE> previous {};
+};
+
+}    // namespace farmhub::kernel
@@ -8,27 +8,30 @@
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include <Concurrent.hpp>
 #include <Configuration.hpp>
+#include <InstanceRegistry.hpp>
+#include <ShutdownManager.hpp>
 
 namespace farmhub::kernel {
 
-// Forward declarations and common types
-struct ShutdownParameters {
-    // Placeholder for future parameters
-};
-
 // shutdown capability for implementations that support graceful shutdown
 class HasShutdown {
 public:
     virtual ~HasShutdown() = default;
     virtual void shutdown(const ShutdownParameters& params) = 0;
-};
 
-// Generic, TU-stable type tokens: address of per-type inline variable
-template <typename T>
-inline constexpr char TypeTokenVar = 0;
+    /**
+     * @brief How long shutting down is expected to take, used to decide how long to wait for it.
+     */
+    virtual milliseconds getShutdownEstimate() const {
+        return DEFAULT_SHUTDOWN_ESTIMATE;
+    }
+
+    static constexpr milliseconds DEFAULT_SHUTDOWN_ESTIMATE = 1s;
+};
 
 // A reusable, shutdown-agnostic, type-erased handle that keeps a shared_ptr to an implementation
 // and provides tryGet<T>() via a compile-time type token. Lifecycle operations like shutdown are
@@ -50,6 +53,7 @@ public:
             h._shutdown = ([impl](const ShutdownParameters& p) {
                 std::static_pointer_cast<HasShutdown>(impl)->shutdown(p);
             });
+            h._shutdownEstimate = std::static_pointer_cast<HasShutdown>(impl)->getShutdownEstimate();
         }
 
         return h;
@@ -64,16 +68,33 @@ public:
         return {};
     }
 
+    const std::shared_ptr<void>& holder() const {
+        return _holder;
+    }
+
+    const void* typeTag() const {
+        return _typeTag;
+    }
+
+    bool hasShutdown() const {
+        return static_cast<bool>(_shutdown);
+    }
+
     void shutdown(const ShutdownParameters& p) {
         if (_shutdown) {
             _shutdown(p);
         }
     }
 
+    milliseconds getShutdownEstimate() const {
+        return _shutdownEstimate;
+    }
+
 private:
     std::shared_ptr<void> _holder;
     const void* _typeTag { nullptr };
     std::function<void(const ShutdownParameters& p)> _shutdown;
+    milliseconds _shutdownEstimate { 0 };
 };
 
 // A lightweight, generic factory descriptor. The CreateFn is the concrete callable type
@@ -99,37 +120,59 @@ public:
 
     template <typename T>
     std::shared_ptr<T> getInstance(const std::string& name) const {
+        return resolve<T>(name).share();
+    }
+
+    /**
+     * @brief Resolve a name to a typed reference once, e.g. when configuring a dependent instance.
+     *
+     * The reference gives access to the instance without locking or looking it up again.
+     * Throws if there is no such instance, or if it is of a different type.
+     */
+    template <typename T>
+    InstanceRef<T> resolve(const std::string& name) const {
         Lock lock(mutex);
         auto it = instances.find(name);
-        if (it != instances.end()) {
-            auto instance = it->second.template tryGet<T>();
-            if (instance == nullptr) {
-                throw std::runtime_error("Instance '" + name + "' is not of the required type");
-            }
-            return instance;
+        if (it == instances.end()) {
+            throw std::runtime_error("Instance '" + name + "' not found");
+        }
+        if (it->second.handle.typeTag() != &TypeTokenVar<T>) {
+            throw std::runtime_error("Instance '" + name + "' is not of the required type");
         }
-        throw std::runtime_error("Instance '" + name + "' not found");
+        return registry.template ref<T>(it->second.index);
     }
 
-    void shutdown() {
-        Lock lock(mutex);
-        if (state == State::Stopped) {
-            return;
-        }
-        LOGI("Shutting down %s manager",
-            managed.c_str());
-        state = State::Stopped;
-        ShutdownParameters parameters = {};
-        for (auto& [name, instance] : instances) {
-            LOGI("Shutting down %s '%s'",
-                managed.c_str(), name.c_str());
-            try {
-                instance.shutdown(parameters);
-            } catch (const std::exception& e) {
-                LOGE("Shutdown of %s '%s' failed: %s",
-                    managed.c_str(), name.c_str(), e.what());
+    /**
+     * @brief Shut down all instances concurrently, waiting for them until the deadline.
+     */
+    void shutdown(const ShutdownParameters& parameters) {
+        std::vector<ShutdownManager::Job> jobs;
+        {
+            Lock lock(mutex);
+            if (state == State::Stopped) {
+                return;
+            }
+            LOGI("Shutting down %s manager",
+                managed.c_str());
+            state = State::Stopped;
+            for (auto& [name, entry] : instances) {
+                auto& instance = entry.handle;
+                if (!instance.hasShutdown()) {
+                    continue;
+                }
+                LOGI("Shutting down %s '%s'",
+                    managed.c_str(), name.c_str());
+                jobs.push_back({
+                    .name = name,
+                    .estimatedDuration = instance.getShutdownEstimate(),
+                    .run = [instance](const ShutdownParameters& parameters) mutable {
+                        instance.shutdown(parameters);
+                    },
+                });
             }
         }
+        // Don't hold the lock while waiting, instances might need the manager to shut down
+        ShutdownManager::runConcurrently(jobs, parameters);
     }
 
     void createWithFactory(
@@ -149,7 +192,11 @@ public:
         }
         const auto& factory = it->second;
         Handle instance = make(factory);
-        instances.emplace(name, std::move(instance));
+        if (instances.contains(name)) {
+            return;
+        }
+        auto index = registry.add(instance.holder(), instance.typeTag());
+        instances.emplace(name, Instance { .handle = std::move(instance), .index = index });
     }
 
 protected:
@@ -158,7 +205,14 @@ protected:
 private:
     std::map<std::string, FactoryT> factories;
     mutable RecursiveMutex mutex;
-    std::unordered_map<std::string, Handle> instances;
+
+    struct Instance {
+        Handle handle;
+        uint32_t index;
+    };
+
+    std::unordered_map<std::string, Instance> instances;
+    InstanceRegistry registry;
 
     enum class State : uint8_t {
         Running,
@@ -0,0 +1,46 @@
+#include <sdkconfig.h>
+
+#ifdef CONFIG_MBEDTLS_CUSTOM_MEM_ALLOC
+
+#include <cstring>
+#include <limits>
+
+#include <esp_heap_caps.h>
+
+#include <MemoryClass.hpp>
+
+using namespace farmhub::kernel;
+
+// TLS contexts and record buffers take tens of kilobytes while connected, keep them out of internal RAM when possible.
+// Only enabled on boards that can have PSRAM (see sdkconfig.spinach.defaults); when the module turns out to have none,
+// allocations go straight to the heap, without the memory class header.
+
+static bool hasPsram() {
+    // PSRAM is detected during startup, before any TLS connection is made, so this never changes between calls
+    static const bool present = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+    return present;
+}
+
+extern "C" void* esp_mbedtls_mem_calloc(size_t n, size_t size) {
+    if (!hasPsram()) {
+        return heap_caps_calloc(n, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (size != 0 && n > std::numeric_limits<size_t>::max() / size) {
+        return nullptr;
+    }
+    void* ptr = Memory::allocate(MemoryClass::Bulk, n * size);
+    if (ptr != nullptr) {
+        std::memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+extern "C" void esp_mbedtls_mem_free(void* ptr) {
+    if (!hasPsram()) {
+        heap_caps_free(ptr);
+        return;
+    }
+    Memory::release(ptr);
+}
+
+#endif
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#else
+#include <cstdlib>
+#endif
+
+#include <ArduinoJson.h>
+
+namespace farmhub::kernel {
+
+enum class MemoryClass : uint8_t {
+    /**
+     * @brief Large buffers only touched by tasks: PSRAM when the board has it, internal RAM otherwise.
+     */
+    Bulk,
+    /**
+     * @brief Buffers handed to peripherals for DMA; always internal RAM.
+     */
+    Dma,
+    /**
+     * @brief Small, hot data; always internal RAM.
+     */
+    Fast,
+};
+
+/**
+ * @brief Allocates memory by what it is used for, instead of where it should go, and keeps tally per class.
+ *
+ * Internal RAM is what WiFi, interrupts and DMA need, so large buffers that can live with slower
+ * access should be allocated as `Bulk`, and move out of the way on boards with PSRAM.
+ */
+class Memory {
+public:
+    static void* allocate(MemoryClass memoryClass, size_t size) {
+        bool external = false;
+        auto* header = static_cast<Header*>(allocateRaw(memoryClass, HEADER_SIZE + size, external));
+        if (header == nullptr) {
+            usageOf(memoryClass).failures.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        header->size = size;
+        header->memoryClass = memoryClass;
+        header->external = external;
+        usageOf(memoryClass).record(size, external);
+        return reinterpret_cast<uint8_t*>(header) + HEADER_SIZE;
+    }
+
+    /**
+     * @brief Resize the allocation, keeping it in the same class.
+     */
+    static void* reallocate(void* ptr, size_t size) {
+        if (ptr == nullptr) {
+            return nullptr;
+        }
+        auto* header = headerOf(ptr);
+        void* newPtr = allocate(header->memoryClass, size);
+        if (newPtr == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(newPtr, ptr, std::min<size_t>(header->size, size));
+        release(ptr);
+        return newPtr;
+    }
+
+    static void release(void* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        auto* header = headerOf(ptr);
+        usageOf(header->memoryClass).forget(header->size, header->external);
+#ifdef ESP_PLATFORM
+        heap_caps_free(header);
+#else
+        std::free(header);
+#endif
+    }
+
+    static void populateTelemetry(JsonObject& json) {
+        for (auto memoryClass : { MemoryClass::Bulk, MemoryClass::Dma, MemoryClass::Fast }) {
+            auto& usage = usageOf(memoryClass);
+            auto classJson = json[nameOf(memoryClass)].to<JsonObject>();
+            classJson["used"] = usage.used.load(std::memory_order_relaxed);
+            classJson["peak"] = usage.peak.exchange(usage.used.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            if (memoryClass == MemoryClass::Bulk) {
+                classJson["external"] = usage.external.load(std::memory_order_relaxed);
+            }
+            classJson["failures"] = usage.failures.exchange(0, std::memory_order_relaxed);
+        }
+#ifdef ESP_PLATFORM
+        json["psram-free"] = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+#endif
+    }
+
+private:
+    struct Header {
+        uint32_t size;
+        MemoryClass memoryClass;
+        bool external;
+    };
+
+    // Keep the payload aligned the way malloc() would
+    static constexpr size_t HEADER_SIZE = (sizeof(Header) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    struct Usage {
+        std::atomic<size_t> used { 0 };
+        std::atomic<size_t> peak { 0 };
+        // Bytes that ended up in PSRAM
+        std::atomic<size_t> external { 0 };
+        std::atomic<uint32_t> failures { 0 };
+
+        void record(size_t size, bool inExternal) {
+            auto now = used.fetch_add(size, std::memory_order_relaxed) + size;
+            auto previousPeak = peak.load(std::memory_order_relaxed);
+            while (now > previousPeak && !peak.compare_exchange_weak(previousPeak, now, std::memory_order_relaxed)) { }
+            if (inExternal) {
+                external.fetch_add(size, std::memory_order_relaxed);
+            }
+        }
+
+        void forget(size_t size, bool inExternal) {
+            used.fetch_sub(size, std::memory_order_relaxed);
+            if (inExternal) {
+                external.fetch_sub(size, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static void* allocateRaw(MemoryClass memoryClass, size_t size, bool& external) {
+#ifdef ESP_PLATFORM
+        switch (memoryClass) {
+            case MemoryClass::Bulk: {
+                // Only succeeds if the board has PSRAM, and it has room
+                void* ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+                if (ptr != nullptr) {
+                    external = true;
+                    return ptr;
+                }
+                return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+            }
+            case MemoryClass::Dma:
+                return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+            case MemoryClass::Fast:
+            default:
+                return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        }
+#else
+        (void) memoryClass;
+        (void) external;
+        return std::malloc(size);
+#endif
+    }
+
+    static Header* headerOf(void* ptr) {
+        return reinterpret_cast<Header*>(static_cast<uint8_t*>(ptr) - HEADER_SIZE);
+    }
+
+    static Usage& usageOf(MemoryClass memoryClass) {
+        static std::array<Usage, 3> usages {};
+        return usages[static_cast<size_t>(memoryClass)];
+    }
+
+    static const char* nameOf(MemoryClass memoryClass) {
+        switch (memoryClass) {
+            case MemoryClass::Bulk:
+                return "bulk";
+            case MemoryClass::Dma:
+                return "dma";
+            case MemoryClass::Fast:
+            default:
+                return "fast";
+        }
+    }
+};
+
+struct MemoryDeleter {
+    void operator()(void* ptr) const {
+        Memory::release(ptr);
+    }
+};
+
+using MemoryBlock = std::unique_ptr<uint8_t[], MemoryDeleter>;
+
+/**
+ * @brief Allocate a buffer in the given class, throwing `std::bad_alloc` if there is no room, like `new` would.
+ */
+inline MemoryBlock allocateBlock(MemoryClass memoryClass, size_t size) {
+    auto* ptr = static_cast<uint8_t*>(Memory::allocate(memoryClass, size));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return MemoryBlock(ptr);
+}
+
+/**
+ * @brief Places the contents of JSON documents in the given memory class.
+ */
+template <MemoryClass Class>
+class MemoryClassJsonAllocator : public ArduinoJson::Allocator {
+public:
+    void* allocate(size_t size) override {
+        return Memory::allocate(Class, size);
+    }
+
+    void deallocate(void* ptr) override {
+        Memory::release(ptr);
+    }
+
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (ptr == nullptr) {
+            return allocate(newSize);
+        }
+        return Memory::reallocate(ptr, newSize);
+    }
+
+    static MemoryClassJsonAllocator* instance() {
+        static MemoryClassJsonAllocator allocator;
+        return &allocator;
+    }
+};
+
+/**
+ * @brief For large, short-lived documents like the init message and command responses.
+ */
+inline ArduinoJson::Allocator* bulkJsonAllocator() {
+    return MemoryClassJsonAllocator<MemoryClass::Bulk>::instance();
+}
+
+}    // namespace farmhub::kernel
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 
 #include <ArduinoJson.h>
 
@@ -11,8 +13,33 @@
 
 namespace farmhub::kernel {
 
+/**
+ * @brief Counts configuration updates across all NVS configurations, and how many of them changed nothing.
+ */
+class ConfigurationUpdateStats {
+public:
+    static void recordUpdate(bool skipped) {
+        updates.fetch_add(1, std::memory_order_relaxed);
+        if (skipped) {
+            skippedUpdates.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void populateTelemetry(JsonObject& json) {
+        json["updates"] = updates.exchange(0, std::memory_order_relaxed);
+        json["skipped"] = skippedUpdates.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    inline static std::atomic<uint32_t> updates { 0 };
+    inline static std::atomic<uint32_t> skippedUpdates { 0 };
+};
+
 /**
  * @brief Loads a ConfigurationSection from NVS, and persists updates back to NVS.
+ *
+ * Updates with the same content as the current configuration are ignored, so that retained
+ * configuration re-delivered on every reconnect doesn't rewrite NVS.
  */
 template <std::derived_from<ConfigurationSection> TConfiguration>
 class NvsConfiguration {
@@ -24,17 +51,33 @@ public:
         JsonDocument doc;
         if (this->nvs->getJson(key, doc)) {
             this->config->load(doc.as<JsonObject>());
+            contentHash = hashConfigurationJson(doc);
             LOGD("Loaded NVS config for '%s'", key.c_str());
         } else {
             LOGD("No NVS config found for '%s', using defaults", key.c_str());
         }
     }
 
-    void update(const JsonObject& json) {
+    /**
+     * @return false if the update is the same as the current configuration, and was skipped.
+     */
+    bool update(const JsonObject& json) {
+        auto hash = hashConfigurationJson(json);
+        if (contentHash == hash) {
+            LOGD("NVS config for '%s' is unchanged, skipping update", key.c_str());
+            ConfigurationUpdateStats::recordUpdate(true);
+            return false;
+        }
+        ConfigurationUpdateStats::recordUpdate(false);
         config->load(json);
         if (!nvs->setJson(key, json)) {
             LOGE("Failed to save NVS config for '%s'", key.c_str());
+            // Try saving again next time
+            contentHash.reset();
+            return true;
         }
+        contentHash = hash;
+        return true;
     }
 
     std::shared_ptr<TConfiguration> getConfig() const {
@@ -49,6 +92,7 @@ private:
     std::shared_ptr<NvsStore> nvs;
     const std::string key;
     std::shared_ptr<TConfiguration> config;
+    std::optional<uint32_t> contentHash;
 };
 
 /**
@@ -9,6 +9,8 @@
 
 #include <ArduinoJson.h>
 
+#include <Concurrent.hpp>
+
 namespace farmhub::kernel {
 
 LOGGING_TAG(NVS, "nvs")
@@ -165,8 +167,32 @@ public:
         nvs_release_iterator(it);
     }
 
+    /**
+     * @brief Wait for writes in progress to finish, and refuse further ones, before power goes away.
+     *
+     * Writes are committed right away, so there is nothing else to flush.
+     */
+    static void flush() {
+        Lock lock(writeMutex);
+        flushed = true;
+        LOGTD(NVS, "Flushed, not accepting further writes");
+    }
+
 private:
     esp_err_t withPreferences(bool readOnly, const std::function<esp_err_t(nvs_handle_t)>& action) {
+        if (readOnly) {
+            return withHandle(true, action);
+        }
+        Lock lock(writeMutex);
+        if (flushed) {
+            LOGTW(NVS, "Not writing '%s' after shutdown",
+                ns.c_str());
+            return ESP_ERR_INVALID_STATE;
+        }
+        return withHandle(false, action);
+    }
+
+    esp_err_t withHandle(bool readOnly, const std::function<esp_err_t(nvs_handle_t)>& action) {
         LOGTV(NVS, "%s '%s'", readOnly ? "read" : "write", ns.c_str());
 
         nvs_handle_t handle;
@@ -194,6 +220,9 @@ private:
     }
 
     const std::string ns;
+
+    inline static Mutex writeMutex;
+    inline static bool flushed = false;
 };
 
 }    // namespace farmhub::kernel
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
+#include <charconv>
 #include <exception>
 #include <map>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -11,10 +14,13 @@
 #include <driver/gpio_filter.h>
 #include <esp_adc/adc_oneshot.h>
 #include <hal/adc_types.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_struct.h>
 
 #include <ArduinoJson.h>
 
 #include <EspException.hpp>
+#include <PinTable.hpp>
 
 namespace farmhub::kernel {
 
@@ -31,12 +37,17 @@ using InternalPinPtr = std::shared_ptr<InternalPin>;
  */
 class Pin {
 public:
-    static PinPtr byName(const std::string& name) {
+    /**
+     * @brief Find a pin by name, either a board pin, a raw `GPIO_NUM_x` or one registered at runtime by an expander.
+     */
+    static PinPtr byName(const std::string& name);
+
+    static std::optional<PinPtr> findRegistered(const std::string& name) {
         auto it = BY_NAME.find(name);
         if (it != BY_NAME.end()) {
             return it->second;
         }
-        throw std::runtime_error(std::string("Unknown pin: " + name).c_str());
+        return std::nullopt;
     }
 
     enum class Mode : uint8_t {
@@ -56,6 +67,11 @@ public:
         return name;
     }
 
+    /**
+     * @brief Register a pin provided by an external peripheral, like an I/O expander.
+     *
+     * Pins of the MCU are defined at compile time by the board's pin table instead.
+     */
     static void registerPin(const std::string& name, PinPtr pin) {
         BY_NAME[name] = std::move(pin);
     }
@@ -79,29 +95,58 @@ std::map<std::string, PinPtr> Pin::BY_NAME;
  */
 class InternalPin : public Pin {
 public:
-    static InternalPinPtr registerPin(const std::string& name, gpio_num_t gpio) {
-        auto pin = std::make_shared<InternalPin>(name, gpio);
-        INTERNAL_BY_GPIO[gpio] = pin;
-        INTERNAL_BY_NAME[name] = pin;
-        Pin::registerPin(name, pin);
-        return pin;
+    static_assert(GPIO_NUM_MAX <= MAX_PIN_GPIO, "Pin tables must cover every GPIO");
+
+    /**
+     * @brief Use the board's compile-time pin table to resolve pin names.
+     *
+     * Must be called before any pin is looked up.
+     */
+    static PinTableView useBoardPins(PinTableView pins) {
+        BOARD_PINS = pins;
+        return pins;
+    }
+
+    static std::optional<InternalPinPtr> findByName(std::string_view name) {
+        if (auto gpio = BOARD_PINS.findGpio(name)) {
+            return byGpio(static_cast<gpio_num_t>(*gpio));
+        }
+        constexpr std::string_view prefix = "GPIO_NUM_";
+        if (name.starts_with(prefix)) {
+            int gpio = -1;
+            auto digits = name.substr(prefix.size());
+            auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), gpio);
+            if (error == std::errc() && end == digits.data() + digits.size() && gpio >= 0 && gpio < GPIO_NUM_MAX) {
+                return byGpio(static_cast<gpio_num_t>(gpio));
+            }
+        }
+        return std::nullopt;
     }
 
     static InternalPinPtr byName(const std::string& name) {
-        auto it = INTERNAL_BY_NAME.find(name);
-        if (it != INTERNAL_BY_NAME.end()) {
-            return it->second;
+        if (auto pin = findByName(name)) {
+            return *pin;
         }
         throw std::runtime_error(std::string("Unknown internal pin: " + name).c_str());
     }
 
-    static InternalPinPtr byGpio(gpio_num_t pin) {
-        auto it = INTERNAL_BY_GPIO.find(pin);
-        if (it == INTERNAL_BY_GPIO.end()) {
-            std::string name = "GPIO_NUM_" + std::to_string(static_cast<int>(pin));
-            return registerPin(name, pin);
+    /**
+     * @brief Get the pin for a GPIO, creating it on first use with its name from the board's pin table.
+     */
+    static InternalPinPtr byGpio(gpio_num_t gpio) {
+        if (gpio < 0 || gpio >= GPIO_NUM_MAX) {
+            throw std::runtime_error(std::string("Invalid GPIO: " + std::to_string(static_cast<int>(gpio))).c_str());
+        }
+        auto& pin = BY_GPIO[gpio];
+        if (pin == nullptr) {
+            auto name = BOARD_PINS.findName(gpio);
+            pin = std::make_shared<InternalPin>(
+                name.has_value()
+                    ? std::string(*name)
+                    : "GPIO_NUM_" + std::to_string(static_cast<int>(gpio)),
+                gpio);
         }
-        return it->second;
+        return pin;
     }
 
     InternalPin(const std::string& name, gpio_num_t gpio)
@@ -129,12 +174,15 @@ public:
         return gpio_get_level(gpio);
     }
 
+    // The driver's gpio_set_level() and gpio_get_level() live in flash,
+    // use the inlined low-level calls so these work with the flash cache disabled
+
     IRAM_ATTR void digitalWriteFromISR(uint8_t val) const {
-        gpio_set_level(gpio, val);
+        gpio_ll_set_level(&GPIO, gpio, val);
     }
 
     IRAM_ATTR int digitalReadFromISR() const {
-        return gpio_get_level(gpio);
+        return gpio_ll_get_level(&GPIO, gpio);
     }
 
     constexpr IRAM_ATTR gpio_num_t getGpio() const {
@@ -194,10 +242,20 @@ public:
 private:
     const gpio_num_t gpio;
     gpio_glitch_filter_handle_t glitchFilter = nullptr;
-    static std::map<std::string, InternalPinPtr> INTERNAL_BY_NAME;
-    static std::map<gpio_num_t, InternalPinPtr> INTERNAL_BY_GPIO;
+    static PinTableView BOARD_PINS;
+    static std::array<InternalPinPtr, GPIO_NUM_MAX> BY_GPIO;
 };
 
+inline PinPtr Pin::byName(const std::string& name) {
+    if (auto pin = InternalPin::findByName(name)) {
+        return *pin;
+    }
+    if (auto pin = findRegistered(name)) {
+        return *pin;
+    }
+    throw std::runtime_error(std::string("Unknown pin: " + name).c_str());
+}
+
 class AnalogPin {
 public:
     static constexpr double MAX_ANALOG_VALUE = 4096.0;
@@ -282,8 +340,8 @@ private:
     adc_channel_t channel {};
 };
 
-std::map<std::string, InternalPinPtr> InternalPin::INTERNAL_BY_NAME;
-std::map<gpio_num_t, InternalPinPtr> InternalPin::INTERNAL_BY_GPIO;
+PinTableView InternalPin::BOARD_PINS;
+std::array<InternalPinPtr, GPIO_NUM_MAX> InternalPin::BY_GPIO;
 std::vector<adc_oneshot_unit_handle_t> AnalogPin::ANALOG_UNITS { 2 };
 
 }    // namespace farmhub::kernel
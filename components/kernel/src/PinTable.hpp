@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include <Hash.hpp>
+
+namespace farmhub::kernel {
+
+struct PinDefinition {
+    std::string_view name;
+    int gpio;
+};
+
+/**
+ * @brief Highest GPIO number plus one across the MCUs we support.
+ */
+static constexpr int MAX_PIN_GPIO = 64;
+
+/**
+ * @brief Read-only view of a `PinTable`, independent of its size.
+ */
+class PinTableView {
+public:
+    constexpr PinTableView() = default;
+
+    constexpr PinTableView(std::span<const PinDefinition> pins, std::span<const uint8_t> slots, const std::array<int8_t, MAX_PIN_GPIO>* byGpio, uint32_t seed)
+        : pins(pins)
+        , slots(slots)
+        , byGpio(byGpio)
+        , seed(seed) {
+    }
+
+    /**
+     * @brief Find the GPIO of a named pin with a single hash and a single string comparison.
+     */
+    constexpr std::optional<int> findGpio(std::string_view name) const {
+        if (slots.empty()) {
+            return std::nullopt;
+        }
+        auto index = slots[slotOf(name, seed, slots.size())];
+        if (index == EMPTY_SLOT || pins[index].name != name) {
+            return std::nullopt;
+        }
+        return pins[index].gpio;
+    }
+
+    /**
+     * @brief Find the name of the first pin defined for a GPIO.
+     */
+    constexpr std::optional<std::string_view> findName(int gpio) const {
+        if (byGpio == nullptr || gpio < 0 || gpio >= MAX_PIN_GPIO) {
+            return std::nullopt;
+        }
+        auto index = (*byGpio)[gpio];
+        if (index < 0) {
+            return std::nullopt;
+        }
+        return pins[index].name;
+    }
+
+    constexpr std::span<const PinDefinition> getPins() const {
+        return pins;
+    }
+
+    static constexpr uint8_t EMPTY_SLOT = UINT8_MAX;
+
+    /**
+     * @brief Slot of a name in a power-of-two sized table.
+     *
+     * The seed is mixed into the hash of the name, so searching for a seed never rehashes names.
+     */
+    static constexpr size_t slotOf(std::string_view name, uint32_t seed, size_t slotCount) {
+        return mix32(fnv1a(name) ^ seed) >> (32 - std::countr_zero(slotCount));
+    }
+
+private:
+    std::span<const PinDefinition> pins;
+    std::span<const uint8_t> slots;
+    const std::array<int8_t, MAX_PIN_GPIO>* byGpio = nullptr;
+    uint32_t seed = 0;
+};
+
+/**
+ * @brief Board pin definitions resolved at compile time.
+ *
+ * Names are looked up via a perfect hash: a seed is searched at compile time so that every
+ * name lands in its own slot. GPIOs are looked up in a directly indexed array.
+ */
+template <size_t N>
+class PinTable {
+public:
+    static_assert(N > 0 && N < PinTableView::EMPTY_SLOT, "Slots index pins by a byte");
+
+    /**
+     * @brief Four slots per pin keep the seed search short.
+     */
+    static constexpr size_t SLOT_COUNT = std::bit_ceil(N * 4);
+
+    consteval explicit PinTable(const std::array<PinDefinition, N>& definitions)
+        : pins(definitions) {
+        byGpio.fill(-1);
+        for (size_t i = 0; i < N; i++) {
+            if (pins[i].gpio < 0 || pins[i].gpio >= MAX_PIN_GPIO) {
+                throw "GPIO out of range";
+            }
+            for (size_t j = 0; j < i; j++) {
+                if (pins[i].name == pins[j].name) {
+                    throw "Duplicate pin name";
+                }
+            }
+            if (byGpio[pins[i].gpio] < 0) {
+                byGpio[pins[i].gpio] = static_cast<int8_t>(i);
+            }
+        }
+        for (seed = 0; seed < MAX_SEED; seed++) {
+            if (tryPlace()) {
+                return;
+            }
+        }
+        throw "No perfect hash seed found";
+    }
+
+    constexpr PinTableView view() const {
+        return { pins, slots, &byGpio, seed };
+    }
+
+    constexpr std::optional<int> findGpio(std::string_view name) const {
+        return view().findGpio(name);
+    }
+
+    constexpr std::optional<std::string_view> findName(int gpio) const {
+        return view().findName(gpio);
+    }
+
+private:
+    static constexpr uint32_t MAX_SEED = 10000;
+
+    constexpr bool tryPlace() {
+        slots.fill(PinTableView::EMPTY_SLOT);
+        for (size_t i = 0; i < N; i++) {
+            auto& slot = slots[PinTableView::slotOf(pins[i].name, seed, SLOT_COUNT)];
+            if (slot != PinTableView::EMPTY_SLOT) {
+                return false;
+            }
+            slot = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+
+    std::array<PinDefinition, N> pins;
+    std::array<uint8_t, SLOT_COUNT> slots {};
+    std::array<int8_t, MAX_PIN_GPIO> byGpio {};
+    uint32_t seed = 0;
+};
+
+}    // namespace farmhub::kernel
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <list>
 
 #include <esp_pm.h>
+#include <esp_timer.h>
 
 #include <Concurrent.hpp>
+#include <EnergyLedger.hpp>
 #include <EspException.hpp>
 #include <Telemetry.hpp>
 
@@ -23,14 +27,112 @@ namespace farmhub::kernel {
 
 LOGGING_TAG(PM, "pm")
 
+/**
+ * @brief Lowers the maximum CPU frequency outside of bursts of heavy work.
+ *
+ * ESP-IDF runs the CPU at the configured maximum frequency whenever a task is busy. On battery
+ * we can configure a lower steady-state maximum, and raise it to the full frequency only while
+ * a `CPU_FREQ_MAX` lock is held around work that is known to be CPU-heavy, so it finishes
+ * quickly and the radio can go back to sleep sooner.
+ */
+class CpuFrequencyGovernor {
+public:
+    static void configure(const esp_pm_config_t& config, int burstFreqMhz) {
+        Lock lock(mutex);
+        steadyConfig = config;
+        burstFreq = std::max(burstFreqMhz, config.max_freq_mhz);
+        // The caller has already applied the configuration
+        appliedFreq = config.max_freq_mhz;
+        configured = true;
+        apply();
+    }
+
+    static void beginBurst() {
+        Lock lock(mutex);
+        if (bursts++ == 0) {
+            burstStartedAt = esp_timer_get_time();
+            apply();
+        }
+    }
+
+    static void endBurst() {
+        Lock lock(mutex);
+        if (--bursts == 0) {
+            burstTime += esp_timer_get_time() - burstStartedAt;
+            apply();
+        }
+    }
+
+    static void populateTelemetry(JsonObject& json) {
+        Lock lock(mutex);
+        json["max-freq"] = steadyConfig.max_freq_mhz;
+        json["burst-freq"] = burstFreq;
+        auto now = esp_timer_get_time();
+        if (bursts > 0) {
+            burstTime += now - burstStartedAt;
+            burstStartedAt = now;
+        }
+        json["burst-time"] = burstTime / 1000;
+        burstTime = 0;
+    }
+
+private:
+    /**
+     * @brief Must be called with the mutex held.
+     */
+    static void apply() {
+        if (!configured) {
+            return;
+        }
+        auto config = steadyConfig;
+        if (bursts > 0) {
+            config.max_freq_mhz = burstFreq;
+        }
+        if (config.max_freq_mhz == appliedFreq) {
+            return;
+        }
+        esp_err_t err = esp_pm_configure(&config);
+        if (err != ESP_OK) {
+            LOGTW(PM, "Failed to set maximum CPU frequency to %d MHz: %s",
+                config.max_freq_mhz, esp_err_to_name(err));
+            return;
+        }
+        appliedFreq = config.max_freq_mhz;
+    }
+
+    inline static Mutex mutex;
+    inline static bool configured = false;
+    inline static esp_pm_config_t steadyConfig {};
+    inline static int burstFreq = 0;
+    inline static int appliedFreq = 0;
+    inline static int bursts = 0;
+    inline static int64_t burstStartedAt = 0;
+    inline static int64_t burstTime = 0;
+};
+
+/**
+ * @brief How often a lock was acquired, and for how long it was held, since it was last reported.
+ */
+struct PowerManagementLockUsage {
+    uint32_t acquisitions;
+    microseconds held;
+};
+
 class PowerManagementLock {
 public:
     PowerManagementLock(const std::string& name, esp_pm_lock_type_t type)
-        : name(name) {
+        : name(name)
+        , type(type) {
         ESP_ERROR_THROW(esp_pm_lock_create(type, 0, name.c_str(), &lock));
+        Lock registryLock(locksMutex);
+        locks.push_back(this);
     }
 
     ~PowerManagementLock() {
+        {
+            Lock registryLock(locksMutex);
+            locks.remove(this);
+        }
         ESP_ERROR_CHECK(esp_pm_lock_delete(lock));
     }
 
@@ -38,9 +140,88 @@ public:
     PowerManagementLock(const PowerManagementLock&) = delete;
     PowerManagementLock& operator=(const PowerManagementLock&) = delete;
 
+    /**
+     * @brief Account for the time the lock is held in the energy ledger.
+     */
+    void trackEnergy(const std::shared_ptr<EnergyConsumer>& consumer) {
+        energy = consumer;
+    }
+
+    const std::string& getName() const {
+        return name;
+    }
+
+    PowerManagementLockUsage takeUsage() {
+        Lock usageLock(usageMutex);
+        auto now = esp_timer_get_time();
+        if (holders > 0) {
+            heldTime += now - heldSince;
+            heldSince = now;
+        }
+        PowerManagementLockUsage usage {
+            .acquisitions = acquisitions,
+            .held = microseconds(heldTime),
+        };
+        acquisitions = 0;
+        heldTime = 0;
+        return usage;
+    }
+
+    /**
+     * @brief Report usage of every lock that was used since the last report.
+     */
+    static void populateUsage(JsonObject& json) {
+        Lock registryLock(locksMutex);
+        for (auto* lock : locks) {
+            auto usage = lock->takeUsage();
+            if (usage.acquisitions == 0 && usage.held == microseconds::zero()) {
+                continue;
+            }
+            auto lockJson = json[lock->name].to<JsonObject>();
+            lockJson["count"] = usage.acquisitions;
+            lockJson["time"] = duration_cast<milliseconds>(usage.held).count();
+        }
+    }
+
 private:
+    void acquire() {
+        ESP_ERROR_THROW(esp_pm_lock_acquire(lock));
+        if (type == ESP_PM_CPU_FREQ_MAX) {
+            CpuFrequencyGovernor::beginBurst();
+        }
+        Lock usageLock(usageMutex);
+        acquisitions++;
+        if (holders++ == 0) {
+            heldSince = esp_timer_get_time();
+        }
+    }
+
+    void release() {
+        {
+            Lock usageLock(usageMutex);
+            if (--holders == 0) {
+                heldTime += esp_timer_get_time() - heldSince;
+            }
+        }
+        if (type == ESP_PM_CPU_FREQ_MAX) {
+            CpuFrequencyGovernor::endBurst();
+        }
+        ESP_ERROR_CHECK(esp_pm_lock_release(lock));
+    }
+
     const std::string name;
+    const esp_pm_lock_type_t type;
     esp_pm_lock_handle_t lock = nullptr;
+    std::shared_ptr<EnergyConsumer> energy;
+
+    Mutex usageMutex;
+    uint32_t holders = 0;
+    uint32_t acquisitions = 0;
+    int64_t heldSince = 0;
+    int64_t heldTime = 0;
+
+    inline static Mutex locksMutex;
+    inline static std::list<PowerManagementLock*> locks;
 
     friend class PowerManagementLockGuard;
 };
@@ -48,13 +229,20 @@ private:
 class PowerManagementLockGuard {
 public:
     PowerManagementLockGuard(PowerManagementLock& lock)
-        : lock(lock) {
-        ESP_ERROR_THROW(esp_pm_lock_acquire(lock.lock));
+        : lock(lock)
+        , energy(lock.energy) {
+        lock.acquire();
+        if (energy != nullptr) {
+            energy->begin();
+        }
     }
 
     ~PowerManagementLockGuard() {
+        if (energy != nullptr) {
+            energy->end();
+        }
         if (lock.lock != nullptr) {
-            ESP_ERROR_CHECK(esp_pm_lock_release(lock.lock));
+            lock.release();
         }
     }
 
@@ -64,21 +252,45 @@ public:
 
 private:
     PowerManagementLock& lock;
+    const std::shared_ptr<EnergyConsumer> energy;
+};
+
+/**
+ * @brief Hold a guard on this to run a CPU-heavy burst of work at full speed.
+ */
+class PerformanceLock : public PowerManagementLock {
+public:
+    explicit PerformanceLock(const std::string& name)
+        : PowerManagementLock(name, ESP_PM_CPU_FREQ_MAX) {
+    }
 };
 
 class PowerManager final {
 public:
-    PowerManager(bool requestedSleepWhenIdle)
+    /**
+     * @param maxFreqMhz the steady-state maximum CPU frequency, 0 for the default;
+     *     performance locks still run at the default frequency.
+     */
+    PowerManager(bool requestedSleepWhenIdle, int maxFreqMhz = 0)
         : sleepWhenIdle(shouldSleepWhenIdle(requestedSleepWhenIdle)) {
 
-        LOGTV(PM, "Configuring power management, CPU max/min at %d/%d MHz, light sleep is %s",
-            CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, MIN_CPU_FREQ_MHZ, sleepWhenIdle ? "enabled" : "disabled");
+        int steadyMaxFreqMhz = maxFreqMhz == 0
+            ? CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+            : std::clamp(maxFreqMhz, MIN_CPU_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+        LOGTV(PM, "Configuring power management, CPU max/min at %d/%d MHz (%d MHz for bursts), light sleep is %s",
+            steadyMaxFreqMhz, MIN_CPU_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, sleepWhenIdle ? "enabled" : "disabled");
         esp_pm_config_t pm_config = {
-            .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+            .max_freq_mhz = steadyMaxFreqMhz,
             .min_freq_mhz = MIN_CPU_FREQ_MHZ,
             .light_sleep_enable = sleepWhenIdle,
         };
-        ESP_ERROR_THROW(esp_pm_configure(&pm_config));
+        if (esp_pm_configure(&pm_config) != ESP_OK) {
+            LOGTW(PM, "CPU frequency %d MHz is not supported, using %d MHz",
+                steadyMaxFreqMhz, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+            pm_config.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+            ESP_ERROR_THROW(esp_pm_configure(&pm_config));
+        }
+        CpuFrequencyGovernor::configure(pm_config, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
 
 #ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
         esp_pm_sleep_cbs_register_config_t cbs_conf = {
@@ -124,6 +336,10 @@ public:
             json["sleep-count"] = currentLightSleepCount;
         }
 #endif
+        auto cpuJson = json["cpu"].to<JsonObject>();
+        CpuFrequencyGovernor::populateTelemetry(cpuJson);
+        auto locksJson = json["locks"].to<JsonObject>();
+        PowerManagementLock::populateUsage(locksJson);
     }
 
     static PowerManagementLock noLightSleep;
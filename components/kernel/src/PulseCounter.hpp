@@ -4,15 +4,19 @@
 #include <chrono>
 #include <list>
 #include <memory>
+#include <optional>
 
 #include <driver/gpio.h>
 #include <driver/rtc_io.h>
 #include <esp_sleep.h>
+#include <esp_timer.h>
 
 #include <Concurrent.hpp>
+#include <FlashBusyEdges.hpp>
 #include <Log.hpp>
 #include <Pin.hpp>
 #include <PowerManager.hpp>
+#include <PulseTiming.hpp>
 
 using namespace std::chrono;
 
@@ -29,6 +33,10 @@ struct PulseCounterConfig {
      * @brief Ignore any pulses that happen within this time after the previous pulse.
      */
     microseconds debounceTime = 0us;
+    /**
+     * @brief Record the time of each pulse, to be read via `takeTimestamp()`.
+     */
+    bool recordTimestamps = false;
 };
 
 /**
@@ -39,14 +47,18 @@ struct PulseCounterConfig {
  * When the device is awake, it watches for edges, and counts falling edges.
  * When the device enters light sleep, we set up an interrupt to wake on level change.
  * This is necessary because in light sleep the device cannot detect edges, only levels.
+ *
+ * The interrupt handler only touches IRAM and internal RAM, so it keeps counting while
+ * flash operations have the cache disabled.
  */
 class PulseCounter {
 public:
-    PulseCounter(const InternalPinPtr& pin, microseconds debounceTime)
+    PulseCounter(const InternalPinPtr& pin, microseconds debounceTime, bool recordTimestamps = false)
         : pin(pin)
         , debounceTime(debounceTime)
+        , timestamps(recordTimestamps ? std::make_unique<PulseTimestampBuffer>() : nullptr)
         , lastEdge(pin->digitalRead())
-        , lastCountedEdgeTime(steady_clock::now()) {
+        , lastCountedEdgeTime(esp_timer_get_time()) {
         auto gpio = pin->getGpio();
 
         // Configure the GPIO pin as an input
@@ -83,6 +95,22 @@ public:
         return count;
     }
 
+    /**
+     * @brief Take the time of the oldest pulse not yet taken, in microseconds since boot.
+     *
+     * Only available if the counter was created to record timestamps.
+     */
+    std::optional<int64_t> takeTimestamp() {
+        return timestamps == nullptr ? std::nullopt : timestamps->pop();
+    }
+
+    /**
+     * @brief Number of pulse timestamps lost since the last call because they were not taken in time.
+     */
+    uint32_t takeDroppedTimestamps() {
+        return timestamps == nullptr ? 0 : timestamps->takeDropped();
+    }
+
     PinPtr getPin() const {
         return pin;
     }
@@ -108,9 +136,13 @@ private:
 
     const InternalPinPtr pin;
     const microseconds debounceTime;
+    const std::unique_ptr<PulseTimestampBuffer> timestamps;
     std::atomic<uint32_t> edgeCount { 0 };
     int lastEdge;
-    steady_clock::time_point lastCountedEdgeTime;
+    /**
+     * @brief From esp_timer_get_time(), as steady_clock is not safe to use with the cache disabled.
+     */
+    int64_t lastCountedEdgeTime;
 
     friend void handlePulseCounterInterrupt(void* arg);
     friend class PulseCounterManager;
@@ -122,18 +154,22 @@ static void IRAM_ATTR handlePulseCounterInterrupt(void* arg) {
     if (currentState != counter->lastEdge) {
         counter->lastEdge = currentState;
 
+        auto now = esp_timer_get_time();
+
         // Software debounce: ignore edges that happen too quickly
         if (counter->debounceTime > 0us) {
-            auto now = steady_clock::now();
-            auto timeSinceLastEdge = duration_cast<microseconds>(now - counter->lastCountedEdgeTime);
-            if (timeSinceLastEdge < counter->debounceTime) {
+            if (now - counter->lastCountedEdgeTime < counter->debounceTime.count()) {
                 return;
             }
             counter->lastCountedEdgeTime = now;
         }
 
         if (currentState == 0) {
-            counter->edgeCount++;
+            counter->edgeCount.fetch_add(1, std::memory_order_relaxed);
+            FlashBusyEdges::record();
+            if (counter->timestamps != nullptr) {
+                counter->timestamps->push(now);
+            }
         }
     }
 }
@@ -166,7 +202,7 @@ public:
             ESP_ERROR_THROW(esp_pm_light_sleep_register_cbs(&sleepCallbackConfig));
         }
 
-        auto counter = std::make_shared<PulseCounter>(config.pin, config.debounceTime);
+        auto counter = std::make_shared<PulseCounter>(config.pin, config.debounceTime, config.recordTimestamps);
 
         // Attach the ISR handler to the GPIO pin
         ESP_ERROR_THROW(gpio_isr_handler_add(config.pin->getGpio(), handlePulseCounterInterrupt, counter.get()));
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Fixed-size single-producer, single-consumer queue of pulse timestamps.
+ *
+ * The producer is an interrupt handler, so pushing never blocks or allocates; when the buffer
+ * is full, the pulse is counted as dropped instead.
+ */
+class PulseTimestampBuffer {
+public:
+    static constexpr size_t CAPACITY = 32;
+
+    /**
+     * @brief Add a timestamp, called from the interrupt handler.
+     *
+     * Always inlined, so that it ends up in the IRAM of the handler.
+     */
+    [[gnu::always_inline]] bool push(int64_t timeUs) {
+        auto head = this->head.load(std::memory_order_relaxed);
+        if (head - tail.load(std::memory_order_acquire) == CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        timestamps[head % CAPACITY] = timeUs;
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<int64_t> pop() {
+        auto tail = this->tail.load(std::memory_order_relaxed);
+        if (tail == head.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        auto timeUs = timestamps[tail % CAPACITY];
+        this->tail.store(tail + 1, std::memory_order_release);
+        return timeUs;
+    }
+
+    /**
+     * @brief Number of pulses dropped because the buffer was full since the last call.
+     */
+    uint32_t takeDropped() {
+        return dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<int64_t, CAPACITY> timestamps {};
+    std::atomic<uint32_t> head { 0 };
+    std::atomic<uint32_t> tail { 0 };
+    std::atomic<uint32_t> dropped { 0 };
+};
+
+struct PulseIntervalStats {
+    uint32_t pulses = 0;
+    uint32_t missed = 0;
+    uint32_t meanIntervalUs = 0;
+    uint32_t minIntervalUs = 0;
+    uint32_t maxIntervalUs = 0;
+    /**
+     * @brief Standard deviation of the intervals.
+     */
+    uint32_t jitterUs = 0;
+};
+
+/**
+ * @brief Tracks the intervals between pulses of a periodic source over the last few pulses,
+ * and counts pulses that should have arrived but didn't.
+ *
+ * The expected interval is learned from the pulses seen. An interval longer than `missingFactor`
+ * times the expected one is a gap, and counts as the number of pulses that would fit into it.
+ * Gaps are kept out of the statistics, unless they keep coming, in which case the source must
+ * have slowed down, and we learn its new cadence.
+ */
+class PulseIntervalAnalyzer {
+public:
+    static constexpr size_t WINDOW = 32;
+
+    /**
+     * @brief Number of intervals needed before we try to detect missing pulses.
+     */
+    static constexpr size_t MIN_INTERVALS = 4;
+
+    explicit PulseIntervalAnalyzer(double missingFactor = 1.5)
+        : missingFactor(missingFactor) {
+    }
+
+    void record(int64_t timeUs) {
+        if (lastPulseUs.has_value() && timeUs > *lastPulseUs) {
+            auto interval = static_cast<uint32_t>(std::min<int64_t>(timeUs - *lastPulseUs, UINT32_MAX));
+            auto missedInGap = countMissing(interval);
+            if (missedInGap > 0) {
+                // Some of these might have been counted already while checking for silence
+                missed += missedInGap - std::min(missedInGap, missedInSilence);
+                if (++consecutiveGaps >= WINDOW / 4) {
+                    // The source slowed down, start learning again
+                    count = 0;
+                    next = 0;
+                    consecutiveGaps = 0;
+                }
+            } else {
+                consecutiveGaps = 0;
+                intervals[next] = interval;
+                next = (next + 1) % WINDOW;
+                count = std::min(count + 1, WINDOW);
+            }
+        }
+        lastPulseUs = timeUs;
+        missedInSilence = 0;
+        pulses++;
+    }
+
+    /**
+     * @brief Count pulses missing since the last one, for when the source goes quiet altogether.
+     */
+    void checkSilence(int64_t nowUs) {
+        if (!lastPulseUs.has_value() || nowUs <= *lastPulseUs) {
+            return;
+        }
+        auto missing = countMissing(static_cast<uint32_t>(std::min<int64_t>(nowUs - *lastPulseUs, UINT32_MAX)));
+        if (missing > missedInSilence) {
+            missed += missing - missedInSilence;
+            missedInSilence = missing;
+        }
+    }
+
+    /**
+     * @brief Expected interval between pulses, zero while still learning.
+     */
+    uint32_t getExpectedIntervalUs() const {
+        if (count < MIN_INTERVALS) {
+            return 0;
+        }
+        return static_cast<uint32_t>(sum() / count);
+    }
+
+    /**
+     * @brief Interval statistics over the window, with pulses and misses counted since the last call.
+     */
+    PulseIntervalStats takeStats() {
+        PulseIntervalStats stats {
+            .pulses = pulses,
+            .missed = missed,
+        };
+        pulses = 0;
+        missed = 0;
+        if (count == 0) {
+            return stats;
+        }
+        double mean = static_cast<double>(sum()) / count;
+        double variance = 0;
+        uint32_t minInterval = UINT32_MAX;
+        uint32_t maxInterval = 0;
+        for (size_t i = 0; i < count; i++) {
+            variance += (intervals[i] - mean) * (intervals[i] - mean);
+            minInterval = std::min(minInterval, intervals[i]);
+            maxInterval = std::max(maxInterval, intervals[i]);
+        }
+        stats.meanIntervalUs = static_cast<uint32_t>(mean);
+        stats.minIntervalUs = minInterval;
+        stats.maxIntervalUs = maxInterval;
+        stats.jitterUs = static_cast<uint32_t>(std::sqrt(variance / count));
+        return stats;
+    }
+
+private:
+    uint32_t countMissing(uint32_t interval) const {
+        auto expected = getExpectedIntervalUs();
+        if (expected == 0 || interval <= expected * missingFactor) {
+            return 0;
+        }
+        return std::max<uint32_t>(1, static_cast<uint32_t>(std::lround(static_cast<double>(interval) / expected)) - 1);
+    }
+
+    uint64_t sum() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            total += intervals[i];
+        }
+        return total;
+    }
+
+    const double missingFactor;
+    std::array<uint32_t, WINDOW> intervals {};
+    size_t next = 0;
+    size_t count = 0;
+    size_t consecutiveGaps = 0;
+    std::optional<int64_t> lastPulseUs;
+    uint32_t missedInSilence = 0;
+    uint32_t pulses = 0;
+    uint32_t missed = 0;
+};
+
+/**
+ * @brief Turns periodic health checks into a degraded state, with hysteresis so that
+ * a single bad or good period doesn't flip it.
+ */
+class DegradationDetector {
+public:
+    DegradationDetector(double threshold, uint32_t sustainedPeriods)
+        : threshold(threshold)
+        , sustainedPeriods(std::max<uint32_t>(1, sustainedPeriods)) {
+    }
+
+    /**
+     * @brief Evaluate a period with the given number of pulses and misses.
+     *
+     * @return the new state if it changed.
+     */
+    std::optional<bool> evaluate(uint32_t pulses, uint32_t missed) {
+        if (pulses + missed == 0) {
+            // Nothing expected, nothing to judge
+            return std::nullopt;
+        }
+        bool bad = static_cast<double>(missed) / (pulses + missed) > threshold;
+        if (bad == degraded) {
+            streak = 0;
+            return std::nullopt;
+        }
+        if (++streak < sustainedPeriods) {
+            return std::nullopt;
+        }
+        streak = 0;
+        degraded = bad;
+        return degraded;
+    }
+
+    bool isDegraded() const {
+        return degraded;
+    }
+
+private:
+    const double threshold;
+    const uint32_t sustainedPeriods;
+    uint32_t streak = 0;
+    bool degraded = false;
+};
+
+}    // namespace farmhub::kernel
@@ -1,31 +1,317 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include <esp_attr.h>
+
+#include <Concurrent.hpp>
 #include <Task.hpp>
+#include <Time.hpp>
+
+using namespace std::chrono;
 
 namespace farmhub::kernel {
 
+LOGGING_TAG(SHUTDOWN, "shutdown")
+
+struct ShutdownParameters {
+    /**
+     * @brief Listeners should be done by this time.
+     */
+    steady_clock::time_point deadline;
+
+    /**
+     * @brief Power is about to fail, only do what is necessary to reach a safe state.
+     */
+    bool emergency = false;
+};
+
+enum class ShutdownPriority : uint8_t {
+    /**
+     * @brief Brings hardware to a safe state, like closing valves. Runs even when shutting down in an emergency.
+     */
+    Critical,
+    /**
+     * @brief Stops ongoing activity.
+     */
+    Normal,
+    /**
+     * @brief Housekeeping like flushing buffers, runs after everything else.
+     */
+    Deferred,
+};
+
+/**
+ * @brief Outcome of a shutdown, kept in RTC memory so we can report it after waking up or restarting.
+ */
+struct ShutdownRecord {
+    uint32_t magic;
+    /**
+     * @brief Time it took for critical listeners to finish, or to give up on them, in milliseconds.
+     */
+    uint32_t timeToSafeState;
+    /**
+     * @brief Number of listeners that did not finish before the deadline.
+     */
+    uint16_t lateListeners;
+    bool emergency;
+    bool safe;
+};
+
+static RTC_NOINIT_ATTR ShutdownRecord lastShutdownRecord;
+
+/**
+ * @brief Runs shutdown listeners in order of priority, within a deadline.
+ *
+ * Listeners of the same priority are independent of each other, and run concurrently
+ * on a few worker tasks. We move to the next priority when all listeners finished,
+ * or when the deadline passes.
+ */
 class ShutdownManager {
 public:
-    void registerShutdownListener(const std::function<void()>& listener) {
-        shutdownListeners.push_back(listener);
+    using Listener = std::function<void(const ShutdownParameters&)>;
+
+    struct Job {
+        const std::string name;
+        const milliseconds estimatedDuration;
+        const Listener run;
+    };
+
+    void registerShutdownListener(const std::string& name, ShutdownPriority priority, milliseconds estimatedDuration, const Listener& listener) {
+        Lock lock(listenersMutex);
+        listeners.push_back({ priority, Job { name, estimatedDuration, listener } });
     }
 
-    void startShutdown() {
+    /**
+     * @brief Bring hardware to a safe state as fast as possible when power is about to fail.
+     *
+     * Only runs critical listeners, and blocks until they finish or the deadline passes.
+     */
+    bool emergencyShutdown(milliseconds timeout = EMERGENCY_SHUTDOWN_TIMEOUT) {
+        return shutdown(timeout, true);
+    }
+
+    /**
+     * @brief Run the shutdown process, blocking until it finishes or the deadline passes.
+     *
+     * @return whether all critical listeners finished in time.
+     */
+    bool shutdown(milliseconds timeout, bool emergency) {
+        if (shuttingDown.exchange(true)) {
+            LOGTW(SHUTDOWN, "Shutdown already in progress");
+            return false;
+        }
+
+        auto start = steady_clock::now();
+        ShutdownParameters parameters {
+            .deadline = start + timeout,
+            .emergency = emergency,
+        };
+        LOGTI(SHUTDOWN, "Starting %s shutdown with a deadline of %lld ms",
+            emergency ? "emergency" : "graceful", timeout.count());
+
         // Run in separate task to allocate enough stack
-        Task::run("shutdown", 8192, [this](Task& /*task*/) {
-            // Notify all shutdown listeners
-            for (auto& listener : shutdownListeners) {
-                listener();
-            }
-            printf("Shutdown process finished\n");
+        auto result = std::make_shared<CopyQueue<bool>>("shutdown-result", 1);
+        Task::run("shutdown", 8192, [this, parameters, start, result](Task& /*task*/) {
+            result->offer(runSequence(parameters, start));
         });
+        // The sequence stops waiting for listeners at the deadline, it only needs a little more to wrap up
+        auto safe = result->pollIn(clampTicks(timeout + SEQUENCE_WRAP_UP_TIME));
+        if (!safe.has_value()) {
+            LOGTE(SHUTDOWN, "Shutdown process did not finish in time");
+            return false;
+        }
+        return *safe;
+    }
+
+    /**
+     * @brief Run jobs concurrently on a bounded number of worker tasks, and wait for them until they should have finished.
+     *
+     * Jobs get some leeway over their estimated duration, but we don't wait for them past the deadline.
+     * Jobs that have to wait for a free worker are accounted for by waiting longer.
+     *
+     * @return the number of jobs that did not finish in time.
+     */
+    static int runConcurrently(const std::vector<Job>& jobs, const ShutdownParameters& parameters) {
+        if (jobs.empty()) {
+            return 0;
+        }
+
+        auto start = steady_clock::now();
+        auto workers = std::min(jobs.size(), MAX_WORKERS);
+        auto rounds = static_cast<int>((jobs.size() + workers - 1) / workers);
+        auto longestEstimate = 0ms;
+        for (const auto& job : jobs) {
+            longestEstimate = std::max(longestEstimate, job.estimatedDuration);
+        }
+        auto waitUntil = std::min(parameters.deadline, start + longestEstimate * rounds * ESTIMATE_LEEWAY_FACTOR + ESTIMATE_LEEWAY);
+
+        // Shared with the workers, which might outlive this call if a job doesn't finish in time
+        auto run = std::make_shared<ConcurrentRun>(jobs, parameters);
+        for (size_t worker = 0; worker < workers; worker++) {
+            Task::run("shutdown:" + std::to_string(worker), WORKER_STACK_SIZE, [run](Task& /*task*/) {
+                run->work();
+            });
+        }
+
+        std::vector<bool> done(jobs.size(), false);
+        size_t remaining = jobs.size();
+        while (remaining > 0) {
+            auto timeLeft = duration_cast<milliseconds>(waitUntil - steady_clock::now());
+            auto index = run->finished.pollIn(clampTicks(timeLeft));
+            if (!index.has_value()) {
+                break;
+            }
+            done[*index] = true;
+            remaining--;
+        }
+
+        for (size_t index = 0; index < jobs.size(); index++) {
+            if (!done[index]) {
+                LOGTE(SHUTDOWN, "Shutting down '%s' did not finish in time (estimated %lld ms)",
+                    jobs[index].name.c_str(), jobs[index].estimatedDuration.count());
+            }
+        }
+        return static_cast<int>(remaining);
+    }
+
+    /**
+     * @brief Returns the outcome of the shutdown before the last restart or deep sleep, if any.
+     */
+    static std::optional<ShutdownRecord> takePreviousShutdown() {
+        if (lastShutdownRecord.magic != SHUTDOWN_RECORD_MAGIC) {
+            return std::nullopt;
+        }
+        ShutdownRecord record = lastShutdownRecord;
+        lastShutdownRecord.magic = 0;
+        return record;
     }
 
 private:
-    std::list<std::function<void()>> shutdownListeners;
+    bool runSequence(const ShutdownParameters& parameters, steady_clock::time_point start) {
+        bool emergency = parameters.emergency;
+        bool safe = false;
+        milliseconds timeToSafeState {};
+        int lateListeners = 0;
+        for (auto priority : { ShutdownPriority::Critical, ShutdownPriority::Normal, ShutdownPriority::Deferred }) {
+            if (emergency && priority != ShutdownPriority::Critical) {
+                break;
+            }
+            lateListeners += runConcurrently(getJobs(priority), parameters);
+
+            if (priority == ShutdownPriority::Critical) {
+                safe = lateListeners == 0;
+                timeToSafeState = duration_cast<milliseconds>(steady_clock::now() - start);
+                if (safe) {
+                    LOGTI(SHUTDOWN, "Reached safe state in %lld ms", timeToSafeState.count());
+                } else {
+                    LOGTE(SHUTDOWN, "Failed to reach safe state in %lld ms", timeToSafeState.count());
+                }
+            }
+            // Persist as we go, as power might not last until the end
+            recordShutdown(timeToSafeState, lateListeners, emergency, safe);
+        }
+
+        LOGTI(SHUTDOWN, "Shutdown process finished in %lld ms",
+            duration_cast<milliseconds>(steady_clock::now() - start).count());
+        return safe;
+    }
+
+    /**
+     * @brief Jobs of a single `runConcurrently()` call, picked up by workers one after the other.
+     */
+    struct ConcurrentRun {
+        ConcurrentRun(const std::vector<Job>& jobs, const ShutdownParameters& parameters)
+            : jobs(jobs)
+            , parameters(parameters)
+            , finished("shutdown-done", jobs.size()) {
+        }
+
+        void work() {
+            while (true) {
+                auto index = next.fetch_add(1);
+                if (index >= jobs.size()) {
+                    return;
+                }
+                const auto& job = jobs[index];
+                if (steady_clock::now() + job.estimatedDuration > parameters.deadline) {
+                    LOGTW(SHUTDOWN, "Shutting down '%s' is expected to take %lld ms, longer than the time left",
+                        job.name.c_str(), job.estimatedDuration.count());
+                }
+                try {
+                    job.run(parameters);
+                } catch (const std::exception& e) {
+                    LOGTE(SHUTDOWN, "Shutting down '%s' failed: %s",
+                        job.name.c_str(), e.what());
+                }
+                finished.offer(index);
+            }
+        }
+
+        const std::vector<Job> jobs;
+        const ShutdownParameters parameters;
+        std::atomic<size_t> next { 0 };
+        CopyQueue<size_t> finished;
+    };
+
+    std::vector<Job> getJobs(ShutdownPriority priority) {
+        Lock lock(listenersMutex);
+        std::vector<Job> jobs;
+        for (const auto& listener : listeners) {
+            if (listener.priority == priority) {
+                jobs.push_back(listener.job);
+            }
+        }
+        return jobs;
+    }
+
+    static void recordShutdown(milliseconds timeToSafeState, int lateListeners, bool emergency, bool safe) {
+        lastShutdownRecord = {
+            .magic = SHUTDOWN_RECORD_MAGIC,
+            .timeToSafeState = static_cast<uint32_t>(timeToSafeState.count()),
+            .lateListeners = static_cast<uint16_t>(lateListeners),
+            .emergency = emergency,
+            .safe = safe,
+        };
+    }
+
+    struct RegisteredListener {
+        const ShutdownPriority priority;
+        const Job job;
+    };
+
+    static constexpr milliseconds EMERGENCY_SHUTDOWN_TIMEOUT = 2s;
+
+    /**
+     * @brief Time the shutdown sequence is given past the deadline to record its outcome.
+     */
+    static constexpr milliseconds SEQUENCE_WRAP_UP_TIME = 500ms;
+
+    /**
+     * @brief Jobs beyond this many wait for a worker to become free.
+     */
+    static constexpr size_t MAX_WORKERS = 4;
+    static constexpr uint32_t WORKER_STACK_SIZE = 4096;
+
+    /**
+     * @brief Jobs may take this many times their estimate, plus `ESTIMATE_LEEWAY`, before we stop waiting for them.
+     */
+    static constexpr int ESTIMATE_LEEWAY_FACTOR = 2;
+    static constexpr milliseconds ESTIMATE_LEEWAY = 500ms;
+
+    static constexpr uint32_t SHUTDOWN_RECORD_MAGIC = 0x5AFE57A7;
+
+    Mutex listenersMutex;
+    std::list<RegisteredListener> listeners;
+    std::atomic<bool> shuttingDown { false };
 };
 
 }    // namespace farmhub::kernel
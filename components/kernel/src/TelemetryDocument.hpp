@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include <JsonArena.hpp>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Builds telemetry in a persistent document within a size budget.
+ *
+ * Sections are added in order of decreasing priority, after any fields set directly on the root.
+ * A section that would push the serialized size over the budget, or that does not fit in the
+ * arena, is dropped and listed as truncated.
+ *
+ * Sections usually reset their counters as they are populated, so a dropped section is kept
+ * as it was, and sent in place of a fresh one the next time there is room for it. Until then
+ * the section is not populated again, and its counters keep accumulating.
+ */
+class TelemetryDocument {
+public:
+    TelemetryDocument(size_t budget)
+        : budget(budget)
+        , arena(budget * INITIAL_ARENA_SIZE_PER_BYTE, budget * MAX_ARENA_SIZE_PER_BYTE)
+        , doc(&arena) {
+        output.reserve(budget);
+    }
+
+    /**
+     * @brief Drop the previous document and start a new one.
+     */
+    JsonObject begin() {
+        doc.clear();
+        arena.fit();
+        truncated.clear();
+        outOfMemory = false;
+        serializedSize.reset();
+        return doc.to<JsonObject>();
+    }
+
+    /**
+     * @brief Add a section to the document, unless it would not fit.
+     *
+     * @return whether the section was kept.
+     */
+    template <typename T, typename F>
+    bool add(const char* name, F&& populate) {
+        if (outOfMemory) {
+            truncated.push_back(name);
+            return false;
+        }
+        if (!serializedSize.has_value()) {
+            // Fields set directly on the root come before the first section
+            serializedSize = measureJson(doc);
+        }
+
+        auto heldBack = heldBackSections.find(name);
+        if (heldBack != heldBackSections.end()) {
+            // Send what we could not send last time; the fresh values wait for the next report
+            doc[name] = serialized(heldBack->second);
+            if (fits(name)) {
+                heldBackSections.erase(heldBack);
+                return true;
+            }
+            doc.remove(name);
+            if (heldBack->second.size() + STATS_RESERVE > budget) {
+                // It would never fit, start over with fresh values next time
+                heldBackSections.erase(heldBack);
+            }
+            truncated.push_back(name);
+            return false;
+        }
+
+        auto section = doc[name].template to<T>();
+        populate(section);
+        if (fits(name)) {
+            return true;
+        }
+        // Keep the values, as populating the section has most likely reset them at the source
+        std::string values;
+        serializeJson(doc[name], values);
+        heldBackSections.emplace(name, std::move(values));
+        doc.remove(name);
+        truncated.push_back(name);
+        return false;
+    }
+
+    /**
+     * @brief Serialize the document into the output buffer kept between documents.
+     *
+     * The result is valid until the next call.
+     */
+    const std::string& serialize() {
+        auto stats = doc["serialization"].to<JsonObject>();
+        stats["budget"] = budget;
+        stats["arena"] = arena.getCapacity();
+        if (lastPeak > 0) {
+            stats["peak"] = lastPeak;
+        }
+        if (!truncated.empty()) {
+            auto truncatedJson = stats["truncated"].to<JsonArray>();
+            for (const auto* name : truncated) {
+                truncatedJson.add(name);
+            }
+        }
+
+        output.clear();
+        serializeJson(doc, output);
+        lastPeak = arena.getHighWater() + output.size();
+        return output;
+    }
+
+    const std::vector<const char*>& getTruncated() const {
+        return truncated;
+    }
+
+    /**
+     * @brief Bytes used by the arena and the output buffer while producing the last document.
+     */
+    size_t getLastPeak() const {
+        return lastPeak;
+    }
+
+private:
+    /**
+     * @brief Check if the document still fits the budget with the just added section.
+     *
+     * Only the new section is measured, the size of the ones before it is kept as a running total.
+     */
+    bool fits(const char* name) {
+        if (doc.overflowed()) {
+            // The arena is full, there is no point in trying further sections
+            outOfMemory = true;
+            return false;
+        }
+        // Section names are plain identifiers: quotes and a colon, plus a comma if anything comes before it
+        auto sectionSize = std::strlen(name) + 3 + (doc.size() > 1 ? 1 : 0) + measureJson(doc[name]);
+        if (*serializedSize + sectionSize + STATS_RESERVE > budget) {
+            return false;
+        }
+        *serializedSize += sectionSize;
+        return true;
+    }
+
+    /**
+     * @brief The in-memory representation typically takes about twice the serialized size.
+     */
+    static constexpr size_t INITIAL_ARENA_SIZE_PER_BYTE = 2;
+
+    /**
+     * @brief Limit for growing the arena, mostly taken up by short strings and small numbers.
+     */
+    static constexpr size_t MAX_ARENA_SIZE_PER_BYTE = 4;
+
+    /**
+     * @brief Room kept free in the budget for the serialization stats.
+     */
+    static constexpr size_t STATS_RESERVE = 192;
+
+    const size_t budget;
+    JsonArena arena;
+    JsonDocument doc;
+    std::optional<size_t> serializedSize;
+    std::string output;
+
+    // Sections dropped from an earlier document, serialized
+    std::map<std::string, std::string, std::less<>> heldBackSections;
+
+    std::vector<const char*> truncated;
+    bool outOfMemory = false;
+    size_t lastPeak = 0;
+};
+
+}    // namespace farmhub::kernel
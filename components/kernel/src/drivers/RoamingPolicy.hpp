@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel::drivers {
+
+/**
+ * @brief Decides when to look for a better access point and when to switch to one.
+ *
+ * We only scan when the current link is weak, and not more often than the scan interval
+ * to keep the radio duty low. A candidate must be better than the current AP by the
+ * hysteresis margin, and roams are rate limited to avoid flapping between APs of similar strength.
+ */
+class RoamingPolicy {
+public:
+    struct Config {
+        /**
+         * @brief Scan for better APs only when the current RSSI is below this, in dBm.
+         */
+        int8_t scanThreshold = -75;
+        /**
+         * @brief A candidate must be at least this much stronger than the current AP, in dB.
+         */
+        int8_t hysteresis = 8;
+        milliseconds scanInterval = 5min;
+        milliseconds minRoamInterval = 15min;
+    };
+
+    RoamingPolicy(const Config& config)
+        : config(config) {
+    }
+
+    bool shouldScan(int8_t currentRssi, steady_clock::time_point now) {
+        if (currentRssi >= config.scanThreshold) {
+            return false;
+        }
+        if (lastScan.has_value() && now - *lastScan < config.scanInterval) {
+            return false;
+        }
+        if (lastRoam.has_value() && now - *lastRoam < config.minRoamInterval) {
+            return false;
+        }
+        lastScan = now;
+        return true;
+    }
+
+    bool shouldRoam(int8_t currentRssi, int8_t candidateRssi) const {
+        return candidateRssi >= currentRssi + config.hysteresis;
+    }
+
+    void recordRoam(steady_clock::time_point now) {
+        lastRoam = now;
+    }
+
+private:
+    const Config config;
+    std::optional<steady_clock::time_point> lastScan;
+    std::optional<steady_clock::time_point> lastRoam;
+};
+
+}    // namespace farmhub::kernel::drivers
@@ -2,12 +2,16 @@
 
 #include <chrono>
 #include <optional>
+#include <sys/time.h>
 #include <time.h>
 
 #include "esp_netif_sntp.h"
 #include "esp_sntp.h"
 
+#include <ClockDiscipline.hpp>
+#include <Concurrent.hpp>
 #include <Configuration.hpp>
+#include <ConnectivityCoordinator.hpp>
 #include <State.hpp>
 #include <Task.hpp>
 #include <utility>
@@ -26,6 +30,9 @@ LOGGING_TAG(RTC, "rtc")
  *
  * - The first task waits for the system time to be set. It sets the RTC in sync state when the time is set.
  *   This task is non-blocking, and will pass if the RTC is already set during a previous boot.
+ *
+ * Each sync measures how far the clock drifted since the previous one. Between syncs the clock is slewed
+ * to compensate for the estimated drift, and syncs become less frequent as the estimate stabilizes.
  */
 class RtcDriver {
 public:
@@ -34,8 +41,9 @@ public:
         Property<std::string> host { this, "host", "" };
     };
 
-    RtcDriver(State& networkReady, const std::shared_ptr<Config>& ntpConfig, StateSource& rtcInSync)
-        : ntpConfig(ntpConfig)
+    RtcDriver(State& networkReady, const std::shared_ptr<ConnectivityCoordinator>& connectivity, const std::shared_ptr<Config>& ntpConfig, StateSource& rtcInSync)
+        : connectivity(connectivity)
+        , ntpConfig(ntpConfig)
         , rtcInSync(rtcInSync) {
 
         if (isTimeSet()) {
@@ -47,17 +55,34 @@ public:
             while (true) {
                 {
                     networkReady.awaitSet();
-                    if (!updateTime()) {
-                        // Attempt a retry
-                        // TODO Do exponential backoff
-                        LOGTE(RTC, "NTP update failed, retrying in 10 seconds");
-                        Task::delay(10s);
+                    auto backoff = this->connectivity->untilNextAttempt(Connection::Ntp);
+                    if (!backoff.has_value()) {
+                        // The coordinator hasn't seen the network come up yet
+                        Task::delay(NTP_NETWORK_CHECK_INTERVAL);
+                        continue;
+                    }
+                    if (*backoff > 0ms) {
+                        // Check back regularly, as the network coming back up cuts the backoff short
+                        Task::delay(clampTicks(std::min(*backoff, NTP_RETRY_CHECK_INTERVAL)));
+                        applyDriftCorrection();
+                        continue;
+                    }
+                    this->connectivity->attemptStarted(Connection::Ntp);
+                    bool success = updateTime();
+                    this->connectivity->attemptFinished(Connection::Ntp, success);
+                    if (!success) {
+                        LOGTE(RTC, "NTP update failed, retrying in %lld seconds",
+                            duration_cast<seconds>(this->connectivity->untilNextAttempt(Connection::Ntp).value_or(0ms)).count());
                         continue;
                     }
                 }
 
-                // We are good for a while now
-                Task::delay(1h);
+                // We are good for a while now, only keep correcting for drift
+                auto nextSync = steady_clock::now() + getResyncInterval();
+                for (auto now = steady_clock::now(); now < nextSync; now = steady_clock::now()) {
+                    Task::delay(clampTicks(std::min(DRIFT_CORRECTION_INTERVAL, duration_cast<milliseconds>(nextSync - now))));
+                    applyDriftCorrection();
+                }
             }
         });
     }
@@ -75,7 +100,64 @@ public:
         return rtcInSync;
     }
 
+    void populateTelemetry(JsonObject& json) {
+        Lock lock(disciplineMutex);
+        json["syncs"] = discipline.getSyncCount();
+        json["offset"] = static_cast<double>(discipline.getLastOffset().count()) / 1000.0;
+        auto drift = discipline.getDriftPpm();
+        if (drift.has_value()) {
+            json["drift"] = *drift;
+        }
+    }
+
 private:
+    milliseconds getResyncInterval() {
+        Lock lock(disciplineMutex);
+        return discipline.getResyncInterval();
+    }
+
+    void applyDriftCorrection() {
+        microseconds correction;
+        {
+            Lock lock(disciplineMutex);
+            correction = discipline.takeCorrection(steady_clock::now());
+        }
+        if (correction != microseconds::zero()) {
+            LOGTV(RTC, "Slewing clock by %lld us to correct drift",
+                correction.count());
+            adjustTime(getPendingAdjustment() + correction);
+        }
+    }
+
+    /**
+     * @brief Offset of the system clock from the monotonic clock, including any adjustment still being slewed in.
+     */
+    static microseconds getClockOffset() {
+        auto offset = duration_cast<microseconds>(system_clock::now().time_since_epoch())
+            - duration_cast<microseconds>(steady_clock::now().time_since_epoch());
+        return offset + getPendingAdjustment();
+    }
+
+    static microseconds getPendingAdjustment() {
+        timeval pending {};
+        if (adjtime(nullptr, &pending) != 0) {
+            return microseconds::zero();
+        }
+        return seconds(pending.tv_sec) + microseconds(pending.tv_usec);
+    }
+
+    static void adjustTime(microseconds delta) {
+        auto wholeSeconds = duration_cast<seconds>(delta);
+        timeval adjustment {
+            .tv_sec = static_cast<time_t>(wholeSeconds.count()),
+            .tv_usec = static_cast<suseconds_t>((delta - wholeSeconds).count()),
+        };
+        if (adjtime(&adjustment, nullptr) != 0) {
+            LOGTW(RTC, "Failed to adjust time by %lld us",
+                delta.count());
+        }
+    }
+
     bool updateTime() {
         esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
         config.start = false;
@@ -93,6 +175,7 @@ private:
         }
 
         bool success = false;
+        auto offsetBefore = getClockOffset();
         ESP_ERROR_CHECK(esp_netif_sntp_start());
 
         auto ret = esp_netif_sntp_sync_wait(ticks(10s).count());
@@ -101,7 +184,14 @@ private:
         if (ret == ESP_OK || ret == ESP_ERR_NOT_FINISHED) {
             rtcInSync.set();
             success = true;
-            LOGTD(RTC, "Sync finished successfully");
+            // Whatever the sync stepped or is still slewing is how far we drifted
+            auto offset = getClockOffset() - offsetBefore;
+            {
+                Lock lock(disciplineMutex);
+                discipline.recordSync(offset, steady_clock::now());
+            }
+            LOGTD(RTC, "Sync finished successfully, offset: %lld us",
+                offset.count());
         } else if (ret == ESP_ERR_TIMEOUT) {
             LOGTD(RTC, "Waiting for time sync timed out");
         } else {
@@ -112,8 +202,18 @@ private:
         return success;
     }
 
+    static constexpr milliseconds NTP_NETWORK_CHECK_INTERVAL = 1s;
+    static constexpr milliseconds NTP_RETRY_CHECK_INTERVAL = 30s;
+    static constexpr milliseconds NTP_MIN_RESYNC_INTERVAL = 1h;
+    static constexpr milliseconds NTP_MAX_RESYNC_INTERVAL = 24h;
+    static constexpr milliseconds DRIFT_CORRECTION_INTERVAL = 10min;
+
+    const std::shared_ptr<ConnectivityCoordinator> connectivity;
     const std::shared_ptr<Config> ntpConfig;
     StateSource& rtcInSync;
+
+    Mutex disciplineMutex;
+    ClockDiscipline discipline { NTP_MIN_RESYNC_INTERVAL, NTP_MAX_RESYNC_INTERVAL };
 };
 
 }    // namespace farmhub::kernel::drivers
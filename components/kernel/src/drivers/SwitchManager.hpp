@@ -5,9 +5,11 @@
 #include <utility>
 
 #include <driver/gpio.h>
+#include <esp_timer.h>
 #include <hal/gpio_types.h>
 
 #include <Concurrent.hpp>
+#include <FlashBusyEdges.hpp>
 #include <Pin.hpp>
 #include <Task.hpp>
 
@@ -140,7 +142,7 @@ private:
             , engageHandler(std::move(engageHandler))
             , disengageHandler(std::move(disengageHandler))
             , debounceTime(debounceTime)
-            , lastChangeTime(steady_clock::now())
+            , lastChangeTime(esp_timer_get_time())
             , lastReportedState(isEngaged()) {
         }
 
@@ -166,7 +168,10 @@ private:
         SwitchEventHandler disengageHandler;
 
         milliseconds debounceTime;
-        steady_clock::time_point lastChangeTime;
+        /**
+         * @brief From esp_timer_get_time(), as steady_clock is not safe to use with the cache disabled.
+         */
+        int64_t lastChangeTime;
         bool lastReportedState;
 
         friend class SwitchManager;
@@ -184,10 +189,10 @@ private:
 static void IRAM_ATTR handleSwitchInterrupt(void* arg) {
     auto* state = static_cast<SwitchManager::SwitchState*>(arg);
 
-    // Must use gpio_get_level() to read the pin state instead of pin->digitalRead()
+    // Must use digitalReadFromISR() to read the pin state instead of pin->digitalRead()
     // because we cannot call virtual methods from an ISR
     auto gpio = state->pin->getGpio();
-    bool engaged = gpio_get_level(gpio) == (state->mode == SwitchMode::PullUp ? 0 : 1);
+    bool engaged = state->pin->digitalReadFromISR() == (state->mode == SwitchMode::PullUp ? 0 : 1);
 
     // Ignore if the state hasn't actually changed from what we last reported
     if (engaged == state->lastReportedState) {
@@ -195,11 +200,12 @@ static void IRAM_ATTR handleSwitchInterrupt(void* arg) {
     }
 
     // Software debounce: ignore state changes that happen too quickly
-    auto now = steady_clock::now();
-    auto timeSinceLastChange = duration_cast<milliseconds>(now - state->lastChangeTime);
+    auto now = esp_timer_get_time();
+    auto timeSinceLastChange = milliseconds((now - state->lastChangeTime) / 1000);
     if (timeSinceLastChange < state->debounceTime) {
         return;
     }
+    FlashBusyEdges::record();
 
     // Update state tracking
     state->lastChangeTime = now;
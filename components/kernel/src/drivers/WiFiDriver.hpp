@@ -1,18 +1,25 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <list>
+#include <vector>
 
 #include <esp_event.h>
+#include <esp_mac.h>
 #include <esp_wifi.h>
 #include <wifi_provisioning/manager.h>
 #include <wifi_provisioning/scheme_softap.h>
 
 #include <Concurrent.hpp>
+#include <ConnectivityCoordinator.hpp>
+#include <EnergyLedger.hpp>
 #include <State.hpp>
 #include <StateManager.hpp>
 #include <Task.hpp>
 #include <Telemetry.hpp>
+#include <drivers/RoamingPolicy.hpp>
 
 using namespace std::chrono;
 using namespace std::chrono_literals;
@@ -28,11 +35,18 @@ public:
         StateSource& networkConnecting,
         StateSource& networkReady,
         StateSource& configPortalRunning,
-        const std::string& hostname)
+        const std::string& hostname,
+        uint16_t listenInterval,
+        const std::shared_ptr<ConnectivityCoordinator>& connectivity,
+        const std::shared_ptr<EnergyLedger>& energy)
         : networkConnecting(networkConnecting)
         , networkReady(networkReady)
         , configPortalRunning(configPortalRunning)
-        , hostname(hostname) {
+        , hostname(hostname)
+        , listenInterval(listenInterval)
+        , connectivity(connectivity)
+        , connectingEnergy(energy->registerConsumer("wifi:connecting", WIFI_CONNECTING_CURRENT))
+        , connectedEnergy(energy->registerConsumer("wifi:connected", WIFI_CONNECTED_CURRENT)) {
         LOGTV(WIFI, "Registering WiFi handlers");
 
         // Initialize TCP/IP adapter and event loop
@@ -57,6 +71,26 @@ public:
         });
     }
 
+    /**
+     * @brief Duration of the standard beacon interval of 100 TU.
+     */
+    static constexpr microseconds BEACON_INTERVAL = 102400us;
+
+    /**
+     * @brief The longest listen interval, in beacons, that still delivers traffic within the given latency.
+     */
+    static uint16_t listenIntervalFor(milliseconds latency) {
+        auto beacons = duration_cast<microseconds>(latency) / BEACON_INTERVAL;
+        return static_cast<uint16_t>(std::clamp<int64_t>(beacons, 1, MAX_LISTEN_INTERVAL));
+    }
+
+    /**
+     * @brief How often the radio wakes to listen for buffered traffic in power save mode.
+     */
+    milliseconds getListenPeriod() const {
+        return duration_cast<milliseconds>(BEACON_INTERVAL * listenInterval);
+    }
+
     static void setPowerSaveMode(bool enable) {
         ESP_ERROR_CHECK(esp_wifi_set_ps(enable
                 ? WIFI_PS_MAX_MODEM
@@ -88,6 +122,16 @@ public:
             }
         }
         json["disconnects"] = disconnectCount.exchange(0, std::memory_order_relaxed);
+        json["roams"] = roamCount.exchange(0, std::memory_order_relaxed);
+        {
+            Lock lock(metadataMutex);
+            if (lastRoam.has_value()) {
+                auto roam = json["last-roam"].to<JsonObject>();
+                roam["rssi-before"] = lastRoam->rssiBefore;
+                roam["rssi-after"] = lastRoam->rssiAfter;
+                lastRoam.reset();
+            }
+        }
     }
 
     State& getNetworkConnecting() {
@@ -150,6 +194,10 @@ private:
                     event->ssid_len, reinterpret_cast<const char*>(event->ssid), event->reason);
                 break;
             }
+            case WIFI_EVENT_SCAN_DONE: {
+                eventQueue.offer(WiFiEvent::ScanDone);
+                break;
+            }
             case WIFI_EVENT_AP_STACONNECTED: {
                 LOGTI(WIFI, "SoftAP transport connected");
                 break;
@@ -234,6 +282,7 @@ private:
         bool connected = false;
         steady_clock::time_point connectingSince;
         while (true) {
+            auto checkIn = WIFI_CHECK_INTERVAL;
             if (!connected) {
                 if (configPortalRunning.isSet()) {
                     // TODO Add some sort of timeout here
@@ -246,16 +295,32 @@ private:
                         goto handleEvents;
                     }
 
-                    LOGTI(WIFI, "Connection timed out, retrying");
+                    LOGTI(WIFI, "Connection timed out");
+                    if (roaming != Roaming::Idle) {
+                        // Roaming is not a connection attempt, we lost the link we had
+                        roaming = Roaming::Idle;
+                        connectivity->connectionLost(Connection::WiFi);
+                    } else {
+                        connectivity->attemptFinished(Connection::WiFi, false);
+                    }
                     networkConnecting.clear();
+                    connectingEnergy->end();
                     ensureWifiStopped();
                 }
+                auto backoff = connectivity->untilNextAttempt(Connection::WiFi).value_or(0ms);
+                if (backoff > 0ms) {
+                    LOGTV(WIFI, "Backing off for %lld ms before connecting",
+                        backoff.count());
+                    checkIn = std::min(checkIn, backoff);
+                    goto handleEvents;
+                }
                 connectingSince = steady_clock::now();
+                connectivity->attemptStarted(Connection::WiFi);
                 connect();
             }
 
         handleEvents:
-            for (auto event = eventQueue.pollIn(WIFI_CHECK_INTERVAL); event.has_value(); event = eventQueue.poll()) {
+            for (auto event = eventQueue.pollIn(checkIn); event.has_value(); event = eventQueue.poll()) {
                 // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
                 switch (event.value()) {
                     case WiFiEvent::Started:
@@ -268,27 +333,210 @@ private:
                         }
                         break;
                     case WiFiEvent::Connected:
+                        if (!connected) {
+                            connectedEnergy->begin();
+                        }
                         connected = true;
                         networkConnecting.clear();
+                        connectingEnergy->end();
                         LOGTD(WIFI, "Connected to the network");
+                        if (roaming == Roaming::Joining) {
+                            finishRoaming();
+                        } else if (roaming == Roaming::Returning) {
+                            LOGTI(WIFI, "Returned to the previous AP");
+                            roaming = Roaming::Idle;
+                            // Don't try the AP that failed us again too soon
+                            roamingPolicy.recordRoam(steady_clock::now());
+                        } else {
+                            connectivity->attemptFinished(Connection::WiFi, true);
+                        }
                         break;
-                    case WiFiEvent::Disconnected:
+                    case WiFiEvent::Disconnected: {
+                        if (connected) {
+                            connectedEnergy->end();
+                        }
+                        // While roaming we had a link, even when we are in between APs
+                        bool hadLink = connected || roaming != Roaming::Idle;
                         connected = false;
+                        if (continueRoaming()) {
+                            break;
+                        }
+                        if (hadLink) {
+                            connectivity->connectionLost(Connection::WiFi);
+                        } else if (networkConnecting.isSet()) {
+                            connectivity->attemptFinished(Connection::WiFi, false);
+                        }
                         networkConnecting.clear();
+                        connectingEnergy->end();
                         LOGTD(WIFI, "Disconnected from the network");
                         disconnectCount++;
                         break;
+                    }
+                    case WiFiEvent::ScanDone:
+                        if (roaming == Roaming::Scanning && switchToBetterAccessPoint()) {
+                            connectingSince = steady_clock::now();
+                        }
+                        break;
                     case WiFiEvent::ProvisioningFinished:
                         configPortalRunning.clear();
                         break;
                 }
             }
+
+            if (connected && roaming == Roaming::Idle) {
+                startRoamingScanIfNecessary();
+            }
         }
     }
     // NOLINTEND(cppcoreguidelines-avoid-goto)
 
+    /**
+     * @brief Starts scanning for a stronger AP with the same SSID in the background when the link is weak.
+     *
+     * The scan does not block the driver loop; its results are handled when `WIFI_EVENT_SCAN_DONE` arrives.
+     */
+    void startRoamingScanIfNecessary() {
+        if (esp_wifi_sta_get_ap_info(&roamingFrom) != ESP_OK) {
+            return;
+        }
+        if (!roamingPolicy.shouldScan(roamingFrom.rssi, steady_clock::now())) {
+            return;
+        }
+
+        LOGTD(WIFI, "Link to AP is weak (%d dBm), scanning for a better one",
+            roamingFrom.rssi);
+        wifi_scan_config_t scanConfig = {};
+        scanConfig.ssid = roamingFrom.ssid;
+        scanConfig.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+        scanConfig.scan_time.active.min = duration_cast<milliseconds>(ROAMING_SCAN_TIME_PER_CHANNEL).count();
+        scanConfig.scan_time.active.max = duration_cast<milliseconds>(ROAMING_SCAN_TIME_PER_CHANNEL).count();
+        esp_err_t err = esp_wifi_scan_start(&scanConfig, false);
+        if (err != ESP_OK) {
+            LOGTD(WIFI, "Failed to scan for APs: %s", esp_err_to_name(err));
+            return;
+        }
+        roaming = Roaming::Scanning;
+    }
+
+    /**
+     * @brief Picks the strongest AP from the finished scan, and switches to it if it is better enough.
+     *
+     * @return true if we started switching.
+     */
+    bool switchToBetterAccessPoint() {
+        roaming = Roaming::Idle;
+
+        uint16_t count = ROAMING_MAX_SCAN_RESULTS;
+        std::vector<wifi_ap_record_t> records(count);
+        esp_err_t err = esp_wifi_scan_get_ap_records(&count, records.data());
+        if (err != ESP_OK) {
+            LOGTD(WIFI, "Failed to get scan results: %s", esp_err_to_name(err));
+            return false;
+        }
+        records.resize(count);
+
+        const wifi_ap_record_t* best = nullptr;
+        for (const auto& record : records) {
+            if (memcmp(record.bssid, roamingFrom.bssid, sizeof(record.bssid)) == 0) {
+                continue;
+            }
+            if (best == nullptr || record.rssi > best->rssi) {
+                best = &record;
+            }
+        }
+        if (best == nullptr || !roamingPolicy.shouldRoam(roamingFrom.rssi, best->rssi)) {
+            LOGTD(WIFI, "No better AP found (best candidate: %d dBm)",
+                best == nullptr ? 0 : best->rssi);
+            return false;
+        }
+
+        LOGTI(WIFI, "Roaming to AP " MACSTR " on channel %d (%d dBm -> %d dBm)",
+            MAC2STR(best->bssid), best->primary, roamingFrom.rssi, best->rssi);
+        pinAccessPoint(best->bssid, best->primary);
+
+        roaming = Roaming::Leaving;
+        networkConnecting.set();
+        connectingEnergy->begin();
+        ESP_ERROR_CHECK(esp_wifi_disconnect());
+        return true;
+    }
+
+    /**
+     * @brief Takes roaming to its next step after a disconnect.
+     *
+     * Leaving the old AP is followed by a single attempt at the new one. If that fails, we make a
+     * single attempt to return to the old AP, and if that fails too, we give up and let the caller
+     * handle it as a lost connection, reconnecting with the usual backoff.
+     *
+     * @return true if we are still roaming.
+     */
+    bool continueRoaming() {
+        switch (roaming) {
+            case Roaming::Idle:
+                return false;
+            case Roaming::Scanning:
+                LOGTD(WIFI, "Link lost while scanning for a better AP");
+                roaming = Roaming::Idle;
+                esp_wifi_scan_stop();
+                return false;
+            case Roaming::Leaving:
+                LOGTD(WIFI, "Disconnected from the old AP, connecting to the new one");
+                roaming = Roaming::Joining;
+                return reconnectWhileRoaming();
+            case Roaming::Joining:
+                LOGTI(WIFI, "Failed to connect to the new AP, returning to the previous one");
+                roaming = Roaming::Returning;
+                pinAccessPoint(roamingFrom.bssid, roamingFrom.primary);
+                return reconnectWhileRoaming();
+            case Roaming::Returning:
+                LOGTI(WIFI, "Failed to return to the previous AP, reconnecting");
+                roaming = Roaming::Idle;
+                roamingPolicy.recordRoam(steady_clock::now());
+                return false;
+        }
+        return false;
+    }
+
+    bool reconnectWhileRoaming() {
+        esp_err_t err = esp_wifi_connect();
+        if (err != ESP_OK) {
+            LOGTD(WIFI, "Failed to start connecting while roaming: %s", esp_err_to_name(err));
+            roaming = Roaming::Idle;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Pins the given AP in RAM only, so a reboot or full reconnect can still pick any AP.
+     */
+    static void pinAccessPoint(const uint8_t* bssid, uint8_t channel) {
+        wifi_config_t config;
+        ESP_ERROR_CHECK(esp_wifi_get_config(WIFI_IF_STA, &config));
+        config.sta.bssid_set = true;
+        memcpy(config.sta.bssid, bssid, sizeof(config.sta.bssid));
+        config.sta.channel = channel;
+        ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+        ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &config));
+        ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_FLASH));
+    }
+
+    void finishRoaming() {
+        roaming = Roaming::Idle;
+        roamingPolicy.recordRoam(steady_clock::now());
+        roamCount++;
+
+        wifi_ap_record_t apInfo = {};
+        int8_t rssiAfter = esp_wifi_sta_get_ap_info(&apInfo) == ESP_OK ? apInfo.rssi : 0;
+        LOGTI(WIFI, "Roamed to new AP (%d dBm -> %d dBm)",
+            roamingFrom.rssi, rssiAfter);
+        Lock lock(metadataMutex);
+        lastRoam = Roam { .rssiBefore = roamingFrom.rssi, .rssiAfter = rssiAfter };
+    }
+
     void connect() {
         networkConnecting.set();
+        connectingEnergy->begin();
 
 #ifdef WOKWI
         LOGTD(WIFI, "Skipping provisioning on Wokwi");
@@ -304,6 +552,9 @@ private:
         if (provisioned) {
             wifi_config_t wifiConfig;
             ESP_ERROR_CHECK(esp_wifi_get_config(WIFI_IF_STA, &wifiConfig));
+            // Forget any AP pinned while roaming, and let the strongest one win
+            wifiConfig.sta.bssid_set = false;
+            wifiConfig.sta.channel = 0;
             LOGTI(WIFI, "Connecting using stored credentials to %s",
                 wifiConfig.sta.ssid);
             connectToStation(wifiConfig);
@@ -317,10 +568,15 @@ private:
 
     void ensureWifiStationStarted(wifi_config_t& config) {
         if (!stationStarted.isSet()) {
-            auto listenInterval = 20;
-            LOGTV(WIFI, "Enabling power save mode, listen interval: %d DTIM beacons (%d ms)",
-                listenInterval, listenInterval * 100);
+            LOGTV(WIFI, "Enabling power save mode, listen interval: %d beacons (%lld ms)",
+                listenInterval, getListenPeriod().count());
             config.sta.listen_interval = listenInterval;
+
+            // Pick the strongest AP with our SSID, and let APs help us roam via 802.11k/v
+            config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+            config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+            config.sta.rm_enabled = true;
+            config.sta.btm_enabled = true;
 #ifdef SOC_PM_SUPPORT_WIFI_WAKEUP
             LOGTV(WIFI, "Enabling wake on WiFi");
             ESP_ERROR_CHECK(esp_sleep_enable_wifi_wakeup());
@@ -401,6 +657,26 @@ private:
     StateSource& networkReady;
     StateSource& configPortalRunning;
     const std::string hostname;
+    const uint16_t listenInterval;
+    const std::shared_ptr<ConnectivityCoordinator> connectivity;
+
+    /**
+     * @brief Upper limit of the listen interval; APs drop buffered frames for stations that sleep much longer.
+     */
+    static constexpr int64_t MAX_LISTEN_INTERVAL = 100;
+
+    /**
+     * @brief Typical current draw while scanning and associating with the radio fully on, in mA.
+     */
+    static constexpr double WIFI_CONNECTING_CURRENT = 95.0;
+
+    /**
+     * @brief Typical average current draw of staying associated in modem sleep, in mA.
+     */
+    static constexpr double WIFI_CONNECTED_CURRENT = 4.0;
+
+    const std::shared_ptr<EnergyConsumer> connectingEnergy;
+    const std::shared_ptr<EnergyConsumer> connectedEnergy;
 
     StateManager internalStates;
     StateSource stationStarted = internalStates.createStateSource("wifi:station-started");
@@ -409,6 +685,7 @@ private:
         Started,
         Connected,
         Disconnected,
+        ScanDone,
         ProvisioningFinished,
     };
 
@@ -418,11 +695,39 @@ private:
     static constexpr milliseconds WIFI_CONNECTION_TIMEOUT = 1min;
     static constexpr milliseconds WIFI_CHECK_INTERVAL = 1min;
 
+    static constexpr milliseconds ROAMING_SCAN_TIME_PER_CHANNEL = 60ms;
+    static constexpr uint16_t ROAMING_MAX_SCAN_RESULTS = 8;
+
+    RoamingPolicy roamingPolicy { {} };
+
+    enum class Roaming : uint8_t {
+        Idle,
+        // Scanning for a stronger AP in the background
+        Scanning,
+        // Disconnecting from the current AP on purpose
+        Leaving,
+        // Connecting to the stronger AP
+        Joining,
+        // Connecting to the previous AP, as the stronger one did not work out
+        Returning,
+    };
+
+    Roaming roaming = Roaming::Idle;
+    // The AP we were connected to when we started roaming; also holds the SSID for the scan in progress
+    wifi_ap_record_t roamingFrom = {};
+
+    struct Roam {
+        int8_t rssiBefore;
+        int8_t rssiAfter;
+    };
+
     Mutex metadataMutex;
     std::optional<std::string> ssid;
     std::optional<esp_ip4_addr_t> ip;
+    std::optional<Roam> lastRoam;
 
     std::atomic<int> disconnectCount { 0 };
+    std::atomic<int> roamCount { 0 };
 };
 
 }    // namespace farmhub::kernel::drivers
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include <Hash.hpp>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel::mqtt {
+
+/**
+ * @brief Resolved broker address, laid out so it can live in RTC memory across deep sleep.
+ */
+struct BrokerAddressRecord {
+    uint32_t magic;
+    uint32_t hostHash;
+    /**
+     * @brief IPv4 address in network byte order.
+     */
+    uint32_t address;
+    uint32_t port;
+    /**
+     * @brief Wall-clock time of the lookup, in seconds since the epoch.
+     */
+    int64_t resolvedAt;
+    int64_t ttl;
+    /**
+     * @brief Guards against RTC memory that was never written, or was corrupted.
+     */
+    uint32_t check;
+};
+
+/**
+ * @brief Remembers the address of the MQTT broker for a while, so reconnecting doesn't need a DNS lookup.
+ *
+ * The record is only trusted if it was written for the same host and port, and the clock hasn't
+ * moved backwards since; a clock jumping forward, like after the first time sync, expires it.
+ */
+class BrokerAddressCache {
+public:
+    explicit BrokerAddressCache(BrokerAddressRecord& record)
+        : record(record) {
+    }
+
+    std::optional<uint32_t> lookup(std::string_view host, uint32_t port, seconds now) const {
+        if (record.magic != MAGIC
+            || record.check != checksum(record)
+            || record.hostHash != fnv1a(host)
+            || record.port != port) {
+            return std::nullopt;
+        }
+        if (now.count() < record.resolvedAt || now.count() >= record.resolvedAt + record.ttl) {
+            return std::nullopt;
+        }
+        return record.address;
+    }
+
+    void store(std::string_view host, uint32_t port, uint32_t address, seconds now, seconds ttl) {
+        record = {
+            .magic = MAGIC,
+            .hostHash = fnv1a(host),
+            .address = address,
+            .port = port,
+            .resolvedAt = now.count(),
+            .ttl = ttl.count(),
+            .check = 0,
+        };
+        record.check = checksum(record);
+    }
+
+    /**
+     * @brief Forget the address, e.g. because we could not connect to it.
+     */
+    void invalidate() {
+        record.magic = 0;
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0xB20CE2AD;
+
+    static uint32_t checksum(const BrokerAddressRecord& record) {
+        return mix32(record.hostHash
+            ^ mix32(record.address)
+            ^ mix32(record.port)
+            ^ mix32(static_cast<uint32_t>(record.resolvedAt))
+            ^ mix32(static_cast<uint32_t>(record.ttl)));
+    }
+
+    BrokerAddressRecord& record;
+};
+
+}    // namespace farmhub::kernel::mqtt
@@ -5,18 +5,30 @@
 #include <list>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include <esp_attr.h>
 #include <esp_event.h>
+#include <esp_timer.h>
+#include <lwip/netdb.h>
+#include <lwip/sockets.h>
 #include <mqtt_client.h>
 
 #include <Concurrent.hpp>
 #include <Configuration.hpp>
+#include <ConnectivityCoordinator.hpp>
+#include <EnergyLedger.hpp>
+#include <Lzss.hpp>
+#include <PowerManager.hpp>
 #include <State.hpp>
 #include <Task.hpp>
+#include <mqtt/BrokerAddressCache.hpp>
 #include <mqtt/PendingMessages.hpp>
+#include <mqtt/Topics.hpp>
+#include <mqtt/TransmitScheduler.hpp>
 
 using namespace std::chrono;
 using namespace std::chrono_literals;
@@ -43,10 +55,23 @@ enum class LogPublish : uint8_t {
     Silent
 };
 
+enum class Delivery : uint8_t {
+    /**
+     * @brief The message can wait for the next radio wake window.
+     */
+    Batched,
+    /**
+     * @brief Send right away, e.g. a response someone is waiting for.
+     */
+    Immediate
+};
+
 using CommandHandler = std::function<void(const JsonObject&, JsonObject&)>;
 
 using SubscriptionHandler = std::function<void(const std::string&, const JsonObject&)>;
 
+static RTC_NOINIT_ATTR BrokerAddressRecord brokerAddressRecord;
+
 class MqttRoot;
 
 class MqttDriver {
@@ -60,21 +85,35 @@ public:
         ArrayProperty<std::string> serverCert { this, "serverCert" };
         ArrayProperty<std::string> clientCert { this, "clientCert" };
         ArrayProperty<std::string> clientKey { this, "clientKey" };
+        // How long to reuse the resolved broker address, including across deep sleep; 0 to resolve every time
+        Property<seconds> addressCacheTtl { this, "addressCacheTtl", 1h };
     };
 
     MqttDriver(
         State& networkReady,
         const std::shared_ptr<Config>& config,
         const std::string& instanceName,
-        StateSource& ready)
+        StateSource& ready,
+        milliseconds listenPeriod,
+        bool batchTraffic,
+        size_t compressAbove,
+        const std::shared_ptr<ConnectivityCoordinator>& connectivity,
+        const std::shared_ptr<EnergyLedger>& energy)
         : networkReady(networkReady)
+        , connectivity(connectivity)
         , configHostname(config->host.get())
         , configPort(config->port.get())
         , configServerCert(joinStrings(config->serverCert.get()))
         , configClientCert(joinStrings(config->clientCert.get()))
         , configClientKey(joinStrings(config->clientKey.get()))
         , clientId(getClientId(config->clientId.get(), instanceName))
+        , addressCacheTtl(config->addressCacheTtl.get())
+        , addressCache(brokerAddressRecord)
         , ready(ready)
+        , energy(energy->registerConsumer("mqtt", MQTT_TRANSMIT_CURRENT))
+        , listenPeriod(listenPeriod)
+        , scheduler(listenPeriod, batchTraffic)
+        , compressAbove(compressAbove)
         , eventQueue("mqtt-outgoing", config->queueSize.get())
         , incomingQueue("mqtt-incoming", config->queueSize.get()) {
 
@@ -99,6 +138,54 @@ public:
 
     void populateTelemetry(JsonObject& json) {
         json["disconnects"] = disconnectCount.exchange(0, std::memory_order_relaxed);
+
+        auto connectionJson = json["connection"].to<JsonObject>();
+        auto connects = connectCount.exchange(0, std::memory_order_relaxed);
+        connectionJson["count"] = connects;
+        if (connects > 0) {
+            connectionJson["average"] = connectTimeSum.exchange(0, std::memory_order_relaxed) / connects / 1000;
+            connectionJson["max"] = connectTimeMax.exchange(0, std::memory_order_relaxed) / 1000;
+        }
+        connectionJson["cached-address"] = cachedAddressCount.exchange(0, std::memory_order_relaxed);
+        connectionJson["lookups"] = lookupCount.exchange(0, std::memory_order_relaxed);
+        connectionJson["lookup-time"] = lookupTime.exchange(0, std::memory_order_relaxed) / 1000;
+
+        {
+            Lock lock(schedulerMutex);
+            auto batchingJson = json["batching"].to<JsonObject>();
+            batchingJson["enabled"] = scheduler.isBatching();
+            scheduler.populateTelemetry(batchingJson);
+        }
+
+        auto commands = commandCount.exchange(0, std::memory_order_relaxed);
+        auto latencyJson = json["command-latency"].to<JsonObject>();
+        latencyJson["bound"] = listenPeriod.count();
+        latencyJson["count"] = commands;
+        if (commands > 0) {
+            latencyJson["average"] = commandLatencySum.exchange(0, std::memory_order_relaxed) / commands;
+            latencyJson["max"] = commandLatencyMax.exchange(0, std::memory_order_relaxed);
+        }
+
+        if (compressAbove > 0) {
+            auto compressionJson = json["compression"].to<JsonObject>();
+            compressionJson["threshold"] = compressAbove;
+            compressionJson["messages"] = compressedMessages.exchange(0, std::memory_order_relaxed);
+            compressionJson["in"] = compressedBytesIn.exchange(0, std::memory_order_relaxed);
+            compressionJson["out"] = compressedBytesOut.exchange(0, std::memory_order_relaxed);
+            compressionJson["time"] = compressionTime.exchange(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Record the time between a command being sent and us receiving it.
+     */
+    void recordCommandLatency(milliseconds latency) {
+        auto latencyMs = static_cast<int64_t>(latency.count());
+        commandCount.fetch_add(1, std::memory_order_relaxed);
+        commandLatencySum.fetch_add(latencyMs, std::memory_order_relaxed);
+        auto max = commandLatencyMax.load(std::memory_order_relaxed);
+        while (latencyMs > max && !commandLatencyMax.compare_exchange_weak(max, latencyMs, std::memory_order_relaxed)) {
+        }
     }
 
     void configMqttClient(esp_mqtt_client_config_t& config) {
@@ -118,11 +205,13 @@ public:
             port = configPort;
         }
 
+        brokerAddress = resolveBrokerAddress();
+
         config = {
             .broker {
                 .address {
                     .uri = nullptr,
-                    .hostname = hostname.c_str(),
+                    .hostname = brokerAddress.c_str(),
                     .transport = MQTT_TRANSPORT_OVER_TCP,
                     .path = nullptr,
                     .port = port,
@@ -148,27 +237,31 @@ public:
                 .reconnect_timeout_ms = duration_cast<milliseconds>(MQTT_CONNECTION_TIMEOUT).count(),
                 .timeout_ms = duration_cast<milliseconds>(MQTT_NETWORK_TIMEOUT).count(),
                 .refresh_connection_after_ms = 0,    // No need to refresh connection
-                .disable_auto_reconnect = false,
+                // Reconnects are paced by the connectivity coordinator
+                .disable_auto_reconnect = true,
                 .tcp_keep_alive_cfg = {},
                 .transport = nullptr,    // Use default transport
                 .if_name = nullptr,      // Use default interface
             },
             .task {},
             .buffer {
-                .size = 8192,
-                .out_size = 4096,
+                .size = MQTT_BUFFER_SIZE,
+                .out_size = MQTT_OUT_BUFFER_SIZE,
             },
             .outbox {},
         };
 
-        LOGTD(MQTT, "server: %s:%" PRIu32 ", client ID is '%s'",
-            config.broker.address.hostname,
+        LOGTD(MQTT, "server: %s:%" PRIu32 " (%s), client ID is '%s'",
+            hostname.c_str(),
             config.broker.address.port,
+            config.broker.address.hostname,
             config.credentials.client_id);
 
         if (!configServerCert.empty()) {
             config.broker.address.transport = MQTT_TRANSPORT_OVER_SSL;
             config.broker.verification.certificate = configServerCert.c_str();
+            // We connect to the address, but the certificate is still issued to the host name
+            config.broker.verification.common_name = hostname.c_str();
             LOGTV(MQTT, "Server cert:\n%s",
                 config.broker.verification.certificate);
 
@@ -182,6 +275,48 @@ public:
     }
 
 private:
+    /**
+     * @brief Look up the broker's address, or reuse the one we found earlier.
+     *
+     * Falls back to the host name, letting the client do the lookup, if we cannot resolve it.
+     */
+    std::string resolveBrokerAddress() {
+        in_addr address {};
+        if (addressCacheTtl == seconds::zero() || inet_aton(hostname.c_str(), &address) != 0) {
+            return hostname;
+        }
+
+        auto now = duration_cast<seconds>(system_clock::now().time_since_epoch());
+        auto cached = addressCache.lookup(hostname, port, now);
+        if (cached.has_value()) {
+            address.s_addr = *cached;
+            cachedAddressCount.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            addrinfo hints {};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* result = nullptr;
+            auto start = esp_timer_get_time();
+            int err = getaddrinfo(hostname.c_str(), nullptr, &hints, &result);
+            lookupTime.fetch_add(esp_timer_get_time() - start, std::memory_order_relaxed);
+            lookupCount.fetch_add(1, std::memory_order_relaxed);
+            if (err != 0 || result == nullptr) {
+                LOGTW(MQTT, "Failed to resolve '%s' (error %d), leaving it to the client",
+                    hostname.c_str(), err);
+                return hostname;
+            }
+            address = reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr;
+            freeaddrinfo(result);
+            addressCache.store(hostname, port, address.s_addr, now, addressCacheTtl);
+        }
+
+        char buffer[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &address, buffer, sizeof(buffer));
+        LOGTV(MQTT, "Using %s address %s for '%s'",
+            cached.has_value() ? "cached" : "resolved", buffer, hostname.c_str());
+        return buffer;
+    }
+
     static constexpr milliseconds MQTT_NETWORK_TIMEOUT = 15s;
     static constexpr milliseconds MQTT_MESSAGE_RETRANSMIT_TIMEOUT = 5s;
     static constexpr milliseconds MQTT_CONNECTION_TIMEOUT = MQTT_NETWORK_TIMEOUT;
@@ -189,18 +324,42 @@ private:
     static constexpr milliseconds MQTT_LOOP_INTERVAL = 1s;
     static constexpr milliseconds MQTT_QUEUE_TIMEOUT = 1s;
 
+    /**
+     * @brief Size of the incoming buffer; also the largest payload we accept after decompression.
+     */
+    static constexpr size_t MQTT_BUFFER_SIZE = 8192;
+    static constexpr size_t MQTT_OUT_BUFFER_SIZE = 4096;
+
+    /**
+     * @brief Send batched messages early if this many have accumulated.
+     */
+    static constexpr size_t MQTT_MAX_BATCH_SIZE = 16;
+
+    /**
+     * @brief Typical current draw while the radio is transmitting, in mA.
+     */
+    static constexpr double MQTT_TRANSMIT_CURRENT = 180.0;
+
+    /**
+     * @brief Estimated airtime of a message: fixed protocol overhead plus time per payload byte.
+     */
+    static constexpr microseconds MQTT_TRANSMIT_OVERHEAD = 5ms;
+    static constexpr microseconds MQTT_TRANSMIT_TIME_PER_BYTE = 10us;
+
     struct PendingSubscription {
         const int messageId;
         const steady_clock::time_point subscribedAt;
     };
 
     struct OutgoingMessage {
-        const std::string topic;
-        const std::string payload;
+        // Not const, so the payload can be moved along instead of copied
+        std::string topic;
+        std::string payload;
         const Retention retain;
         const QoS qos;
         TaskHandle_t waitingTask;
         const LogPublish log;
+        const Delivery delivery;
     };
 
     struct IncomingMessage {
@@ -229,7 +388,12 @@ private:
 
     struct Disconnected { };
 
-    PublishStatus publish(const std::string& topic, const JsonDocument& json, Retention retain, QoS qos, ticks timeout = MQTT_NETWORK_TIMEOUT, LogPublish log = LogPublish::Log) {
+    /**
+     * @brief We received data, so the radio is awake right now.
+     */
+    struct RadioAwake { };
+
+    PublishStatus publish(const std::string& topic, const JsonDocument& json, Retention retain, QoS qos, ticks timeout = MQTT_NETWORK_TIMEOUT, LogPublish log = LogPublish::Log, Delivery delivery = Delivery::Batched) {
         std::string payload;
         serializeJson(json, payload);
         if (log == LogPublish::Log) {
@@ -248,7 +412,7 @@ private:
                 duration_cast<milliseconds>(timeout).count());
 #endif
         }
-        return publishAndWait(topic, payload, retain, qos, timeout);
+        return publishAndWait(topic, std::move(payload), retain, qos, timeout, delivery);
     }
 
     PublishStatus clear(const std::string& topic, Retention retain, QoS qos, ticks timeout = MQTT_NETWORK_TIMEOUT) {
@@ -256,21 +420,22 @@ private:
             topic.c_str(),
             static_cast<int>(qos),
             duration_cast<milliseconds>(timeout).count());
-        return publishAndWait(topic, "", retain, qos, timeout);
+        return publishAndWait(topic, "", retain, qos, timeout, Delivery::Batched);
     }
 
-    PublishStatus publishAndWait(const std::string& topic, const std::string& payload, Retention retain, QoS qos, ticks timeout) {
+    PublishStatus publishAndWait(std::string topic, std::string payload, Retention retain, QoS qos, ticks timeout, Delivery delivery) {
         TaskHandle_t waitingTask = timeout == ticks::zero() ? nullptr : xTaskGetCurrentTaskHandle();
 
         bool offered = eventQueue.offerIn(
             MQTT_QUEUE_TIMEOUT,
             OutgoingMessage {
-                .topic = topic,
-                .payload = payload,
+                .topic = std::move(topic),
+                .payload = std::move(payload),
                 .retain = retain,
                 .qos = qos,
                 .waitingTask = waitingTask,
                 .log = LogPublish::Log,
+                .delivery = delivery,
             });
 
         if (!offered) {
@@ -332,6 +497,10 @@ private:
         // List of messages we are waiting on
         std::list<PendingSubscription> pendingSubscriptions;
 
+        // Messages held back until the next radio wake window
+        std::list<OutgoingMessage> batch;
+        auto flushAt = steady_clock::time_point::max();
+
         while (true) {
             auto now = steady_clock::now();
 
@@ -348,15 +517,26 @@ private:
             });
 
             switch (state) {
-                case MqttState::Disconnected:
+                case MqttState::Disconnected: {
+                    // Wait for the network, and back off after failed attempts
+                    auto backoff = connectivity->untilNextAttempt(Connection::Mqtt, now);
+                    if (!backoff.has_value() || *backoff > 0ms) {
+                        break;
+                    }
+                    connectivity->attemptStarted(Connection::Mqtt, now);
                     connect(nextSessionShouldBeClean);
                     state = MqttState::Connecting;
                     connectionStarted = now;
                     disconnectCount++;
                     break;
+                }
                 case MqttState::Connecting:
                     if (now - connectionStarted > MQTT_CONNECTION_TIMEOUT) {
                         LOGTE(MQTT, "Connecting to MQTT server timed out");
+                        connectivity->attemptFinished(Connection::Mqtt, false, now);
+                        // The broker might have moved
+                        addressCache.invalidate();
+                        connectBurst.reset();
                         ready.clear();
                         disconnect();
                         state = MqttState::Disconnected;
@@ -367,7 +547,17 @@ private:
                     break;
             }
 
-            eventQueue.drainIn(duration_cast<ticks>(MQTT_LOOP_INTERVAL), [&](const auto& event) {
+            if (!batch.empty() && now >= flushAt) {
+                Lock lock(schedulerMutex);
+                flushBatch(batch);
+            }
+
+            auto loopTimeout = MQTT_LOOP_INTERVAL;
+            if (!batch.empty()) {
+                loopTimeout = std::min(loopTimeout, duration_cast<milliseconds>(flushAt - now));
+            }
+
+            eventQueue.drainIn(clampTicks(loopTimeout), [&](auto& event) {
                 std::visit(
                     [&](auto&& arg) {
                         using T = std::decay_t<decltype(arg)>;
@@ -375,6 +565,9 @@ private:
                             LOGTV(MQTT, "Processing connected event, session present: %d",
                                 arg.sessionPresent);
                             state = MqttState::Connected;
+                            energy->end();
+                            connectivity->attemptFinished(Connection::Mqtt, true);
+                            connectBurst.reset();
 
                             // TODO Should make it work with persistent sessions, but apparently it doesn't
                             // // Next connection can start with a persistent session
@@ -387,7 +580,16 @@ private:
                             }
                         } else if constexpr (std::is_same_v<T, Disconnected>) {
                             LOGTV(MQTT, "Processing disconnected event");
+                            if (state == MqttState::Connecting) {
+                                // We could not connect, maybe the broker has moved
+                                addressCache.invalidate();
+                                connectivity->attemptFinished(Connection::Mqtt, false);
+                            } else if (state == MqttState::Connected) {
+                                connectivity->connectionLost(Connection::Mqtt);
+                            }
                             state = MqttState::Disconnected;
+                            energy->end();
+                            connectBurst.reset();
                             stopClient();
 
                             // Clear pending messages and notify waiting tasks
@@ -406,7 +608,24 @@ private:
                         } else if constexpr (std::is_same_v<T, OutgoingMessage>) {
                             LOGTV(MQTT, "Processing outgoing message to %s",
                                 arg.topic.c_str());
-                            processOutgoingMessage(arg);
+                            Lock lock(schedulerMutex);
+                            if (batch.empty()) {
+                                flushAt = scheduler.nextWindow(steady_clock::now());
+                            }
+                            auto delivery = arg.delivery;
+                            batch.push_back(std::move(arg));
+                            // Anything waiting goes out together with an immediate message
+                            if (delivery == Delivery::Immediate
+                                || !scheduler.isBatching()
+                                || batch.size() >= MQTT_MAX_BATCH_SIZE
+                                || steady_clock::now() >= flushAt) {
+                                flushBatch(batch);
+                            }
+                        } else if constexpr (std::is_same_v<T, RadioAwake>) {
+                            Lock lock(schedulerMutex);
+                            scheduler.recordRadioAwake(steady_clock::now());
+                            // The radio is on anyway, send what we have
+                            flushBatch(batch);
                         } else if constexpr (std::is_same_v<T, Subscription>) {
                             LOGTV(MQTT, "Processing subscription");
                             subscriptions.push_back(arg);
@@ -436,25 +655,41 @@ private:
         esp_mqtt_set_config(client, &mqttConfig);
         LOGTI(MQTT, "Connecting to %s:%" PRIu32 ", clean session: %d",
             mqttConfig.broker.address.hostname, mqttConfig.broker.address.port, startCleanSession);
+        // Get through the TLS handshake quickly
+        connectBurst.emplace(connectLock);
         ESP_ERROR_CHECK(esp_mqtt_client_start(client));
         clientRunning = true;
+        // Account for the handshake until we get connected or give up
+        energy->begin();
     }
 
     void disconnect() {
         ready.clear();
+        energy->end();
         LOGTD(MQTT, "Disconnecting from MQTT server");
-        ESP_ERROR_CHECK(esp_mqtt_client_disconnect(client));
+        if (clientRunning) {
+            esp_err_t err = esp_mqtt_client_disconnect(client);
+            if (err != ESP_OK) {
+                LOGTD(MQTT, "Failed to disconnect: %s, stopping anyway", esp_err_to_name(err));
+            }
+        }
         stopClient();
     }
 
     void stopClient() {
-        if (clientRunning) {
-            ESP_ERROR_CHECK(esp_mqtt_client_stop(client));
-            clientRunning = false;
+        if (clientRunning.exchange(false)) {
+            esp_err_t err = esp_mqtt_client_stop(client);
+            // The client stops on its own after a disconnect, as auto-reconnect is off
+            if (err == ESP_FAIL) {
+                LOGTV(MQTT, "Client already stopped");
+            } else {
+                ESP_ERROR_CHECK(err);
+            }
         }
     }
 
-    bool clientRunning = false;
+    // Cleared by the event handler, too, as the client stops itself when disconnected
+    std::atomic<bool> clientRunning = false;
 
     static void handleMqttEventCallback(void* userData, esp_event_base_t /*eventBase*/, int32_t eventId, void* eventData) {
         auto* event = static_cast<esp_mqtt_event_handle_t>(eventData);
@@ -468,10 +703,18 @@ private:
         switch (eventId) {
             case MQTT_EVENT_BEFORE_CONNECT: {
                 LOGTD(MQTT, "Connecting to MQTT server %s:%" PRIu32, hostname.c_str(), port);
+                connectStartedAt = esp_timer_get_time();
                 break;
             }
             case MQTT_EVENT_CONNECTED: {
-                LOGTD(MQTT, "Connected to MQTT server");
+                auto connectTime = esp_timer_get_time() - connectStartedAt;
+                LOGTD(MQTT, "Connected to MQTT server in %lld ms",
+                    connectTime / 1000);
+                connectCount.fetch_add(1, std::memory_order_relaxed);
+                connectTimeSum.fetch_add(connectTime, std::memory_order_relaxed);
+                auto max = connectTimeMax.load(std::memory_order_relaxed);
+                while (connectTime > max && !connectTimeMax.compare_exchange_weak(max, connectTime, std::memory_order_relaxed)) {
+                }
                 ready.set();
                 eventQueue.offerIn(MQTT_QUEUE_TIMEOUT, Connected { static_cast<bool>(event->session_present) });
                 break;
@@ -479,6 +722,7 @@ private:
             case MQTT_EVENT_DISCONNECTED: {
                 LOGTD(MQTT, "Disconnected from MQTT server");
                 ready.clear();
+                clientRunning = false;
                 eventQueue.offerIn(MQTT_QUEUE_TIMEOUT, Disconnected {});
                 break;
             }
@@ -507,6 +751,10 @@ private:
                 LOGTV(MQTT, "Received message on topic '%s'",
                     topic.c_str());
                 incomingQueue.offerIn(MQTT_QUEUE_TIMEOUT, IncomingMessage { .topic = topic, .payload = payload });
+                if (scheduler.isBatching()) {
+                    // Dropping this is fine, the batch goes out at its normal time then
+                    eventQueue.offer(RadioAwake {});
+                }
                 break;
             }
             case MQTT_EVENT_ERROR: {
@@ -545,12 +793,54 @@ private:
         }
     }
 
-    void processOutgoingMessage(const OutgoingMessage& message) {
+    /**
+     * @brief Send all batched messages in a single burst.
+     *
+     * Must be called with schedulerMutex held.
+     */
+    void flushBatch(std::list<OutgoingMessage>& batch) {
+        if (batch.empty()) {
+            return;
+        }
+        size_t bytes = 0;
+        for (const auto& message : batch) {
+            bytes += processOutgoingMessage(message);
+        }
+        scheduler.recordTransmit(batch.size(), bytes);
+        batch.clear();
+    }
+
+    /**
+     * @brief Compress the payload if it's large enough, and it actually gets smaller.
+     *
+     * Must be called with schedulerMutex held, as the compressor and its output are shared.
+     */
+    std::string_view encodePayload(const std::string& payload) {
+        if (compressAbove == 0 || payload.length() < compressAbove) {
+            return payload;
+        }
+        auto start = esp_timer_get_time();
+        bool success = compressor.compress(payload, compressedPayload);
+        compressionTime.fetch_add(esp_timer_get_time() - start, std::memory_order_relaxed);
+        if (!success || compressedPayload.length() >= payload.length()) {
+            return payload;
+        }
+        compressedMessages.fetch_add(1, std::memory_order_relaxed);
+        compressedBytesIn.fetch_add(payload.length(), std::memory_order_relaxed);
+        compressedBytesOut.fetch_add(compressedPayload.length(), std::memory_order_relaxed);
+        return compressedPayload;
+    }
+
+    /**
+     * @return the number of bytes sent.
+     */
+    size_t processOutgoingMessage(const OutgoingMessage& message) {
+        auto payload = encodePayload(message.payload);
         int ret = esp_mqtt_client_enqueue(
             client,
             message.topic.c_str(),
-            message.payload.c_str(),
-            static_cast<int>(message.payload.length()),
+            payload.data(),
+            static_cast<int>(payload.length()),
             static_cast<int>(message.qos),
             static_cast<int>(message.retain == Retention::Retain),
             true);
@@ -559,16 +849,19 @@ private:
             LOGTD(MQTT, "Error publishing to '%s': %s",
                 message.topic.c_str(), ret == -2 ? "outbox full" : "failure");
             PendingMessages::notifyWaitingTask(message.waitingTask, false);
-        } else {
-            auto messageId = ret;
+            return 0;
+        }
+        auto messageId = ret;
+        size_t bytes = message.topic.length() + payload.length();
+        energy->recordActive(MQTT_TRANSMIT_OVERHEAD + MQTT_TRANSMIT_TIME_PER_BYTE * static_cast<int64_t>(bytes));
 #ifdef DUMP_MQTT
-            if (message.log == LogPublish::Log) {
-                LOGTV(MQTT, "Published to '%s' (size: %d), message ID: %d",
-                    message.topic.c_str(), message.payload.length(), messageId);
-            }
-#endif
-            pendingMessages.waitOn(messageId, message.waitingTask);
+        if (message.log == LogPublish::Log) {
+            LOGTV(MQTT, "Published to '%s' (size: %d), message ID: %d",
+                message.topic.c_str(), payload.length(), messageId);
         }
+#endif
+        pendingMessages.waitOn(messageId, message.waitingTask);
+        return bytes;
     }
 
     void processSubscriptions(const std::list<Subscription>& subscriptions, std::list<PendingSubscription>& pendingSubscriptions) {
@@ -606,7 +899,15 @@ private:
 
     void processIncomingMessage(const IncomingMessage& message) {
         const std::string& topic = message.topic;
-        const std::string& payload = message.payload;
+        std::string decompressed;
+        bool compressed = LzssCompressor::isCompressed(message.payload);
+        // The size in the header comes from the sender, don't let it make us allocate more than we would receive
+        if (compressed && !LzssCompressor::decompress(message.payload, decompressed, MQTT_BUFFER_SIZE)) {
+            LOGTW(MQTT, "Failed to decompress payload for topic '%s'",
+                topic.c_str());
+            return;
+        }
+        const std::string& payload = compressed ? decompressed : message.payload;
 
         if (payload.empty()) {
             LOGTV(MQTT, "Ignoring empty payload");
@@ -641,55 +942,8 @@ private:
         return "ugly-duckling-" + instanceName;
     }
 
-    static bool topicMatches(const char* pattern, const char* topic) {
-        const char* pat_ptr = pattern;
-        const char* top_ptr = topic;
-
-        while ((*pat_ptr != 0) && (*top_ptr != 0)) {
-            // Extract pattern level
-            const char* pat_end = strchr(pat_ptr, '/');
-            size_t pat_len = (pat_end != nullptr) ? static_cast<size_t>(pat_end - pat_ptr) : strlen(pat_ptr);
-
-            // Extract topic level
-            const char* top_end = strchr(top_ptr, '/');
-            size_t top_len = (top_end != nullptr) ? static_cast<size_t>(top_end - top_ptr) : strlen(top_ptr);
-
-            // Handle wildcard +
-            if (strncmp(pat_ptr, "+", pat_len) == 0) {
-                // Match any single level, so just advance
-            } else if (strncmp(pat_ptr, "#", pat_len) == 0) {
-                // # must be at the end of the pattern
-                return *(pat_ptr + pat_len) == '\0';
-            } else {
-                // Compare level literally
-                if (pat_len != top_len || strncmp(pat_ptr, top_ptr, pat_len) != 0) {
-                    return false;
-                }
-            }
-
-            // Move to next level
-            if (pat_end != nullptr) {
-                pat_ptr = pat_end + 1;
-            } else {
-                pat_ptr += pat_len;
-            }
-
-            if (top_end != nullptr) {
-                top_ptr = top_end + 1;
-            } else {
-                top_ptr += top_len;
-            }
-        }
-
-        // Handle cases like pattern: "foo/#", topic: "foo"
-        if (*pat_ptr == '#' && *(pat_ptr + 1) == '\0') {
-            return true;
-        }
-
-        return *pat_ptr == '\0' && *top_ptr == '\0';
-    }
-
     State& networkReady;
+    const std::shared_ptr<ConnectivityCoordinator> connectivity;
 
     const std::string configHostname;
     const unsigned int configPort;
@@ -698,13 +952,52 @@ private:
     const std::string configClientKey;
     const std::string clientId;
 
+    const seconds addressCacheTtl;
+    BrokerAddressCache addressCache;
+    std::string brokerAddress;
+    std::atomic<uint32_t> cachedAddressCount { 0 };
+    std::atomic<uint32_t> lookupCount { 0 };
+    std::atomic<int64_t> lookupTime { 0 };
+
+    /**
+     * @brief Time from the client starting to connect until the broker accepted us,
+     * including the TCP and TLS handshakes.
+     */
+    int64_t connectStartedAt = 0;
+    std::atomic<uint32_t> connectCount { 0 };
+    std::atomic<int64_t> connectTimeSum { 0 };
+    std::atomic<int64_t> connectTimeMax { 0 };
+    PerformanceLock connectLock { "mqtt-connect" };
+    std::optional<PowerManagementLockGuard> connectBurst;
+
     StateSource& ready;
 
+    const std::shared_ptr<EnergyConsumer> energy;
+
+    const milliseconds listenPeriod;
+    Mutex schedulerMutex;
+    TransmitScheduler scheduler;
+
+    /**
+     * @brief Payloads at least this large are compressed, 0 to disable.
+     */
+    const size_t compressAbove;
+    LzssCompressor compressor;
+    std::string compressedPayload;
+    std::atomic<uint32_t> compressedMessages { 0 };
+    std::atomic<uint32_t> compressedBytesIn { 0 };
+    std::atomic<uint32_t> compressedBytesOut { 0 };
+    std::atomic<int64_t> compressionTime { 0 };
+
+    std::atomic<int> commandCount { 0 };
+    std::atomic<int64_t> commandLatencySum { 0 };
+    std::atomic<int64_t> commandLatencyMax { 0 };
+
     std::string hostname;
     uint32_t port {};
     esp_mqtt_client_handle_t client;
 
-    Queue<std::variant<Connected, Disconnected, MessagePublished, Subscribed, OutgoingMessage, Subscription>> eventQueue;
+    Queue<std::variant<Connected, Disconnected, MessagePublished, Subscribed, OutgoingMessage, Subscription, RadioAwake>> eventQueue;
     Queue<IncomingMessage> incomingQueue;
     // TODO Use a map instead
     std::list<Subscription> subscriptions;
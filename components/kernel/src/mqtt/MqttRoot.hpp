@@ -4,11 +4,15 @@
 #include <memory>
 #include <unordered_map>
 
+#include <MemoryClass.hpp>
 #include <mqtt/MqttDriver.hpp>
+#include <mqtt/ResponseStream.hpp>
 #include <utility>
 
 namespace farmhub::kernel::mqtt {
 
+using StreamingCommandHandler = std::function<void(const JsonObject&, ResponseStream&)>;
+
 class MqttRoot {
 public:
     MqttRoot(const std::shared_ptr<MqttDriver>& mqtt, const std::string& rootTopic)
@@ -20,11 +24,13 @@ public:
             std::string command = topic.substr(commandsPrefixLength);
             auto it = commandHandlers.find(command);
             if (it != commandHandlers.end()) {
-                JsonDocument responseDoc;
+                recordCommandLatency(request);
+                JsonDocument responseDoc(bulkJsonAllocator());
                 auto response = responseDoc.to<JsonObject>();
                 it->second(request, response);
                 if (response.size() > 0) {
-                    publish("responses/" + command, responseDoc, Retention::NoRetain, QoS::ExactlyOnce);
+                    // Someone is waiting for the response, do not hold it back for batching
+                    this->mqtt->publish(fullTopic("responses/" + command), responseDoc, Retention::NoRetain, QoS::ExactlyOnce, MqttDriver::MQTT_NETWORK_TIMEOUT, LogPublish::Log, Delivery::Immediate);
                 }
             } else {
                 LOGTE(MQTT, "Unknown command: %s", command.c_str());
@@ -41,12 +47,19 @@ public:
     }
 
     PublishStatus publish(const std::string& suffix, const std::function<void(JsonObject&)>& populate, Retention retain = Retention::NoRetain, QoS qos = QoS::AtMostOnce, ticks timeout = MqttDriver::MQTT_NETWORK_TIMEOUT, LogPublish log = LogPublish::Log) {
-        JsonDocument doc;
+        JsonDocument doc(bulkJsonAllocator());
         JsonObject root = doc.to<JsonObject>();
         populate(root);
         return publish(suffix, doc, retain, qos, timeout, log);
     }
 
+    /**
+     * @brief Publish an already serialized payload.
+     */
+    PublishStatus publish(const std::string& suffix, std::string payload, Retention retain = Retention::NoRetain, QoS qos = QoS::AtMostOnce, ticks timeout = MqttDriver::MQTT_NETWORK_TIMEOUT) {
+        return mqtt->publishAndWait(fullTopic(suffix), std::move(payload), retain, qos, timeout, Delivery::Batched);
+    }
+
     PublishStatus clear(const std::string& suffix, Retention retain = Retention::NoRetain, QoS qos = QoS::AtMostOnce, ticks timeout = MqttDriver::MQTT_NETWORK_TIMEOUT) {
         return mqtt->clear(fullTopic(suffix), retain, qos, timeout);
     }
@@ -59,6 +72,36 @@ public:
         commandHandlers.emplace(name, handler);
     }
 
+    /**
+     * @brief Register a command whose response can be too large to send at once.
+     *
+     * The handler adds entries to the stream, which publishes them in chunks of at most
+     * `maxChunkSize` bytes of JSON, waiting for each chunk to be delivered before building the next.
+     */
+    void registerStreamingCommand(const std::string& name, const StreamingCommandHandler& handler, size_t maxChunkSize = DEFAULT_MAX_CHUNK_SIZE) {
+        registerCommand(name, [this, name, handler, maxChunkSize](const JsonObject& request, JsonObject& /*response*/) {
+            ResponseStream stream(request, maxChunkSize, [this, &name](const JsonDocument& chunk) {
+                auto status = mqtt->publish(fullTopic("responses/" + name), chunk, Retention::NoRetain, QoS::ExactlyOnce, MqttDriver::MQTT_NETWORK_TIMEOUT, LogPublish::Log, Delivery::Immediate);
+                if (status != PublishStatus::Success) {
+                    LOGTW(MQTT, "Could not send response chunk for '%s', stopping",
+                        name.c_str());
+                    return false;
+                }
+                return true;
+            });
+            handler(request, stream);
+            if (stream.finish()) {
+                LOGTD(MQTT, "Sent response to '%s' in %" PRIu32 " chunks",
+                    name.c_str(), stream.getChunksSent());
+            }
+        });
+    }
+
+    /**
+     * @brief Keeps each chunk well within the MQTT client's 4 kB outgoing buffer.
+     */
+    static constexpr size_t DEFAULT_MAX_CHUNK_SIZE = 1024;
+
     /**
      * @brief Subscribes to the given topic under the topic prefix.
      *
@@ -71,6 +114,24 @@ public:
     const std::shared_ptr<MqttDriver> mqtt;
 
 private:
+    /**
+     * @brief Commands that carry the time they were sent at let us measure how long they took to arrive.
+     */
+    void recordCommandLatency(const JsonObject& request) {
+        if (!request["timestamp"].is<int64_t>()) {
+            return;
+        }
+        auto sentAt = system_clock::time_point(milliseconds(request["timestamp"].as<int64_t>()));
+        auto latency = duration_cast<milliseconds>(system_clock::now() - sentAt);
+        // Ignore bogus values, e.g. when our clock is not yet in sync
+        if (latency < 0ms || latency > MAX_COMMAND_LATENCY) {
+            return;
+        }
+        mqtt->recordCommandLatency(latency);
+    }
+
+    static constexpr milliseconds MAX_COMMAND_LATENCY = 10min;
+
     std::string fullTopic(const std::string& suffix) const {
         return rootTopic + "/" + suffix;
     }
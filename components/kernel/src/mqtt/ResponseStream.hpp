@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include <ArduinoJson.h>
+
+namespace farmhub::kernel::mqtt {
+
+/**
+ * @brief Sends a long list of entries as a sequence of bounded chunks instead of a single response.
+ *
+ * Each chunk carries its sequence number, and all but the last one carry a continuation token:
+ * the index of the first entry of the next chunk. Sending the request again with the token
+ * resumes the listing from there, e.g. after a chunk was lost.
+ *
+ * Only one chunk is held in memory at a time, and the next one is only built after the previous
+ * one has been handed over, so a slow link pushes back on the producer instead of filling the outbox.
+ */
+class ResponseStream {
+public:
+    /**
+     * @brief Hands over a chunk, returning false if it could not be sent and the stream should stop.
+     */
+    using Sender = std::function<bool(const JsonDocument&)>;
+
+    ResponseStream(const JsonObject& request, size_t maxChunkSize, Sender send)
+        : maxChunkSize(maxChunkSize)
+        , send(std::move(send))
+        , start(request["continuation"] | 0U)
+        , id(request["id"]) {
+        beginChunk();
+    }
+
+    /**
+     * @brief Add an entry, sending the current chunk first if the entry would not fit in it.
+     *
+     * Entries before the continuation token in the request are counted but skipped.
+     *
+     * @return false if the stream failed, so the caller can stop producing entries.
+     */
+    bool add(const std::function<void(JsonObject&)>& populate) {
+        if (failed) {
+            return false;
+        }
+        uint32_t index = next++;
+        if (index < start) {
+            return true;
+        }
+
+        JsonDocument entryDoc;
+        auto entry = entryDoc.to<JsonObject>();
+        populate(entry);
+        // Account for the separating comma, too
+        size_t entrySize = measureJson(entryDoc) + 1;
+
+        if (entries.size() > 0 && chunkSize + entrySize > maxChunkSize) {
+            chunk["continuation"] = index;
+            if (!sendChunk()) {
+                return false;
+            }
+            beginChunk();
+        }
+        entries.add(entryDoc.as<JsonObjectConst>());
+        chunkSize += entrySize;
+        return true;
+    }
+
+    /**
+     * @brief Send the last chunk, even if it has no entries, so the receiver knows the listing is complete.
+     */
+    bool finish() {
+        if (failed) {
+            return false;
+        }
+        chunk["last"] = true;
+        return sendChunk();
+    }
+
+    uint32_t getChunksSent() const {
+        return seq;
+    }
+
+private:
+    void beginChunk() {
+        chunk.clear();
+        if (!id.isNull()) {
+            chunk["id"] = id;
+        }
+        chunk["seq"] = seq;
+        entries = chunk["entries"].to<JsonArray>();
+        // Leave room for the envelope, including a continuation token
+        chunkSize = measureJson(chunk) + ENVELOPE_RESERVE;
+    }
+
+    bool sendChunk() {
+        if (!send(chunk)) {
+            failed = true;
+            return false;
+        }
+        seq++;
+        return true;
+    }
+
+    /**
+     * @brief Room for the continuation token or the last flag added when the chunk is sent.
+     */
+    static constexpr size_t ENVELOPE_RESERVE = 32;
+
+    const size_t maxChunkSize;
+    const Sender send;
+    const uint32_t start;
+    const JsonVariantConst id;
+
+    JsonDocument chunk;
+    JsonArray entries;
+    size_t chunkSize = 0;
+    uint32_t next = 0;
+    uint32_t seq = 0;
+    bool failed = false;
+};
+
+}    // namespace farmhub::kernel::mqtt
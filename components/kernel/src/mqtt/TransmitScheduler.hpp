@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include <ArduinoJson.h>
+
+using namespace std::chrono;
+
+namespace farmhub::kernel::mqtt {
+
+/**
+ * @brief Aligns outgoing traffic to the moments the radio wakes up to listen for beacons anyway.
+ *
+ * In power save mode the station only wakes every listen period to check for buffered traffic.
+ * Rather than waking the radio for every publish, we hold non-urgent messages until the next
+ * wake window and send them together. We learn the phase of the wake windows from incoming
+ * traffic, which the AP can only deliver while we are listening.
+ *
+ * The scheduler also keeps a model of how long the radio spends switched on, so the tradeoff
+ * between batching and latency can be tuned.
+ */
+class TransmitScheduler {
+public:
+    TransmitScheduler(milliseconds listenPeriod, bool batching, steady_clock::time_point now = steady_clock::now())
+        : listenPeriod(listenPeriod)
+        , batching(batching && listenPeriod > milliseconds::zero())
+        , anchor(now)
+        , lastReported(now) {
+    }
+
+    bool isBatching() const {
+        return batching;
+    }
+
+    /**
+     * @brief The radio was just awake to receive traffic, use it as the phase of the wake windows.
+     */
+    void recordRadioAwake(steady_clock::time_point now) {
+        anchor = now;
+    }
+
+    /**
+     * @brief The earliest wake window at or after the given time.
+     */
+    steady_clock::time_point nextWindow(steady_clock::time_point now) const {
+        if (!batching || now <= anchor) {
+            return now;
+        }
+        auto periods = (now - anchor + listenPeriod - steady_clock::duration(1)) / listenPeriod;
+        return anchor + periods * listenPeriod;
+    }
+
+    /**
+     * @brief Record a burst of messages sent together while the radio was on.
+     */
+    void recordTransmit(size_t messages, size_t bytes) {
+        bursts++;
+        this->messages += messages;
+        this->bytes += bytes;
+    }
+
+    void populateTelemetry(JsonObject& json, steady_clock::time_point now = steady_clock::now()) {
+        auto elapsed = now - lastReported;
+        lastReported = now;
+        if (elapsed <= steady_clock::duration::zero()) {
+            return;
+        }
+
+        // Listening for beacons, plus each burst of transmissions, plus airtime for payloads
+        steady_clock::duration radioOn = RADIO_LISTEN_TIME * (elapsed / std::max<steady_clock::duration>(listenPeriod, MIN_LISTEN_PERIOD))
+            + RADIO_BURST_TIME * static_cast<int64_t>(bursts)
+            + RADIO_TIME_PER_BYTE * static_cast<int64_t>(bytes);
+        json["radio-on"] = std::min(1.0, duration<double>(radioOn).count() / duration<double>(elapsed).count());
+        json["bursts"] = bursts;
+        json["messages"] = messages;
+        bursts = 0;
+        messages = 0;
+        bytes = 0;
+    }
+
+private:
+    /**
+     * @brief Approximate time the radio is on to receive a beacon, including ramp-up.
+     */
+    static constexpr microseconds RADIO_LISTEN_TIME = 3ms;
+
+    /**
+     * @brief Approximate time the radio stays on around a burst of transmissions, waiting for acknowledgements.
+     */
+    static constexpr microseconds RADIO_BURST_TIME = 20ms;
+
+    static constexpr microseconds RADIO_TIME_PER_BYTE = 10us;
+
+    /**
+     * @brief The standard beacon interval of 100 TU.
+     */
+    static constexpr microseconds MIN_LISTEN_PERIOD = 102400us;
+
+    const milliseconds listenPeriod;
+    const bool batching;
+
+    steady_clock::time_point anchor;
+    steady_clock::time_point lastReported;
+    size_t bursts = 0;
+    size_t messages = 0;
+    size_t bytes = 0;
+};
+
+}    // namespace farmhub::kernel::mqtt
@@ -0,0 +1,36 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <Backoff.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("backoff starts with initial delay") {
+    ExponentialBackoff backoff(10s, 15min);
+    REQUIRE(backoff.next() == 10s);
+    REQUIRE(backoff.getAttempts() == 1);
+}
+
+TEST_CASE("backoff doubles the delay on each attempt") {
+    ExponentialBackoff backoff(10s, 15min);
+    backoff.next();
+    REQUIRE(backoff.next() == 20s);
+    REQUIRE(backoff.next() == 40s);
+    REQUIRE(backoff.next() == 80s);
+}
+
+TEST_CASE("backoff is capped at max delay") {
+    ExponentialBackoff backoff(10s, 30s);
+    backoff.next();
+    backoff.next();
+    REQUIRE(backoff.next() == 30s);
+    REQUIRE(backoff.next() == 30s);
+}
+
+TEST_CASE("backoff starts over after reset") {
+    ExponentialBackoff backoff(10s, 15min);
+    backoff.next();
+    backoff.next();
+    backoff.reset();
+    REQUIRE(backoff.getAttempts() == 0);
+    REQUIRE(backoff.next() == 10s);
+}
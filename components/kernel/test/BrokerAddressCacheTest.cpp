@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <mqtt/BrokerAddressCache.hpp>
+
+using namespace farmhub::kernel::mqtt;
+
+static constexpr seconds START { 1'700'000'000 };
+static constexpr uint32_t ADDRESS = 0x0A00A8C0;
+
+TEST_CASE("uninitialized memory is not taken for an address") {
+    BrokerAddressRecord record {
+        .magic = 0xDEADBEEF,
+        .hostHash = 1,
+        .address = 2,
+        .port = 8883,
+        .resolvedAt = 3,
+        .ttl = 4,
+        .check = 5,
+    };
+    BrokerAddressCache cache(record);
+    REQUIRE_FALSE(cache.lookup("broker.example.com", 8883, START).has_value());
+}
+
+TEST_CASE("address is cached for the same host and port until it expires") {
+    BrokerAddressRecord record {};
+    BrokerAddressCache cache(record);
+    cache.store("broker.example.com", 8883, ADDRESS, START, 1h);
+
+    REQUIRE(cache.lookup("broker.example.com", 8883, START) == ADDRESS);
+    REQUIRE(cache.lookup("broker.example.com", 8883, START + 59min) == ADDRESS);
+    REQUIRE_FALSE(cache.lookup("broker.example.com", 8883, START + 1h).has_value());
+    REQUIRE_FALSE(cache.lookup("broker.example.org", 8883, START).has_value());
+    REQUIRE_FALSE(cache.lookup("broker.example.com", 1883, START).has_value());
+}
+
+TEST_CASE("clock moving backwards expires the address") {
+    BrokerAddressRecord record {};
+    BrokerAddressCache cache(record);
+    cache.store("broker.example.com", 8883, ADDRESS, START, 1h);
+    REQUIRE_FALSE(cache.lookup("broker.example.com", 8883, START - 1s).has_value());
+}
+
+TEST_CASE("invalidated or corrupted address is not used") {
+    BrokerAddressRecord record {};
+    BrokerAddressCache cache(record);
+    cache.store("broker.example.com", 8883, ADDRESS, START, 1h);
+    record.address ^= 1;
+    REQUIRE_FALSE(cache.lookup("broker.example.com", 8883, START).has_value());
+
+    cache.store("broker.example.com", 8883, ADDRESS, START, 1h);
+    cache.invalidate();
+    REQUIRE_FALSE(cache.lookup("broker.example.com", 8883, START).has_value());
+}
+
+TEST_CASE("cache survives being reattached to the same record") {
+    BrokerAddressRecord record {};
+    BrokerAddressCache(record).store("broker.example.com", 8883, ADDRESS, START, 1h);
+    BrokerAddressCache cache(record);
+    REQUIRE(cache.lookup("broker.example.com", 8883, START + 10s) == ADDRESS);
+}
@@ -0,0 +1,85 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <ClockDiscipline.hpp>
+
+using namespace farmhub::kernel;
+using Catch::Approx;
+
+static const steady_clock::time_point START = steady_clock::time_point(1h);
+
+TEST_CASE("first sync does not produce a drift estimate") {
+    ClockDiscipline discipline(1h, 24h);
+    discipline.recordSync(5ms, START);
+    REQUIRE_FALSE(discipline.getDriftPpm().has_value());
+    REQUIRE(discipline.getSyncCount() == 1);
+    REQUIRE(discipline.getLastOffset() == 5ms);
+    REQUIRE(discipline.takeCorrection(START + 10min) == 0us);
+}
+
+TEST_CASE("drift is measured from offset between syncs") {
+    ClockDiscipline discipline(1h, 24h);
+    discipline.recordSync(0ms, START);
+    // Local clock lost 36 ms in an hour, i.e. it runs 10 ppm slow
+    discipline.recordSync(36ms, START + 1h);
+    REQUIRE(discipline.getDriftPpm().value() == Approx(10.0));
+}
+
+TEST_CASE("drift is corrected between syncs") {
+    ClockDiscipline discipline(1h, 24h);
+    discipline.recordSync(0ms, START);
+    discipline.recordSync(36ms, START + 1h);
+    REQUIRE(discipline.takeCorrection(START + 70min) == 6ms);
+    REQUIRE(discipline.takeCorrection(START + 80min) == 6ms);
+}
+
+TEST_CASE("applied corrections are accounted for when measuring drift") {
+    ClockDiscipline discipline(1h, 24h);
+    discipline.recordSync(0ms, START);
+    discipline.recordSync(36ms, START + 1h);
+    for (int i = 1; i <= 6; i++) {
+        discipline.takeCorrection(START + 1h + i * 10min);
+    }
+    // We corrected for everything, the sync finds the clock spot on
+    discipline.recordSync(0ms, START + 2h);
+    REQUIRE(discipline.getDriftPpm().value() == Approx(10.0));
+}
+
+TEST_CASE("resync interval grows while estimate is stable") {
+    ClockDiscipline discipline(1h, 4h);
+    discipline.recordSync(0ms, START);
+    discipline.recordSync(36ms, START + 1h);
+    REQUIRE(discipline.getResyncInterval() == 1h);
+
+    auto now = START + 1h;
+    for (auto expected : { 2h, 4h, 4h }) {
+        auto interval = discipline.getResyncInterval();
+        discipline.takeCorrection(now + interval);
+        now += interval;
+        discipline.recordSync(0ms, now);
+        REQUIRE(discipline.getResyncInterval() == expected);
+    }
+}
+
+TEST_CASE("resync interval is reset when drift changes") {
+    ClockDiscipline discipline(1h, 24h);
+    discipline.recordSync(0ms, START);
+    discipline.recordSync(36ms, START + 1h);
+    discipline.takeCorrection(START + 2h);
+    discipline.recordSync(0ms, START + 2h);
+    REQUIRE(discipline.getResyncInterval() == 2h);
+
+    // Temperature changed, now we are 30 ppm slow
+    discipline.takeCorrection(START + 4h);
+    discipline.recordSync(144ms, START + 4h);
+    REQUIRE(discipline.getResyncInterval() == 1h);
+    REQUIRE(discipline.getDriftPpm().value() == Approx(20.0));
+}
+
+TEST_CASE("clock steps are not treated as drift") {
+    ClockDiscipline discipline(1h, 24h);
+    discipline.recordSync(0ms, START);
+    discipline.recordSync(1h, START + 1h);
+    REQUIRE_FALSE(discipline.getDriftPpm().has_value());
+    REQUIRE(discipline.getSyncCount() == 2);
+}
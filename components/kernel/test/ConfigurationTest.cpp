@@ -165,3 +165,15 @@ TEST_CASE("throws on invalid JSON") {
         ConfigurationException,
         Catch::Matchers::Message("ConfigurationException: Cannot parse JSON configuration: InvalidInput: NOT JSON"));
 }
+
+TEST_CASE("configuration hash only changes with the content") {
+    JsonDocument original;
+    deserializeJson(original, R"({"intValue": 100, "stringValue": "custom"})");
+    JsonDocument same;
+    deserializeJson(same, R"({ "intValue" : 100, "stringValue" : "custom" })");
+    JsonDocument changed;
+    deserializeJson(changed, R"({"intValue": 101, "stringValue": "custom"})");
+
+    REQUIRE(hashConfigurationJson(original) == hashConfigurationJson(same));
+    REQUIRE(hashConfigurationJson(original) != hashConfigurationJson(changed));
+}
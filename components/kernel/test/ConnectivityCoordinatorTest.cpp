@@ -0,0 +1,161 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+
+#include <ConnectivityCoordinator.hpp>
+
+using namespace farmhub::kernel;
+using Catch::Approx;
+
+static const steady_clock::time_point START = steady_clock::time_point(1h);
+
+// No jitter, delays are exactly the backoff
+static uint32_t noJitter() {
+    return 0;
+}
+
+// Full jitter, delays are halved
+static uint32_t maxJitter() {
+    return UINT32_MAX;
+}
+
+static void connect(ConnectivityCoordinator& coordinator, Connection connection, steady_clock::time_point now) {
+    coordinator.attemptStarted(connection, now);
+    coordinator.attemptFinished(connection, true, now);
+}
+
+TEST_CASE("wifi can connect right away at boot") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    REQUIRE(coordinator.untilNextAttempt(Connection::WiFi, START) == 0ms);
+}
+
+TEST_CASE("mqtt and ntp wait for wifi") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    REQUIRE_FALSE(coordinator.untilNextAttempt(Connection::Mqtt, START).has_value());
+    REQUIRE_FALSE(coordinator.untilNextAttempt(Connection::Ntp, START).has_value());
+
+    connect(coordinator, Connection::WiFi, START);
+    REQUIRE(coordinator.untilNextAttempt(Connection::Mqtt, START) == 0ms);
+    REQUIRE(coordinator.untilNextAttempt(Connection::Ntp, START) == 0ms);
+
+    coordinator.connectionLost(Connection::WiFi, START + 1min);
+    REQUIRE_FALSE(coordinator.untilNextAttempt(Connection::Mqtt, START + 1min).has_value());
+}
+
+TEST_CASE("failed attempts back off exponentially") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    auto now = START;
+    for (auto expected : { 2s, 4s, 8s, 16s }) {
+        coordinator.attemptStarted(Connection::WiFi, now);
+        coordinator.attemptFinished(Connection::WiFi, false, now);
+        REQUIRE(coordinator.untilNextAttempt(Connection::WiFi, now) == expected);
+        now += expected;
+        REQUIRE(coordinator.untilNextAttempt(Connection::WiFi, now) == 0ms);
+    }
+}
+
+TEST_CASE("backoff is capped") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    for (int i = 0; i < 20; i++) {
+        coordinator.attemptFinished(Connection::WiFi, false, START);
+    }
+    REQUIRE(coordinator.untilNextAttempt(Connection::WiFi, START) == 5min);
+}
+
+TEST_CASE("jitter shortens the delay by up to half") {
+    ConnectivityCoordinator coordinator(maxJitter, START);
+    coordinator.attemptFinished(Connection::WiFi, false, START);
+    coordinator.attemptFinished(Connection::WiFi, false, START);
+    REQUIRE(coordinator.untilNextAttempt(Connection::WiFi, START) == 2s);
+}
+
+TEST_CASE("getting an IP lets backed off connections retry quickly") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    connect(coordinator, Connection::WiFi, START);
+    for (int i = 0; i < 10; i++) {
+        coordinator.attemptFinished(Connection::Mqtt, false, START);
+    }
+    REQUIRE(coordinator.untilNextAttempt(Connection::Mqtt, START) == 10min);
+
+    coordinator.connectionLost(Connection::WiFi, START + 1min);
+    connect(coordinator, Connection::WiFi, START + 2min);
+    REQUIRE(coordinator.untilNextAttempt(Connection::Mqtt, START + 2min) == 0ms);
+}
+
+TEST_CASE("lost connection retries after the initial delay") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    connect(coordinator, Connection::WiFi, START);
+    connect(coordinator, Connection::Mqtt, START);
+    coordinator.connectionLost(Connection::Mqtt, START + 1h);
+    REQUIRE(coordinator.untilNextAttempt(Connection::Mqtt, START + 1h) == 2s);
+}
+
+TEST_CASE("attempts are reported per hour") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    for (int i = 0; i < 3; i++) {
+        coordinator.attemptStarted(Connection::WiFi, START);
+        coordinator.attemptFinished(Connection::WiFi, false, START);
+    }
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    coordinator.populateTelemetry(json, START + 30min);
+    REQUIRE(json["wifi"]["attempts"].as<int>() == 3);
+    REQUIRE(json["wifi"]["attempts-per-hour"].as<double>() == Approx(6.0));
+    REQUIRE_FALSE(json["wifi"]["up"].as<bool>());
+    REQUIRE(json["mqtt"]["attempts"].as<int>() == 0);
+
+    JsonDocument nextDoc;
+    auto next = nextDoc.to<JsonObject>();
+    coordinator.populateTelemetry(next, START + 1h);
+    REQUIRE(next["wifi"]["attempts"].as<int>() == 0);
+}
+
+TEST_CASE("radio-on time is counted during outages") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    // Attempts before the first outage don't count
+    coordinator.attemptStarted(Connection::WiFi, START);
+    coordinator.attemptFinished(Connection::WiFi, true, START + 5s);
+    connect(coordinator, Connection::Mqtt, START + 10s);
+
+    auto lost = START + 1h;
+    coordinator.connectionLost(Connection::WiFi, lost);
+    coordinator.connectionLost(Connection::Mqtt, lost);
+    coordinator.attemptStarted(Connection::WiFi, lost + 2s);
+    coordinator.attemptFinished(Connection::WiFi, false, lost + 5s);
+    coordinator.attemptStarted(Connection::WiFi, lost + 10s);
+    coordinator.attemptFinished(Connection::WiFi, true, lost + 12s);
+    coordinator.attemptStarted(Connection::Mqtt, lost + 14s);
+    coordinator.attemptFinished(Connection::Mqtt, true, lost + 15s);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    coordinator.populateTelemetry(json, lost + 1min);
+    REQUIRE(json["outage"]["count"].as<int>() == 1);
+    REQUIRE(json["outage"]["time"].as<int64_t>() == 15000);
+    REQUIRE(json["outage"]["radio-on"].as<int64_t>() == 6000);
+}
+
+TEST_CASE("ongoing outage is reported up to now") {
+    ConnectivityCoordinator coordinator(noJitter, START);
+    connect(coordinator, Connection::WiFi, START);
+    connect(coordinator, Connection::Mqtt, START);
+    coordinator.connectionLost(Connection::WiFi, START + 1min);
+    coordinator.attemptStarted(Connection::WiFi, START + 2min);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    coordinator.populateTelemetry(json, START + 3min);
+    REQUIRE(json["outage"]["count"].as<int>() == 1);
+    REQUIRE(json["outage"]["time"].as<int64_t>() == 2 * 60 * 1000);
+    REQUIRE(json["outage"]["radio-on"].as<int64_t>() == 60 * 1000);
+
+    coordinator.attemptFinished(Connection::WiFi, false, START + 4min);
+    JsonDocument nextDoc;
+    auto next = nextDoc.to<JsonObject>();
+    coordinator.populateTelemetry(next, START + 5min);
+    REQUIRE(next["outage"]["count"].as<int>() == 0);
+    REQUIRE(next["outage"]["time"].as<int64_t>() == 2 * 60 * 1000);
+    REQUIRE(next["outage"]["radio-on"].as<int64_t>() == 60 * 1000);
+}
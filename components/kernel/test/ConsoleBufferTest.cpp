@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+
+#include <ConsoleBuffer.hpp>
+
+using namespace farmhub::kernel;
+
+static std::string drain(ConsoleBuffer& buffer) {
+    std::string result;
+    char chunk[8];
+    while (size_t length = buffer.read(chunk, sizeof(chunk), 0ms)) {
+        result.append(chunk, length);
+    }
+    return result;
+}
+
+TEST_CASE("output is read back in order across the end of the ring") {
+    ConsoleBuffer buffer(16, ConsoleOverflow::DropOldest);
+    buffer.write("0123456789\n");
+    REQUIRE(drain(buffer) == "0123456789\n");
+    buffer.write("abcdefghij\n");
+    REQUIRE(drain(buffer) == "abcdefghij\n");
+    REQUIRE(buffer.takeStats().droppedBytes == 0);
+}
+
+TEST_CASE("read times out when there is nothing to read") {
+    ConsoleBuffer buffer(16, ConsoleOverflow::DropOldest);
+    char chunk[8];
+    REQUIRE(buffer.read(chunk, sizeof(chunk), 1ms) == 0);
+}
+
+TEST_CASE("oldest whole lines are dropped to make room") {
+    ConsoleBuffer buffer(16, ConsoleOverflow::DropOldest);
+    buffer.write("first\n");
+    buffer.write("second\n");
+    buffer.write("third\n");
+    REQUIRE(drain(buffer) == "second\nthird\n");
+
+    auto stats = buffer.takeStats();
+    REQUIRE(stats.droppedBytes == 6);
+    REQUIRE(stats.highWater == 13);
+    REQUIRE(stats.blockedTime == microseconds::zero());
+}
+
+TEST_CASE("only the end of output larger than the buffer is kept") {
+    ConsoleBuffer buffer(8, ConsoleOverflow::DropOldest);
+    buffer.write("0123456789\n");
+    REQUIRE(drain(buffer) == "3456789\n");
+    REQUIRE(buffer.takeStats().droppedBytes == 3);
+}
+
+TEST_CASE("blocking writer waits for the reader to make room") {
+    ConsoleBuffer buffer(16, ConsoleOverflow::Block, 10s);
+    buffer.write("0123456789\n");
+
+    std::thread reader([&] {
+        std::this_thread::sleep_for(10ms);
+        char chunk[16];
+        (void) buffer.read(chunk, sizeof(chunk), 1s);
+    });
+    buffer.write("abcdefghij\n");
+    reader.join();
+
+    REQUIRE(drain(buffer) == "abcdefghij\n");
+    auto stats = buffer.takeStats();
+    REQUIRE(stats.droppedBytes == 0);
+    REQUIRE(stats.blockedTime > microseconds::zero());
+}
+
+TEST_CASE("blocking writer drops output when the reader doesn't keep up") {
+    ConsoleBuffer buffer(16, ConsoleOverflow::Block, 1ms);
+    buffer.write("0123456789\n");
+    buffer.write("abcdefghij\n");
+    REQUIRE(drain(buffer) == "abcdefghij\n");
+    auto stats = buffer.takeStats();
+    REQUIRE(stats.droppedBytes == 11);
+    REQUIRE(stats.blockedTime >= 1ms);
+}
@@ -0,0 +1,102 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <EnergyLedger.hpp>
+
+using namespace farmhub::kernel;
+using Catch::Approx;
+
+static const steady_clock::time_point START = steady_clock::time_point(1h);
+
+TEST_CASE("baseline charge is integrated over the interval") {
+    EnergyLedger ledger(2.0, START);
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    ledger.populateTelemetry(json, std::nullopt, START + 30min);
+    REQUIRE(json["interval"].as<int64_t>() == 30 * 60 * 1000);
+    REQUIRE(json["consumers"]["baseline"]["charge"].as<double>() == Approx(1.0));
+    REQUIRE(json["modeled-current"].as<double>() == Approx(2.0));
+}
+
+TEST_CASE("consumer activity is added on top of baseline") {
+    EnergyLedger ledger(1.0, START);
+    auto motor = ledger.registerConsumer("motor", 300.0);
+    motor->begin(START + 10min);
+    motor->end(START + 11min);
+    motor->recordActive(1min);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    ledger.populateTelemetry(json, std::nullopt, START + 1h);
+    REQUIRE(json["consumers"]["motor"]["active"].as<int64_t>() == 2 * 60 * 1000);
+    REQUIRE(json["consumers"]["motor"]["charge"].as<double>() == Approx(10.0));
+    REQUIRE(json["charge"].as<double>() == Approx(11.0));
+}
+
+TEST_CASE("overlapping activity is counted once") {
+    EnergyLedger ledger(0.0, START);
+    auto lock = ledger.registerConsumer("lock", 60.0);
+    lock->begin(START);
+    lock->begin(START + 10min);
+    lock->end(START + 20min);
+    lock->end(START + 30min);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    ledger.populateTelemetry(json, std::nullopt, START + 1h);
+    REQUIRE(json["consumers"]["lock"]["charge"].as<double>() == Approx(30.0));
+}
+
+TEST_CASE("ongoing activity is split between intervals") {
+    EnergyLedger ledger(0.0, START);
+    auto wifi = ledger.registerConsumer("wifi", 60.0);
+    wifi->begin(START + 30min);
+
+    JsonDocument first;
+    auto firstJson = first.to<JsonObject>();
+    ledger.populateTelemetry(firstJson, std::nullopt, START + 1h);
+    REQUIRE(firstJson["consumers"]["wifi"]["charge"].as<double>() == Approx(30.0));
+
+    wifi->end(START + 90min);
+    JsonDocument second;
+    auto secondJson = second.to<JsonObject>();
+    ledger.populateTelemetry(secondJson, std::nullopt, START + 2h);
+    REQUIRE(secondJson["consumers"]["wifi"]["charge"].as<double>() == Approx(30.0));
+}
+
+TEST_CASE("idle consumers are not reported") {
+    EnergyLedger ledger(1.0, START);
+    ledger.registerConsumer("idle", 100.0);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    ledger.populateTelemetry(json, std::nullopt, START + 1h);
+    REQUIRE_FALSE(json["consumers"]["idle"].is<JsonObject>());
+}
+
+TEST_CASE("model is calibrated towards measured discharge current") {
+    EnergyLedger ledger(10.0, START);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    ledger.populateTelemetry(json, -20.0, START + 1h);
+    REQUIRE(json["measured-current"].as<double>() == Approx(20.0));
+    REQUIRE(ledger.getCalibration() == Approx(1.2));
+
+    for (int i = 2; i < 50; i++) {
+        JsonDocument next;
+        auto nextJson = next.to<JsonObject>();
+        ledger.populateTelemetry(nextJson, -20.0, START + i * 1h);
+    }
+    REQUIRE(ledger.getCalibration() == Approx(2.0).epsilon(0.01));
+}
+
+TEST_CASE("charging current does not affect calibration") {
+    EnergyLedger ledger(10.0, START);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    ledger.populateTelemetry(json, 500.0, START + 1h);
+    REQUIRE_FALSE(json["measured-current"].is<double>());
+    REQUIRE(ledger.getCalibration() == Approx(1.0));
+}
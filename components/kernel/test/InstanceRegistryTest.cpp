@@ -0,0 +1,78 @@
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <InstanceRegistry.hpp>
+
+using namespace farmhub::kernel;
+
+namespace {
+
+struct Valve {
+    int state = 0;
+};
+
+struct Sensor {
+    double value = 0;
+};
+
+}    // namespace
+
+TEST_CASE("resolved instances are accessed by index") {
+    InstanceRegistry registry;
+    auto valve = std::make_shared<Valve>();
+    auto sensor = std::make_shared<Sensor>(12.5);
+    auto valveIndex = registry.add(valve, &TypeTokenVar<Valve>);
+    auto sensorIndex = registry.add(sensor, &TypeTokenVar<Sensor>);
+    REQUIRE(registry.size() == 2);
+
+    auto valveRef = registry.ref<Valve>(valveIndex);
+    REQUIRE(valveRef);
+    valveRef->state = 1;
+    REQUIRE(valve->state == 1);
+
+    REQUIRE(&*registry.ref<Sensor>(sensorIndex) == sensor.get());
+}
+
+TEST_CASE("resolving checks the type") {
+    InstanceRegistry registry;
+    auto index = registry.add(std::make_shared<Valve>(), &TypeTokenVar<Valve>);
+    REQUIRE_THROWS(registry.ref<Sensor>(index));
+    REQUIRE_THROWS(registry.ref<Valve>(index + 1));
+}
+
+TEST_CASE("references stay valid as the registry grows") {
+    InstanceRegistry registry;
+    std::vector<std::shared_ptr<Valve>> valves;
+    std::vector<InstanceRef<Valve>> refs;
+    // Well past the first few segments
+    for (int i = 0; i < 200; i++) {
+        auto valve = std::make_shared<Valve>(i);
+        refs.push_back(registry.ref<Valve>(registry.add(valve, &TypeTokenVar<Valve>)));
+        valves.push_back(valve);
+    }
+    REQUIRE(registry.size() == 200);
+    for (int i = 0; i < 200; i++) {
+        REQUIRE(&*refs[i] == valves[i].get());
+        REQUIRE(refs[i]->state == i);
+    }
+}
+
+TEST_CASE("references share ownership with the registry") {
+    InstanceRegistry registry;
+    std::weak_ptr<Valve> observer;
+    InstanceRef<Valve> ref;
+    {
+        auto valve = std::make_shared<Valve>();
+        observer = valve;
+        ref = registry.ref<Valve>(registry.add(valve, &TypeTokenVar<Valve>));
+    }
+    REQUIRE_FALSE(observer.expired());
+    REQUIRE(ref.share() == observer.lock());
+}
+
+TEST_CASE("default reference is empty") {
+    InstanceRef<Valve> ref;
+    REQUIRE_FALSE(ref);
+}
@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+
+#include <JsonArena.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("allocations come from the arena until it is full") {
+    JsonArena arena(128, 1024);
+    void* first = arena.allocate(40);
+    REQUIRE(first != nullptr);
+    void* second = arena.allocate(40);
+    REQUIRE(second != nullptr);
+    REQUIRE(second != first);
+    REQUIRE(arena.allocate(40) == nullptr);
+    REQUIRE(arena.isExhausted());
+}
+
+TEST_CASE("freeing everything rewinds the arena") {
+    JsonArena arena(128, 1024);
+    void* first = arena.allocate(40);
+    void* second = arena.allocate(40);
+    arena.deallocate(first);
+    arena.deallocate(second);
+    REQUIRE(arena.allocate(100) != nullptr);
+}
+
+TEST_CASE("freeing the last allocation reclaims it") {
+    JsonArena arena(128, 1024);
+    arena.allocate(40);
+    void* second = arena.allocate(40);
+    arena.deallocate(second);
+    REQUIRE(arena.allocate(40) == second);
+}
+
+TEST_CASE("last allocation is resized in place") {
+    JsonArena arena(256, 1024);
+    arena.allocate(16);
+    auto* str = static_cast<char*>(arena.allocate(8));
+    std::strcpy(str, "hello");
+    auto* grown = static_cast<char*>(arena.reallocate(str, 64));
+    REQUIRE(grown == str);
+    REQUIRE(std::strcmp(grown, "hello") == 0);
+    auto* shrunk = static_cast<char*>(arena.reallocate(grown, 8));
+    REQUIRE(shrunk == str);
+}
+
+TEST_CASE("earlier allocations are moved when resized") {
+    JsonArena arena(256, 1024);
+    auto* str = static_cast<char*>(arena.allocate(8));
+    std::strcpy(str, "hello");
+    arena.allocate(16);
+    auto* grown = static_cast<char*>(arena.reallocate(str, 32));
+    REQUIRE(grown != nullptr);
+    REQUIRE(grown != str);
+    REQUIRE(std::strcmp(grown, "hello") == 0);
+}
+
+TEST_CASE("arena grows to fit the high-water mark") {
+    JsonArena arena(128, 1024);
+    void* block = arena.allocate(100);
+    REQUIRE(arena.getHighWater() > 100);
+    arena.deallocate(block);
+    arena.fit();
+    REQUIRE(arena.getCapacity() > 128);
+    REQUIRE(arena.getHighWater() == 0);
+}
+
+TEST_CASE("exhausted arena doubles but stays within the maximum") {
+    JsonArena arena(128, 200);
+    REQUIRE(arena.allocate(500) == nullptr);
+    arena.fit();
+    REQUIRE(arena.getCapacity() == 200);
+    REQUIRE_FALSE(arena.isExhausted());
+}
+
+TEST_CASE("arena is not resized while in use") {
+    JsonArena arena(128, 1024);
+    arena.allocate(100);
+    arena.fit();
+    REQUIRE(arena.getCapacity() == 128);
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <LogLevels.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("log levels are parsed by name, initial or number") {
+    REQUIRE(parseLogLevel("none") == 0);
+    REQUIRE(parseLogLevel("error") == 1);
+    REQUIRE(parseLogLevel("W") == 2);
+    REQUIRE(parseLogLevel("i") == 3);
+    REQUIRE(parseLogLevel("4") == 4);
+    REQUIRE(parseLogLevel("verbose") == 5);
+    REQUIRE_FALSE(parseLogLevel("6").has_value());
+    REQUIRE_FALSE(parseLogLevel("loud").has_value());
+    REQUIRE_FALSE(parseLogLevel("").has_value());
+}
+
+TEST_CASE("tag levels are looked up at compile time") {
+    static_assert(logLevelInList("mqtt", "wifi=debug,mqtt=2") == 2);
+    static_assert(logLevelInList("wifi", "wifi=debug,mqtt=2") == 4);
+    static_assert(!logLevelInList("mq", "wifi=debug,mqtt=2").has_value());
+    static_assert(!logLevelInList("mqtt", "").has_value());
+    static_assert(logTagInList("mqtt", "wifi,mqtt"));
+    static_assert(!logTagInList("mqtt", "mqtt-log,wifi"));
+    static_assert(!logTagInList("mqtt", ""));
+}
+
+TEST_CASE("tags registered under the same name share a slot") {
+    LogLevelTable<4> table;
+    auto mqtt = table.registerTag("farmhub:mqtt", 5, 3);
+    auto wifi = table.registerTag("farmhub:wifi", 5, 3);
+    REQUIRE(mqtt != wifi);
+    REQUIRE(table.registerTag("farmhub:mqtt", 5, 3) == mqtt);
+    REQUIRE(table.size() == 2);
+    REQUIRE(table.find("farmhub:wifi") == wifi);
+    REQUIRE_FALSE(table.find("farmhub:pm").has_value());
+}
+
+TEST_CASE("runtime level is capped at the compiled level") {
+    LogLevelTable<4> table;
+    auto index = table.registerTag("farmhub:mqtt", 3, 5);
+    REQUIRE(table.getLevel(index) == 3);
+    REQUIRE(table.isEnabled(index, 3));
+    REQUIRE_FALSE(table.isEnabled(index, 4));
+
+    REQUIRE(table.setLevel(index, 1) == 1);
+    REQUIRE(table.isEnabled(index, 1));
+    REQUIRE_FALSE(table.isEnabled(index, 2));
+
+    REQUIRE(table.setLevel(index, 5) == 3);
+}
+
+TEST_CASE("tags beyond capacity share the last slot") {
+    LogLevelTable<2> table;
+    REQUIRE(table.registerTag("a", 5, 3) == 0);
+    REQUIRE(table.registerTag("b", 5, 3) == 1);
+    REQUIRE(table.registerTag("c", 5, 3) == 1);
+    REQUIRE(table.size() == 2);
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <LogRateLimiter.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("call site can log a burst per window") {
+    LogRateLimiter::configure(3, 1000);
+    LogRateLimiter::takeTotalSuppressed();
+    LogRateLimiter limiter;
+    REQUIRE(limiter.allow(5000));
+    REQUIRE(limiter.allow(5100));
+    REQUIRE(limiter.allow(5200));
+    REQUIRE_FALSE(limiter.allow(5300));
+    REQUIRE_FALSE(limiter.allow(5400));
+    REQUIRE(limiter.takeSuppressed() == 2);
+    REQUIRE(limiter.takeSuppressed() == 0);
+    REQUIRE(LogRateLimiter::takeTotalSuppressed() == 2);
+}
+
+TEST_CASE("call site can log again in the next window") {
+    LogRateLimiter::configure(1, 1000);
+    LogRateLimiter limiter;
+    REQUIRE(limiter.allow(5000));
+    REQUIRE_FALSE(limiter.allow(5500));
+    REQUIRE(limiter.allow(6000));
+    REQUIRE(limiter.takeSuppressed() == 1);
+}
+
+TEST_CASE("call sites are limited independently") {
+    LogRateLimiter::configure(1, 1000);
+    LogRateLimiter first;
+    LogRateLimiter second;
+    REQUIRE(first.allow(5000));
+    REQUIRE(second.allow(5000));
+    REQUIRE_FALSE(first.allow(5001));
+}
+
+TEST_CASE("repeated lines are collapsed regardless of timestamp") {
+    RepeatedLogCollapser collapser(100);
+    REQUIRE_FALSE(collapser.isRepeat("W (100) farmhub:wifi: Weak signal\n"));
+    REQUIRE(collapser.isRepeat("W (200) farmhub:wifi: Weak signal\n"));
+    REQUIRE(collapser.isRepeat("W (300) farmhub:wifi: Weak signal\n"));
+    REQUIRE(collapser.takePendingRepeats() == 0);
+
+    REQUIRE_FALSE(collapser.isRepeat("I (400) farmhub:wifi: Connected\n"));
+    REQUIRE(collapser.takePendingRepeats() == 2);
+    REQUIRE(collapser.takeTotalRepeats() == 2);
+}
+
+TEST_CASE("same message at different level is not a repeat") {
+    RepeatedLogCollapser collapser(100);
+    REQUIRE_FALSE(collapser.isRepeat("W (100) farmhub:wifi: Problem\n"));
+    REQUIRE_FALSE(collapser.isRepeat("E (200) farmhub:wifi: Problem\n"));
+}
+
+TEST_CASE("long runs of repeats are reported periodically") {
+    RepeatedLogCollapser collapser(2);
+    REQUIRE_FALSE(collapser.isRepeat("E (1) x: failed\n"));
+    REQUIRE(collapser.isRepeat("E (2) x: failed\n"));
+    REQUIRE(collapser.isRepeat("E (3) x: failed\n"));
+    REQUIRE_FALSE(collapser.isRepeat("E (4) x: failed\n"));
+    REQUIRE(collapser.takePendingRepeats() == 2);
+    REQUIRE(collapser.isRepeat("E (5) x: failed\n"));
+}
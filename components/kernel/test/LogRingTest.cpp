@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <string>
+
+#include <LogRing.hpp>
+
+using namespace farmhub::kernel;
+
+using TestRing = LogRing<300>;
+
+static void write(TestRing& ring, uint8_t level, const std::string& message) {
+    ring.write(level, message.c_str(), message.length());
+}
+
+TEST_CASE("uninitialized storage is not valid") {
+    TestRing::Storage storage;
+    std::memset(&storage, 0xA5, sizeof(storage));
+    TestRing ring(storage);
+    REQUIRE_FALSE(ring.isValid());
+    ring.reset();
+    REQUIRE(ring.isValid());
+    REQUIRE(ring.read().empty());
+}
+
+TEST_CASE("records are read back in order") {
+    TestRing::Storage storage;
+    TestRing ring(storage);
+    ring.reset();
+    write(ring, 2, "first");
+    write(ring, 3, "second");
+
+    TestRing restored(storage);
+    REQUIRE(restored.isValid());
+    auto records = restored.read();
+    REQUIRE(records.size() == 2);
+    REQUIRE(records[0].level == 2);
+    REQUIRE(records[0].message == "first");
+    REQUIRE(records[1].level == 3);
+    REQUIRE(records[1].message == "second");
+}
+
+TEST_CASE("oldest records are dropped when full") {
+    TestRing::Storage storage;
+    TestRing ring(storage);
+    ring.reset();
+    for (int i = 0; i < 100; i++) {
+        write(ring, 4, "message " + std::to_string(i));
+    }
+    REQUIRE(ring.isValid());
+    auto records = ring.read();
+    REQUIRE(records.size() < 100);
+    REQUIRE(records.back().message == "message 99");
+    REQUIRE(records.front().message == "message " + std::to_string(100 - records.size()));
+}
+
+TEST_CASE("long messages are truncated") {
+    TestRing::Storage storage;
+    TestRing ring(storage);
+    ring.reset();
+    write(ring, 2, std::string(1000, 'x'));
+    auto records = ring.read();
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0].message.length() == TestRing::MAX_MESSAGE_LENGTH);
+}
+
+TEST_CASE("corrupted ring is not valid") {
+    TestRing::Storage storage;
+    TestRing ring(storage);
+    ring.reset();
+    write(ring, 2, "hello");
+    storage.used += 1;
+    REQUIRE_FALSE(ring.isValid());
+}
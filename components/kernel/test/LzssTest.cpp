@@ -0,0 +1,97 @@
+#include <random>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <Lzss.hpp>
+
+using namespace farmhub::kernel;
+
+static std::string roundTrip(LzssCompressor& compressor, const std::string& input) {
+    std::string compressed;
+    REQUIRE(compressor.compress(input, compressed));
+    REQUIRE(LzssCompressor::isCompressed(compressed));
+    std::string decompressed;
+    REQUIRE(LzssCompressor::decompress(compressed, decompressed));
+    REQUIRE(decompressed == input);
+    return compressed;
+}
+
+TEST_CASE("empty and short inputs survive a round trip") {
+    LzssCompressor compressor;
+    REQUIRE(roundTrip(compressor, "").size() == LzssCompressor::HEADER_SIZE);
+    roundTrip(compressor, "a");
+    roundTrip(compressor, "abc");
+    roundTrip(compressor, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa");
+}
+
+TEST_CASE("repetitive JSON compresses well") {
+    LzssCompressor compressor;
+    std::string json = "{\"entries\":[";
+    for (int i = 0; i < 100; i++) {
+        json += (i == 0 ? "" : ",");
+        json += R"({"key":"valve-)" + std::to_string(i) + R"(","type":"blob","size":)" + std::to_string(100 + i % 7) + "}";
+    }
+    json += "]}";
+    auto compressed = roundTrip(compressor, json);
+    REQUIRE(compressed.size() < json.size() / 3);
+}
+
+TEST_CASE("random data survives a round trip") {
+    LzssCompressor compressor;
+    std::mt19937 random(42);
+    std::string input;
+    for (int i = 0; i < 5000; i++) {
+        // Small alphabet, so there are matches at all distances
+        input.push_back(static_cast<char>('a' + random() % 4));
+    }
+    roundTrip(compressor, input);
+
+    // Reusing the compressor must not be affected by the previous run
+    std::string binary;
+    for (int i = 0; i < 3000; i++) {
+        binary.push_back(static_cast<char>(random()));
+    }
+    roundTrip(compressor, binary);
+    roundTrip(compressor, input);
+}
+
+TEST_CASE("JSON is not mistaken for compressed data") {
+    REQUIRE_FALSE(LzssCompressor::isCompressed(R"({"key":"value"})"));
+    std::string output;
+    REQUIRE_FALSE(LzssCompressor::decompress(R"({"key":"value"})", output));
+}
+
+TEST_CASE("corrupt data is rejected") {
+    LzssCompressor compressor;
+    std::string compressed;
+    REQUIRE(compressor.compress("hello hello hello hello", compressed));
+    std::string output;
+    REQUIRE_FALSE(LzssCompressor::decompress(compressed.substr(0, compressed.size() - 1), output));
+    REQUIRE_FALSE(LzssCompressor::decompress(compressed + "x", output));
+
+    // Back-reference pointing before the start
+    std::string bad = compressed.substr(0, LzssCompressor::HEADER_SIZE);
+    bad += '\x01';
+    bad += '\xFF';
+    bad += '\xC0';
+    REQUIRE_FALSE(LzssCompressor::decompress(bad, output));
+}
+
+TEST_CASE("data larger than the limit is not decompressed") {
+    LzssCompressor compressor;
+    std::string input(1000, 'x');
+    std::string compressed;
+    REQUIRE(compressor.compress(input, compressed));
+    std::string output;
+    REQUIRE_FALSE(LzssCompressor::decompress(compressed, output, 999));
+    REQUIRE(output.capacity() < 999);
+    REQUIRE(LzssCompressor::decompress(compressed, output, 1000));
+    REQUIRE(output == input);
+}
+
+TEST_CASE("oversized input is not compressed") {
+    LzssCompressor compressor;
+    std::string output;
+    REQUIRE_FALSE(compressor.compress(std::string(LzssCompressor::MAX_INPUT_SIZE + 1, 'x'), output));
+}
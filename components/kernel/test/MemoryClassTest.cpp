@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <string>
+
+#include <MemoryClass.hpp>
+
+using namespace farmhub::kernel;
+
+static size_t usedBy(const char* name) {
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    Memory::populateTelemetry(json);
+    return json[name]["used"].as<size_t>();
+}
+
+TEST_CASE("usage is tracked per class") {
+    auto bulkBefore = usedBy("bulk");
+    auto fastBefore = usedBy("fast");
+    {
+        auto block = allocateBlock(MemoryClass::Bulk, 1000);
+        REQUIRE(usedBy("bulk") == bulkBefore + 1000);
+        REQUIRE(usedBy("fast") == fastBefore);
+    }
+    REQUIRE(usedBy("bulk") == bulkBefore);
+}
+
+TEST_CASE("reallocation keeps the contents and the class") {
+    auto fastBefore = usedBy("fast");
+    auto* ptr = static_cast<char*>(Memory::allocate(MemoryClass::Fast, 6));
+    std::memcpy(ptr, "hello", 6);
+    ptr = static_cast<char*>(Memory::reallocate(ptr, 100));
+    REQUIRE(std::string(ptr) == "hello");
+    REQUIRE(usedBy("fast") == fastBefore + 100);
+    Memory::release(ptr);
+    REQUIRE(usedBy("fast") == fastBefore);
+}
+
+TEST_CASE("peak is reset when reported") {
+    {
+        auto block = allocateBlock(MemoryClass::Dma, 4096);
+    }
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    Memory::populateTelemetry(json);
+    REQUIRE(json["dma"]["peak"].as<size_t>() >= 4096);
+
+    json = doc.to<JsonObject>();
+    Memory::populateTelemetry(json);
+    REQUIRE(json["dma"]["peak"].as<size_t>() == json["dma"]["used"].as<size_t>());
+}
+
+TEST_CASE("JSON documents can be placed in bulk memory") {
+    auto bulkBefore = usedBy("bulk");
+    {
+        JsonDocument doc(bulkJsonAllocator());
+        doc["message"] = std::string(200, 'x');
+        REQUIRE(usedBy("bulk") > bulkBefore);
+        REQUIRE(doc["message"].as<std::string>().size() == 200);
+    }
+    REQUIRE(usedBy("bulk") == bulkBefore);
+}
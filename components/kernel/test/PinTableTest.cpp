@@ -0,0 +1,58 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <PinTable.hpp>
+
+using namespace farmhub::kernel;
+
+static constexpr PinTable<6> PINS { {
+    PinDefinition { "BOOT", 0 },
+    PinDefinition { "SDA", 1 },
+    PinDefinition { "SCL", 2 },
+    PinDefinition { "A1", 16 },
+    PinDefinition { "D-", 19 },
+    PinDefinition { "LED", 1 },
+} };
+
+TEST_CASE("pins are found by name at compile time") {
+    static_assert(PINS.findGpio("SDA") == 1);
+    static_assert(PINS.findGpio("D-") == 19);
+    static_assert(!PINS.findGpio("SD").has_value());
+    static_assert(!PINS.findGpio("").has_value());
+}
+
+TEST_CASE("every pin is found by name") {
+    for (const auto& pin : PINS.view().getPins()) {
+        REQUIRE(PINS.findGpio(pin.name) == pin.gpio);
+    }
+    REQUIRE_FALSE(PINS.findGpio("B1").has_value());
+}
+
+TEST_CASE("GPIOs resolve to the first name defined for them") {
+    REQUIRE(PINS.findName(1) == "SDA");
+    REQUIRE(PINS.findName(16) == "A1");
+    REQUIRE_FALSE(PINS.findName(3).has_value());
+    REQUIRE_FALSE(PINS.findName(-1).has_value());
+    REQUIRE_FALSE(PINS.findName(MAX_PIN_GPIO).has_value());
+}
+
+TEST_CASE("empty view finds nothing") {
+    PinTableView view;
+    REQUIRE_FALSE(view.findGpio("SDA").has_value());
+    REQUIRE_FALSE(view.findName(1).has_value());
+}
+
+TEST_CASE("names differing only in their last character get their own slots") {
+    static constexpr PinTable<8> ports { {
+        PinDefinition { "A1", 1 },
+        PinDefinition { "A2", 2 },
+        PinDefinition { "A3", 3 },
+        PinDefinition { "A4", 4 },
+        PinDefinition { "B1", 5 },
+        PinDefinition { "B2", 6 },
+        PinDefinition { "B3", 7 },
+        PinDefinition { "B4", 8 },
+    } };
+    for (const auto& pin : ports.view().getPins()) {
+        REQUIRE(ports.findGpio(pin.name) == pin.gpio);
+    }
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <PulseTiming.hpp>
+
+using namespace farmhub::kernel;
+
+static constexpr int64_t SECOND = 1000000;
+
+TEST_CASE("timestamps are queued in order and dropped when full") {
+    PulseTimestampBuffer buffer;
+    for (size_t i = 0; i < PulseTimestampBuffer::CAPACITY; i++) {
+        REQUIRE(buffer.push(static_cast<int64_t>(i)));
+    }
+    REQUIRE_FALSE(buffer.push(100));
+    REQUIRE(buffer.takeDropped() == 1);
+    REQUIRE(buffer.takeDropped() == 0);
+
+    REQUIRE(buffer.pop() == 0);
+    REQUIRE(buffer.push(100));
+    for (size_t i = 1; i < PulseTimestampBuffer::CAPACITY; i++) {
+        REQUIRE(buffer.pop() == static_cast<int64_t>(i));
+    }
+    REQUIRE(buffer.pop() == 100);
+    REQUIRE_FALSE(buffer.pop().has_value());
+}
+
+TEST_CASE("intervals of a steady source") {
+    PulseIntervalAnalyzer analyzer;
+    for (int i = 0; i <= 10; i++) {
+        analyzer.record(i * SECOND + (i % 2 == 0 ? 0 : 10000));
+    }
+    REQUIRE(analyzer.getExpectedIntervalUs() == SECOND);
+    auto stats = analyzer.takeStats();
+    REQUIRE(stats.pulses == 11);
+    REQUIRE(stats.missed == 0);
+    REQUIRE(stats.meanIntervalUs == SECOND);
+    REQUIRE(stats.minIntervalUs == SECOND - 10000);
+    REQUIRE(stats.maxIntervalUs == SECOND + 10000);
+    REQUIRE(stats.jitterUs == 10000);
+
+    // Counters are reset, the window is kept
+    stats = analyzer.takeStats();
+    REQUIRE(stats.pulses == 0);
+    REQUIRE(stats.meanIntervalUs == SECOND);
+}
+
+TEST_CASE("gaps count as missing pulses and are kept out of the statistics") {
+    PulseIntervalAnalyzer analyzer;
+    int64_t time = 0;
+    for (int i = 0; i < 5; i++) {
+        analyzer.record(time += SECOND);
+    }
+    analyzer.takeStats();
+
+    // Two pulses missing
+    analyzer.record(time += 3 * SECOND);
+    auto stats = analyzer.takeStats();
+    REQUIRE(stats.pulses == 1);
+    REQUIRE(stats.missed == 2);
+    REQUIRE(stats.maxIntervalUs == SECOND);
+}
+
+TEST_CASE("nothing is missing while still learning") {
+    PulseIntervalAnalyzer analyzer;
+    analyzer.record(0);
+    analyzer.record(SECOND);
+    analyzer.record(10 * SECOND);
+    analyzer.checkSilence(60 * SECOND);
+    REQUIRE(analyzer.takeStats().missed == 0);
+}
+
+TEST_CASE("silence counts missing pulses once") {
+    PulseIntervalAnalyzer analyzer;
+    int64_t time = 0;
+    for (int i = 0; i < 5; i++) {
+        analyzer.record(time += SECOND);
+    }
+    analyzer.takeStats();
+
+    analyzer.checkSilence(time + SECOND);
+    REQUIRE(analyzer.takeStats().missed == 0);
+    analyzer.checkSilence(time + 4 * SECOND);
+    analyzer.checkSilence(time + 4 * SECOND);
+    REQUIRE(analyzer.takeStats().missed == 3);
+
+    // The pulse ending the silence doesn't count the same misses again
+    analyzer.record(time + 5 * SECOND);
+    auto stats = analyzer.takeStats();
+    REQUIRE(stats.pulses == 1);
+    REQUIRE(stats.missed == 1);
+}
+
+TEST_CASE("a source that slowed down is learned again") {
+    PulseIntervalAnalyzer analyzer;
+    int64_t time = 0;
+    for (int i = 0; i < 5; i++) {
+        analyzer.record(time += SECOND);
+    }
+    for (size_t i = 0; i < PulseIntervalAnalyzer::WINDOW / 4 + PulseIntervalAnalyzer::MIN_INTERVALS + 1; i++) {
+        analyzer.record(time += 3 * SECOND);
+    }
+    REQUIRE(analyzer.getExpectedIntervalUs() == 3 * SECOND);
+    analyzer.takeStats();
+    analyzer.record(time += 3 * SECOND);
+    REQUIRE(analyzer.takeStats().missed == 0);
+}
+
+TEST_CASE("degradation must be sustained to change state") {
+    DegradationDetector detector(0.25, 3);
+    REQUIRE_FALSE(detector.evaluate(5, 5).has_value());
+    REQUIRE_FALSE(detector.evaluate(5, 5).has_value());
+    REQUIRE(detector.evaluate(5, 5) == true);
+    REQUIRE(detector.isDegraded());
+
+    // A good period interrupts the streak
+    REQUIRE_FALSE(detector.evaluate(10, 0).has_value());
+    REQUIRE_FALSE(detector.evaluate(5, 5).has_value());
+    REQUIRE_FALSE(detector.evaluate(10, 0).has_value());
+    REQUIRE_FALSE(detector.evaluate(10, 0).has_value());
+    REQUIRE(detector.evaluate(10, 0) == false);
+
+    // Periods without any expected pulse are ignored
+    REQUIRE_FALSE(detector.evaluate(0, 0).has_value());
+}
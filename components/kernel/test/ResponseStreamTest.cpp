@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <mqtt/ResponseStream.hpp>
+
+using namespace farmhub::kernel::mqtt;
+
+static std::vector<std::string> stream(JsonObject request, size_t maxChunkSize, int count, size_t failAfter = SIZE_MAX) {
+    std::vector<std::string> chunks;
+    ResponseStream stream(request, maxChunkSize, [&](const JsonDocument& chunk) {
+        if (chunks.size() >= failAfter) {
+            return false;
+        }
+        std::string payload;
+        serializeJson(chunk, payload);
+        chunks.push_back(payload);
+        return true;
+    });
+    for (int i = 0; i < count; i++) {
+        if (!stream.add([i](JsonObject& entry) {
+                entry["key"] = "key-" + std::to_string(i);
+            })) {
+            break;
+        }
+    }
+    stream.finish();
+    return chunks;
+}
+
+TEST_CASE("short listing is sent as a single last chunk") {
+    JsonDocument requestDoc;
+    auto chunks = stream(requestDoc.to<JsonObject>(), 1024, 3);
+    REQUIRE(chunks.size() == 1);
+
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, chunks[0]) == DeserializationError::Ok);
+    REQUIRE(parsed["seq"].as<int>() == 0);
+    REQUIRE(parsed["entries"].size() == 3);
+    REQUIRE(parsed["last"].as<bool>());
+    REQUIRE_FALSE(parsed["continuation"].is<int>());
+}
+
+TEST_CASE("empty listing still sends the last chunk") {
+    JsonDocument requestDoc;
+    auto chunks = stream(requestDoc.to<JsonObject>(), 1024, 0);
+    REQUIRE(chunks.size() == 1);
+    REQUIRE(chunks[0] == R"({"seq":0,"entries":[],"last":true})");
+}
+
+TEST_CASE("long listing is split into bounded chunks with continuation tokens") {
+    JsonDocument requestDoc;
+    requestDoc["id"] = "abc";
+    auto chunks = stream(requestDoc.as<JsonObject>(), 256, 100);
+    REQUIRE(chunks.size() > 1);
+
+    int expectedIndex = 0;
+    for (size_t seq = 0; seq < chunks.size(); seq++) {
+        REQUIRE(chunks[seq].size() <= 256);
+        JsonDocument parsed;
+        REQUIRE(deserializeJson(parsed, chunks[seq]) == DeserializationError::Ok);
+        REQUIRE(parsed["id"].as<std::string>() == "abc");
+        REQUIRE(parsed["seq"].as<size_t>() == seq);
+        for (auto entry : parsed["entries"].as<JsonArray>()) {
+            REQUIRE(entry["key"].as<std::string>() == "key-" + std::to_string(expectedIndex++));
+        }
+        if (seq + 1 < chunks.size()) {
+            REQUIRE(parsed["continuation"].as<int>() == expectedIndex);
+        } else {
+            REQUIRE(parsed["last"].as<bool>());
+        }
+    }
+    REQUIRE(expectedIndex == 100);
+}
+
+TEST_CASE("listing resumes from the continuation token") {
+    JsonDocument requestDoc;
+    requestDoc["continuation"] = 98;
+    auto chunks = stream(requestDoc.as<JsonObject>(), 1024, 100);
+    REQUIRE(chunks.size() == 1);
+
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, chunks[0]) == DeserializationError::Ok);
+    REQUIRE(parsed["entries"].size() == 2);
+    REQUIRE(parsed["entries"][0]["key"].as<std::string>() == "key-98");
+}
+
+TEST_CASE("stream stops when a chunk cannot be sent") {
+    JsonDocument requestDoc;
+    auto chunks = stream(requestDoc.to<JsonObject>(), 256, 100, 1);
+    REQUIRE(chunks.size() == 1);
+
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, chunks[0]) == DeserializationError::Ok);
+    REQUIRE(parsed["continuation"].is<int>());
+}
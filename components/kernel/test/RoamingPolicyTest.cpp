@@ -0,0 +1,39 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <drivers/RoamingPolicy.hpp>
+
+using namespace farmhub::kernel::drivers;
+
+static const steady_clock::time_point START = steady_clock::time_point(1h);
+
+TEST_CASE("strong link does not trigger a scan") {
+    RoamingPolicy policy({});
+    REQUIRE_FALSE(policy.shouldScan(-60, START));
+}
+
+TEST_CASE("weak link triggers a scan") {
+    RoamingPolicy policy({});
+    REQUIRE(policy.shouldScan(-85, START));
+}
+
+TEST_CASE("scans are rate limited") {
+    RoamingPolicy policy({ .scanInterval = 5min });
+    REQUIRE(policy.shouldScan(-85, START));
+    REQUIRE_FALSE(policy.shouldScan(-85, START + 4min));
+    REQUIRE(policy.shouldScan(-85, START + 5min));
+}
+
+TEST_CASE("candidate must beat current AP by hysteresis") {
+    RoamingPolicy policy({ .hysteresis = 8 });
+    REQUIRE_FALSE(policy.shouldRoam(-85, -80));
+    REQUIRE(policy.shouldRoam(-85, -77));
+    REQUIRE(policy.shouldRoam(-85, -60));
+}
+
+TEST_CASE("no scans shortly after roaming") {
+    RoamingPolicy policy({ .scanInterval = 1min, .minRoamInterval = 15min });
+    REQUIRE(policy.shouldScan(-85, START));
+    policy.recordRoam(START);
+    REQUIRE_FALSE(policy.shouldScan(-85, START + 10min));
+    REQUIRE(policy.shouldScan(-85, START + 15min));
+}
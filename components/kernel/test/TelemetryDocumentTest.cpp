@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <utility>
+
+#include <TelemetryDocument.hpp>
+
+using namespace farmhub::kernel;
+
+TEST_CASE("sections within the budget are kept") {
+    TelemetryDocument telemetry(4096);
+    auto root = telemetry.begin();
+    root["uptime"] = 1234;
+    REQUIRE(telemetry.add<JsonObject>("wifi", [](JsonObject& json) {
+        json["rssi"] = -60;
+    }));
+    const auto& output = telemetry.serialize();
+
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, output) == DeserializationError::Ok);
+    REQUIRE(parsed["uptime"].as<int>() == 1234);
+    REQUIRE(parsed["wifi"]["rssi"].as<int>() == -60);
+    REQUIRE_FALSE(parsed["serialization"]["truncated"].is<JsonArray>());
+}
+
+TEST_CASE("sections over the budget are truncated") {
+    TelemetryDocument telemetry(8192);
+    telemetry.begin();
+    REQUIRE(telemetry.add<JsonObject>("small", [](JsonObject& json) {
+        json["value"] = 1;
+    }));
+    REQUIRE_FALSE(telemetry.add<JsonObject>("large", [](JsonObject& json) {
+        json["text"] = std::string(9000, 'x');
+    }));
+    REQUIRE(telemetry.add<JsonObject>("after", [](JsonObject& json) {
+        json["value"] = 2;
+    }));
+    const auto& output = telemetry.serialize();
+    REQUIRE(output.size() <= 8192);
+
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, output) == DeserializationError::Ok);
+    REQUIRE_FALSE(parsed["large"].is<JsonObject>());
+    REQUIRE(parsed["after"]["value"].as<int>() == 2);
+    REQUIRE(parsed["serialization"]["truncated"][0].as<std::string>() == "large");
+}
+
+TEST_CASE("peak usage is reported with the next document") {
+    TelemetryDocument telemetry(4096);
+    telemetry.begin();
+    telemetry.add<JsonObject>("data", [](JsonObject& json) {
+        json["value"] = 1;
+    });
+    auto firstSize = telemetry.serialize().size();
+    REQUIRE(telemetry.getLastPeak() > firstSize);
+
+    telemetry.begin();
+    const auto& output = telemetry.serialize();
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, output) == DeserializationError::Ok);
+    REQUIRE(parsed["serialization"]["peak"].as<size_t>() > firstSize);
+}
+
+TEST_CASE("output buffer is kept between documents") {
+    TelemetryDocument telemetry(4096);
+    telemetry.begin();
+    telemetry.add<JsonObject>("data", [](JsonObject& json) {
+        json["text"] = std::string(1000, 'x');
+    });
+    const auto* buffer = telemetry.serialize().data();
+
+    telemetry.begin();
+    telemetry.add<JsonObject>("data", [](JsonObject& json) {
+        json["text"] = std::string(2000, 'x');
+    });
+    const auto& output = telemetry.serialize();
+    REQUIRE(output.size() > 2000);
+    REQUIRE(output.data() == buffer);
+}
+
+TEST_CASE("dropped sections are sent with the next document instead of fresh values") {
+    TelemetryDocument telemetry(1024);
+    int counter = 5;
+    auto populateCounter = [&](JsonObject& json) {
+        json["count"] = std::exchange(counter, 0);
+    };
+
+    telemetry.begin();
+    REQUIRE(telemetry.add<JsonObject>("filler", [](JsonObject& json) {
+        json["text"] = std::string(700, 'x');
+    }));
+    REQUIRE_FALSE(telemetry.add<JsonObject>("counter", [&](JsonObject& json) {
+        populateCounter(json);
+        json["padding"] = std::string(200, 'y');
+    }));
+    telemetry.serialize();
+
+    // Not populated again while held back
+    counter = 3;
+    telemetry.begin();
+    REQUIRE(telemetry.add<JsonObject>("counter", populateCounter));
+    const auto& output = telemetry.serialize();
+    REQUIRE(counter == 3);
+
+    JsonDocument parsed;
+    REQUIRE(deserializeJson(parsed, output) == DeserializationError::Ok);
+    REQUIRE(parsed["counter"]["count"].as<int>() == 5);
+    REQUIRE(parsed["counter"]["padding"].as<std::string>().size() == 200);
+
+    // Fresh values are sent once the held back ones are out
+    telemetry.begin();
+    REQUIRE(telemetry.add<JsonObject>("counter", populateCounter));
+    JsonDocument next;
+    REQUIRE(deserializeJson(next, telemetry.serialize()) == DeserializationError::Ok);
+    REQUIRE(next["counter"]["count"].as<int>() == 3);
+}
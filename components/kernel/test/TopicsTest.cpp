@@ -0,0 +1,23 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <mqtt/Topics.hpp>
+
+using namespace farmhub::kernel::mqtt;
+
+TEST_CASE("literal topics match exactly") {
+    REQUIRE(topicMatches("devices/ugly-duckling/commands/ping", "devices/ugly-duckling/commands/ping"));
+    REQUIRE_FALSE(topicMatches("devices/ugly-duckling/commands/ping", "devices/ugly-duckling/commands/pin"));
+    REQUIRE_FALSE(topicMatches("devices/ugly-duckling/commands", "devices/ugly-duckling/commands/ping"));
+    REQUIRE_FALSE(topicMatches("devices/ugly-duckling/commands/ping", "devices/ugly-duckling/commands"));
+}
+
+TEST_CASE("single level wildcard matches one level") {
+    REQUIRE(topicMatches("devices/+/commands/ping", "devices/ugly-duckling/commands/ping"));
+    REQUIRE_FALSE(topicMatches("devices/+/ping", "devices/ugly-duckling/commands/ping"));
+}
+
+TEST_CASE("multi level wildcard matches the rest") {
+    REQUIRE(topicMatches("devices/ugly-duckling/commands/#", "devices/ugly-duckling/commands/nvs/list"));
+    REQUIRE(topicMatches("devices/ugly-duckling/commands/#", "devices/ugly-duckling/commands"));
+    REQUIRE_FALSE(topicMatches("devices/ugly-duckling/commands/#", "devices/other/commands/ping"));
+}
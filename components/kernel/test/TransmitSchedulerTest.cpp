@@ -0,0 +1,45 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <mqtt/TransmitScheduler.hpp>
+
+using namespace farmhub::kernel::mqtt;
+using Catch::Approx;
+
+static const steady_clock::time_point START = steady_clock::time_point(1h);
+
+TEST_CASE("messages are sent right away when not batching") {
+    TransmitScheduler scheduler(2s, false, START);
+    REQUIRE_FALSE(scheduler.isBatching());
+    REQUIRE(scheduler.nextWindow(START + 500ms) == START + 500ms);
+}
+
+TEST_CASE("messages wait for the next wake window") {
+    TransmitScheduler scheduler(2s, true, START);
+    REQUIRE(scheduler.isBatching());
+    REQUIRE(scheduler.nextWindow(START) == START);
+    REQUIRE(scheduler.nextWindow(START + 1ms) == START + 2s);
+    REQUIRE(scheduler.nextWindow(START + 2s) == START + 2s);
+    REQUIRE(scheduler.nextWindow(START + 5s) == START + 6s);
+}
+
+TEST_CASE("wake windows follow the phase of received traffic") {
+    TransmitScheduler scheduler(2s, true, START);
+    scheduler.recordRadioAwake(START + 700ms);
+    REQUIRE(scheduler.nextWindow(START + 1s) == START + 2700ms);
+    REQUIRE(scheduler.nextWindow(START + 5s) == START + 6700ms);
+}
+
+TEST_CASE("radio-on ratio accounts for listening and bursts") {
+    TransmitScheduler scheduler(1s, true, START);
+    scheduler.recordTransmit(4, 1000);
+    scheduler.recordTransmit(1, 0);
+
+    JsonDocument doc;
+    auto json = doc.to<JsonObject>();
+    scheduler.populateTelemetry(json, START + 100s);
+    // 100 listens of 3 ms, 2 bursts of 20 ms, 1000 bytes of 10 us
+    REQUIRE(json["radio-on"].as<double>() == Approx((300.0 + 40.0 + 10.0) / 100000.0));
+    REQUIRE(json["bursts"].as<int>() == 2);
+    REQUIRE(json["messages"].as<int>() == 5);
+}
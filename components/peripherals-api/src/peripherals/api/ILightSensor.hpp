@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 #include "IPeripheral.hpp"
 #include "Units.hpp"
 
@@ -7,6 +9,15 @@ namespace farmhub::peripherals::api {
 
 struct ILightSensor : virtual IPeripheral {
     virtual Lux getLightLevel() = 0;
+
+    /**
+     * @brief Measure at the full rate for the given time, e.g. around an expected change in light.
+     *
+     * Sensors measure continuously until the first such request. From then on, they only measure
+     * rarely outside the requested windows.
+     */
+    virtual void requestMeasurements(std::chrono::milliseconds /*duration*/) {
+    }
 };
 
 }    // namespace farmhub::peripherals::api
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include <Configuration.hpp>
+#include <EnergyLedger.hpp>
 #include <EspException.hpp>
 #include <I2CManager.hpp>
 #include <Manager.hpp>
@@ -46,6 +47,7 @@ public:
 // Peripheral factories
 
 struct PeripheralServices {
+    const std::shared_ptr<EnergyLedger> energy;
     const std::shared_ptr<I2CManager> i2c;
     const std::shared_ptr<NvsStore> nvs;
     const std::shared_ptr<PcntManager> pcntManager;
@@ -73,6 +75,14 @@ struct PeripheralInitParameters {
         return peripherals.getInstance<T>(name);
     }
 
+    /**
+     * @brief Resolve a peripheral once, for dependents that use it on every reading.
+     */
+    template <typename T>
+    InstanceRef<T> resolvePeripheral(const std::string& name) const {
+        return peripherals.resolve<T>(name);
+    }
+
     const std::string name;
     const PeripheralServices& services;
     const std::shared_ptr<TelemetryCollector> telemetryCollector;
@@ -161,8 +171,8 @@ public:
         return manager.getInstance<T>(name);
     }
 
-    void shutdown() {
-        manager.shutdown();
+    void shutdown(const ShutdownParameters& parameters) {
+        manager.shutdown(parameters);
     }
 
 private:
@@ -9,6 +9,7 @@
 #include <variant>
 
 #include <Concurrent.hpp>
+#include <EnergyLedger.hpp>
 #include <Named.hpp>
 #include <Task.hpp>
 #include <Telemetry.hpp>
@@ -32,6 +33,11 @@ namespace farmhub::peripherals::door {
 
 LOGGING_TAG(DOOR, "door")
 
+/**
+ * @brief Typical current draw of a door motor while moving, in mA.
+ */
+static constexpr double DOOR_MOTOR_CURRENT = 250.0;
+
 enum class OperationState : uint8_t {
     Running,
     Stopped,
@@ -46,20 +52,28 @@ class DoorMotorController {
 public:
     DoorMotorController(
         const std::shared_ptr<PwmMotorDriver>& motor,
-        Watchdog& watchdog)
+        Watchdog& watchdog,
+        const std::shared_ptr<EnergyConsumer>& energy)
         : motor(motor)
-        , watchdog(watchdog) {
+        , watchdog(watchdog)
+        , energy(energy) {
     }
 
     void drive(MotorPhase phase) {
         motor->drive(phase, 1);
         watchdog.restart();
+        if (!moving) {
+            energy->begin();
+        }
         moving = true;
     }
 
     void stop() {
         motor->stop();
         watchdog.cancel();
+        if (moving) {
+            energy->end();
+        }
         moving = false;
     }
 
@@ -70,6 +84,7 @@ public:
 private:
     const std::shared_ptr<PwmMotorDriver> motor;
     Watchdog& watchdog;
+    const std::shared_ptr<EnergyConsumer> energy;
     bool moving = false;
 };
 
@@ -115,7 +130,8 @@ public:
         const InternalPinPtr& closedPin,
         bool invertSwitches,
         ticks movementTimeout,
-        const std::shared_ptr<TelemetryPublisher>& telemetryPublisher)
+        const std::shared_ptr<TelemetryPublisher>& telemetryPublisher,
+        const std::shared_ptr<EnergyConsumer>& energy)
         : Peripheral(name)
         , motor(motor)
         , openSwitch(switches->registerSwitch({
@@ -135,7 +151,7 @@ public:
         , watchdog(name + ":watchdog", movementTimeout, false, [this](WatchdogState state) {
             handleWatchdogEvent(state);
         })
-        , motorController(motor, watchdog)
+        , motorController(motor, watchdog, energy)
         , telemetryPublisher(telemetryPublisher) {
 
         LOGTI(DOOR, "Initializing door %s, open switch %s, closed switch %s%s",
@@ -178,6 +194,11 @@ public:
         }
     }
 
+    milliseconds getShutdownEstimate() const override {
+        // The door's own task stops the motor, we only wait for the queue
+        return 10ms;
+    }
+
 private:
     void runLoop() {
         bool shouldPublishTelemetry = true;
@@ -383,7 +404,8 @@ inline PeripheralFactory makeFactory(const std::map<std::string, std::shared_ptr
                 settings->closedPin.get(),
                 settings->invertSwitches.get(),
                 settings->movementTimeout.get(),
-                params.services.telemetryPublisher);
+                params.services.telemetryPublisher,
+                params.services.energy->registerConsumer("door:" + params.name, DOOR_MOTOR_CURRENT));
 
             params.registerFeature("door", [door](JsonObject& telemetryJson) {
                 door->populateTelemetry(telemetryJson);
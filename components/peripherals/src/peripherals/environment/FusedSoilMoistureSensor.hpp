@@ -0,0 +1,176 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Concurrent.hpp>
+#include <Configuration.hpp>
+#include <peripherals/Peripheral.hpp>
+#include <peripherals/api/ISoilMoistureSensor.hpp>
+#include <peripherals/api/ITemperatureSensor.hpp>
+
+#include <scheduling/MoistureFusion.hpp>
+#include <utils/DebouncedMeasurement.hpp>
+
+#include "Environment.hpp"
+
+using namespace std::chrono;
+using namespace farmhub::utils::scheduling;
+
+namespace farmhub::peripherals::environment {
+
+/**
+ * @brief Combines several soil moisture sensors into one, rejecting outliers and weighting by noise.
+ */
+class FusedSoilMoistureSensorSettings
+    : public ConfigurationSection {
+public:
+    ArrayProperty<std::string> moistureSensors { this, "moistureSensors" };
+    // Optional, readings are not compensated for temperature without it
+    Property<std::string> temperatureSensor { this, "temperatureSensor" };
+
+    // Change in reading per degree Celsius caused by temperature alone
+    Property<double> temperatureCoefficient { this, "temperatureCoefficient", 0.0 };
+    Property<Celsius> tempRef { this, "tempRef", 20.0 };
+
+    // Readings further than this many median absolute deviations from the median are outliers
+    Property<double> outlierThreshold { this, "outlierThreshold", 3.0 };
+    // ...unless they are closer than this to the median
+    Property<Percent> minOutlierDeviation { this, "minOutlierDeviation", 5.0 };
+
+    // How often to sample all sensors
+    Property<milliseconds> measurementFrequency { this, "measurementFrequency", 1s };
+};
+
+class FusedSoilMoistureSensor final
+    : public api::ISoilMoistureSensor,
+      public Peripheral {
+public:
+    FusedSoilMoistureSensor(
+        const std::string& name,
+        std::vector<InstanceRef<api::ISoilMoistureSensor>> moistureSensors,
+        InstanceRef<api::ITemperatureSensor> tempSensor,
+        const MoistureFusion::Config& config,
+        milliseconds measurementFrequency)
+        : Peripheral(name)
+        , moistureSensors(std::move(moistureSensors))
+        , tempSensor(tempSensor)
+        , fusion(this->moistureSensors.size(), config)
+        , readings(this->moistureSensors.size())
+        , measurement(
+              [this](const utils::DebouncedParams<Percent> /*params*/) -> std::optional<Percent> {
+                  return sampleAll();
+              },
+              measurementFrequency,
+              NAN) {
+        std::string sources;
+        for (const auto& sensor : this->moistureSensors) {
+            if (!sources.empty()) {
+                sources += ", ";
+            }
+            sources += "'" + sensor->getName() + "'";
+        }
+        LOGTI(ENV, "Initializing fused soil moisture sensor '%s' combining %s"
+                   " with temperature sensor '%s'"
+                   "; temperature coefficient: %.2f %%/C"
+                   ", reference temp.: %.1f C"
+                   ", outlier threshold: %.1f MAD (min %.1f%%)",
+            name.c_str(),
+            sources.c_str(),
+            !tempSensor ? "none" : tempSensor->getName().c_str(),
+            config.temperatureCoefficient,
+            config.temperatureRef,
+            config.outlierThreshold,
+            config.minOutlierDeviation);
+    }
+
+    Percent getMoisture() override {
+        return measurement.getValue();
+    }
+
+    void populateSources(JsonObject& telemetryJson) {
+        Lock lock(fusionMutex);
+        auto sourcesJson = telemetryJson["sources"].to<JsonArray>();
+        const auto& health = fusion.getSources();
+        for (size_t i = 0; i < health.size(); i++) {
+            auto sourceJson = sourcesJson.add<JsonObject>();
+            sourceJson["name"] = moistureSensors[i]->getName();
+            sourceJson["state"] = toString(health[i].state);
+            sourceJson["value"] = health[i].value;
+            sourceJson["noise"] = std::sqrt(health[i].variance);
+            sourceJson["outliers"] = health[i].outliers;
+            sourceJson["failures"] = health[i].failures;
+        }
+    }
+
+private:
+    /**
+     * @brief Read every sensor in one go, so that all readings belong to the same moment.
+     */
+    std::optional<Percent> sampleAll() {
+        Lock lock(fusionMutex);
+        for (size_t i = 0; i < moistureSensors.size(); i++) {
+            readings[i] = moistureSensors[i]->getMoisture();
+        }
+        auto temperature = !tempSensor ? NAN : tempSensor->getTemperature();
+        auto fused = fusion.fuse(readings, temperature);
+        if (std::isnan(fused)) {
+            LOGTW(ENV, "None of the %zu soil moisture sensors of '%s' provided a usable reading",
+                moistureSensors.size(), getName().c_str());
+            return std::nullopt;
+        }
+        LOGTV(ENV, "Fused soil moisture of '%s': %.1f%% (temperature: %.1f C)",
+            getName().c_str(), fused, temperature);
+        return fused;
+    }
+
+    const std::vector<InstanceRef<api::ISoilMoistureSensor>> moistureSensors;
+    const InstanceRef<api::ITemperatureSensor> tempSensor;
+
+    Mutex fusionMutex;
+    MoistureFusion fusion;
+    std::vector<double> readings;
+
+    utils::DebouncedMeasurement<Percent> measurement;
+};
+
+inline PeripheralFactory makeFactoryForFusedSoilMoisture() {
+    return makePeripheralFactory<ISoilMoistureSensor, FusedSoilMoistureSensor, FusedSoilMoistureSensorSettings>(
+        "environment:fused-soil-moisture",
+        "environment",
+        [](PeripheralInitParameters& params, const std::shared_ptr<FusedSoilMoistureSensorSettings>& settings) {
+            std::vector<InstanceRef<api::ISoilMoistureSensor>> moistureSensors;
+            for (const auto& sensorName : settings->moistureSensors.get()) {
+                moistureSensors.push_back(params.resolvePeripheral<api::ISoilMoistureSensor>(sensorName));
+            }
+            if (moistureSensors.empty()) {
+                throw PeripheralCreationException("no moisture sensors configured");
+            }
+            InstanceRef<api::ITemperatureSensor> tempSensor;
+            if (!settings->temperatureSensor.get().empty()) {
+                tempSensor = params.resolvePeripheral<api::ITemperatureSensor>(settings->temperatureSensor.get());
+            }
+            auto sensor = std::make_shared<FusedSoilMoistureSensor>(
+                params.name,
+                std::move(moistureSensors),
+                tempSensor,
+                MoistureFusion::Config {
+                    .outlierThreshold = settings->outlierThreshold.get(),
+                    .minOutlierDeviation = settings->minOutlierDeviation.get(),
+                    .temperatureCoefficient = settings->temperatureCoefficient.get(),
+                    .temperatureRef = settings->tempRef.get(),
+                },
+                settings->measurementFrequency.get());
+            params.registerFeature("moisture", [sensor](JsonObject& telemetryJson) {
+                telemetryJson["value"] = sensor->getMoisture();
+            });
+            params.registerFeature("moisture-sources", [sensor](JsonObject& telemetryJson) {
+                sensor->populateSources(telemetryJson);
+            });
+            return sensor;
+        });
+}
+
+}    // namespace farmhub::peripherals::environment
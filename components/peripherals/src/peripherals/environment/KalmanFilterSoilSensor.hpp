@@ -2,8 +2,11 @@
 
 #include <chrono>
 #include <memory>
+#include <optional>
 
+#include <Concurrent.hpp>
 #include <Configuration.hpp>
+#include <Task.hpp>
 #include <peripherals/Peripheral.hpp>
 #include <peripherals/api/ISoilMoistureSensor.hpp>
 #include <peripherals/api/ITemperatureSensor.hpp>
@@ -30,7 +33,10 @@ public:
     Property<double> initialBeta { this, "initialBeta", 0.0 };
     Property<Celsius> tempRef { this, "tempRef", 20.0 };
 
-    // Process noise
+    // How often to sample the sensors and update the filter, independent of how often it is read
+    Property<seconds> updateInterval { this, "updateInterval", 1min };
+
+    // Process noise, accumulated per update interval
     Property<double> qMoist { this, "qMoist", 1e-5 };
     Property<double> qBeta { this, "qBeta", 1e-6 };
 
@@ -42,14 +48,34 @@ public:
     Property<seconds> sensitivePeriod { this, "sensitivePeriod", 15min };
 };
 
+/**
+ * @brief The filter's latest estimate.
+ */
+struct KalmanSoilEstimate {
+    Percent moisture = NAN;
+    double moistureVariance = NAN;
+    double beta = NAN;
+    double betaVariance = NAN;
+    /**
+     * @brief When the estimate was last updated, the epoch if it never was.
+     */
+    steady_clock::time_point updatedAt;
+};
+
+/**
+ * @brief Updates the filter on its own fixed schedule, readers only get a snapshot of the estimate.
+ *
+ * Steps that had to be skipped because of a failed reading are accounted for by letting the
+ * process noise accumulate over the longer time step.
+ */
 class KalmanFilterSoilSensor
     : public api::ISoilMoistureSensor,
       public Peripheral {
 public:
     KalmanFilterSoilSensor(
         const std::string& name,
-        const std::shared_ptr<api::ISoilMoistureSensor>& rawMoistureSensor,
-        const std::shared_ptr<api::ITemperatureSensor>& tempSensor,
+        InstanceRef<api::ISoilMoistureSensor> rawMoistureSensor,
+        InstanceRef<api::ITemperatureSensor> tempSensor,
         Percent initialMoisture,
         double initialBeta,
         Celsius tempRef,
@@ -57,7 +83,8 @@ public:
         double qBeta,
         double rSensitive,
         double rNormal,
-        seconds sensitivePeriod)
+        seconds sensitivePeriod,
+        seconds updateInterval)
         : Peripheral(name)
         , kalmanFilter(initialMoisture, initialBeta, tempRef)
         , rawMoistureSensor(rawMoistureSensor)
@@ -75,7 +102,8 @@ public:
              ", reference temp.: %.1f C"
              ", process noise: %.2e (moisture) / %.2e (beta)"
              ", measurement noise: %.2e (sensitive) / %.2e (normal)"
-             ", sensitive period: %lld s",
+             ", sensitive period: %lld s"
+             ", update interval: %lld s",
             name.c_str(),
             rawMoistureSensor->getName().c_str(),
             tempSensor->getName().c_str(),
@@ -84,43 +112,73 @@ public:
             tempRef,
             qMoist, qBeta,
             rSensitive, rNormal,
-            duration_cast<seconds>(sensitivePeriod).count());
+            duration_cast<seconds>(sensitivePeriod).count(),
+            updateInterval.count());
+
+        Task::loop(name, 3072, [this, updateInterval, lastUpdate = std::optional<steady_clock::time_point>()](Task& task) mutable {
+            auto now = steady_clock::now();
+            // Process noise is given per update interval
+            double dt = lastUpdate.has_value()
+                ? duration<double>(now - *lastUpdate) / duration<double>(updateInterval)
+                : 1.0;
+            if (updateFilter(now, dt)) {
+                lastUpdate = now;
+            }
+            task.delayUntil(updateInterval);
+        });
     }
 
     Percent getMoisture() override {
+        Lock lock(estimateMutex);
+        return estimate.moisture;
+    }
+
+    KalmanSoilEstimate getEstimate() {
+        Lock lock(estimateMutex);
+        return estimate;
+    }
+
+private:
+    bool updateFilter(steady_clock::time_point now, double dt) {
         auto rawMoisture = rawMoistureSensor->getMoisture();
         if (std::isnan(rawMoisture)) {
             LOGTW(ENV, "Raw moisture reading is NaN");
-            return NAN;
+            return false;
         }
         auto temp = tempSensor->getTemperature();
         if (std::isnan(temp)) {
             LOGTW(ENV, "Temperature reading is NaN");
-            return NAN;
+            return false;
         }
 
-        auto r = (steady_clock::now() < sensitivePeriodEnd) ? rSensitive : rNormal;
-        kalmanFilter.update(rawMoisture, temp, qMoist, qBeta, r);
-        auto realMoisture = kalmanFilter.getMoistReal();
-        LOGTV(ENV, "Updated Kalman filter with raw moisture: %.1f%%, temperature: %.1f C, real moisture: %.1f%%, beta: %.2f %%/C",
-            rawMoisture, temp, realMoisture, kalmanFilter.getBeta());
-        return realMoisture;
+        auto r = (now < sensitivePeriodEnd) ? rSensitive : rNormal;
+        kalmanFilter.update(rawMoisture, temp, qMoist, qBeta, r, dt);
+        KalmanSoilEstimate updated {
+            .moisture = kalmanFilter.getMoistReal(),
+            .moistureVariance = kalmanFilter.getMoistVariance(),
+            .beta = kalmanFilter.getBeta(),
+            .betaVariance = kalmanFilter.getBetaVariance(),
+            .updatedAt = now,
+        };
+        LOGTV(ENV, "Updated Kalman filter with raw moisture: %.1f%%, temperature: %.1f C, dt: %.2f, real moisture: %.1f%%, beta: %.2f %%/C",
+            rawMoisture, temp, dt, updated.moisture, updated.beta);
+        Lock lock(estimateMutex);
+        estimate = updated;
+        return true;
     }
 
-    double getBeta() {
-        return kalmanFilter.getBeta();
-    }
-
-private:
     MoistureKalmanFilter kalmanFilter;
-    std::shared_ptr<api::ISoilMoistureSensor> rawMoistureSensor;
-    std::shared_ptr<api::ITemperatureSensor> tempSensor;
+    InstanceRef<api::ISoilMoistureSensor> rawMoistureSensor;
+    InstanceRef<api::ITemperatureSensor> tempSensor;
 
     double qMoist;
     double qBeta;
     double rSensitive;
     double rNormal;
     std::chrono::steady_clock::time_point sensitivePeriodEnd;
+
+    Mutex estimateMutex;
+    KalmanSoilEstimate estimate;
 };
 
 inline PeripheralFactory makeFactoryForKalmanSoilMoisture() {
@@ -128,8 +186,8 @@ inline PeripheralFactory makeFactoryForKalmanSoilMoisture() {
         "environment:kalman-soil-moisture",
         "environment",
         [](PeripheralInitParameters& params, const std::shared_ptr<KalmanFilterSoilSensorSettings>& settings) {
-            auto rawMoistureSensor = params.peripheral<api::ISoilMoistureSensor>(settings->rawMoistureSensor.get());
-            auto tempSensor = params.peripheral<api::ITemperatureSensor>(settings->temperatureSensor.get());
+            auto rawMoistureSensor = params.resolvePeripheral<api::ISoilMoistureSensor>(settings->rawMoistureSensor.get());
+            auto tempSensor = params.resolvePeripheral<api::ITemperatureSensor>(settings->temperatureSensor.get());
             auto sensor = std::make_shared<KalmanFilterSoilSensor>(
                 params.name,
                 rawMoistureSensor,
@@ -141,12 +199,20 @@ inline PeripheralFactory makeFactoryForKalmanSoilMoisture() {
                 settings->qBeta.get(),
                 settings->rSensitive.get(),
                 settings->rNormal.get(),
-                settings->sensitivePeriod.get());
+                settings->sensitivePeriod.get(),
+                settings->updateInterval.get());
             params.registerFeature("moisture", [sensor](JsonObject& telemetryJson) {
-                telemetryJson["value"] = sensor->getMoisture();
+                auto estimate = sensor->getEstimate();
+                telemetryJson["value"] = estimate.moisture;
+                if (estimate.updatedAt != steady_clock::time_point()) {
+                    telemetryJson["variance"] = estimate.moistureVariance;
+                    telemetryJson["age"] = duration_cast<seconds>(steady_clock::now() - estimate.updatedAt).count();
+                }
             });
             params.registerFeature("kalman-beta", [sensor](JsonObject& telemetryJson) {
-                telemetryJson["value"] = sensor->getBeta();
+                auto estimate = sensor->getEstimate();
+                telemetryJson["value"] = estimate.beta;
+                telemetryJson["variance"] = estimate.betaVariance;
             });
             return sensor;
         });
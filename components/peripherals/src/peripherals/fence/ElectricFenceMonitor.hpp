@@ -3,8 +3,11 @@
 #include <chrono>
 #include <list>
 
+#include <esp_timer.h>
+
 #include <Concurrent.hpp>
 #include <PulseCounter.hpp>
+#include <PulseTiming.hpp>
 #include <Telemetry.hpp>
 
 #include <peripherals/Peripheral.hpp>
@@ -26,6 +29,12 @@ class ElectricFenceMonitorSettings
 public:
     ArrayProperty<FencePinConfig> pins { this, "pins" };
     Property<seconds> measurementFrequency { this, "measurementFrequency", 10s };
+    // An interval this many times longer than usual means pulses went missing
+    Property<double> missingPulseFactor { this, "missingPulseFactor", 1.5 };
+    // Fraction of missing pulses above which the fence is considered degraded
+    Property<double> degradedRatio { this, "degradedRatio", 0.25 };
+    // How long the fence needs to be degraded (or healthy again) before we raise an alert
+    Property<seconds> alertAfter { this, "alertAfter", 30s };
 };
 
 class ElectricFenceMonitor final
@@ -34,6 +43,7 @@ public:
     ElectricFenceMonitor(
         const std::string& name,
         const std::shared_ptr<PulseCounterManager>& pulseCounterManager,
+        const std::shared_ptr<TelemetryPublisher>& telemetryPublisher,
         const std::shared_ptr<ElectricFenceMonitorSettings>& settings)
         : Peripheral(name) {
 
@@ -46,29 +56,55 @@ public:
         }
         LOGI("Initializing electric fence with pins %s", pinsDescription.c_str());
 
+        auto sustainedPeriods = static_cast<uint32_t>(settings->alertAfter.get() / EVALUATION_PERIOD);
         for (const auto& pinConfig : settings->pins.get()) {
             auto unit = pulseCounterManager->create({
                 .pin = pinConfig.pin,
+                .recordTimestamps = true,
+            });
+            pins.emplace_back(FencePin {
+                .voltage = pinConfig.voltage,
+                .counter = unit,
+                .analyzer = PulseIntervalAnalyzer(settings->missingPulseFactor.get()),
+                .detector = DegradationDetector(settings->degradedRatio.get(), sustainedPeriods),
             });
-            pins.emplace_back(pinConfig.voltage, unit);
         }
 
         auto measurementFrequency = settings->measurementFrequency.get();
-        Task::loop(name, 3072, [this, measurementFrequency](Task& task) {
-            uint16_t lastVoltage = 0;
+        Task::loop(name, 3072, [this, measurementFrequency, telemetryPublisher, lastMeasurement = steady_clock::now(), lastEvaluation = steady_clock::now()](Task& task) mutable {
+            auto now = steady_clock::now();
+            auto nowUs = esp_timer_get_time();
             for (auto& pin : pins) {
-                uint32_t count = pin.counter->reset();
+                while (auto timestamp = pin.counter->takeTimestamp()) {
+                    pin.analyzer.record(*timestamp);
+                }
+                pin.analyzer.checkSilence(nowUs);
+            }
 
-                if (count > 0) {
-                    lastVoltage = std::max(pin.voltage, lastVoltage);
-                    LOGV("Counted %" PRIu32 " pulses on pin %s (voltage: %dV)",
-                        count, pin.counter->getPin()->getName().c_str(), pin.voltage);
+            if (now - lastEvaluation >= EVALUATION_PERIOD) {
+                lastEvaluation = now;
+                if (evaluate()) {
+                    telemetryPublisher->requestTelemetryPublishing();
                 }
             }
-            this->lastVoltage = lastVoltage;
-            LOGV("Last voltage: %d",
-                lastVoltage);
-            task.delayUntil(measurementFrequency);
+
+            if (now - lastMeasurement >= measurementFrequency) {
+                lastMeasurement = now;
+                uint16_t lastVoltage = 0;
+                for (auto& pin : pins) {
+                    uint32_t count = pin.counter->reset();
+
+                    if (count > 0) {
+                        lastVoltage = std::max(pin.voltage, lastVoltage);
+                        LOGV("Counted %" PRIu32 " pulses on pin %s (voltage: %dV)",
+                            count, pin.counter->getPin()->getName().c_str(), pin.voltage);
+                    }
+                }
+                this->lastVoltage = lastVoltage;
+                LOGV("Last voltage: %d",
+                    lastVoltage);
+            }
+            task.delayUntil(ANALYSIS_PERIOD);
         });
     }
 
@@ -76,15 +112,75 @@ public:
         return lastVoltage.load();
     }
 
+    void populateTelemetry(JsonObject& telemetryJson) {
+        Lock lock(statsMutex);
+        telemetryJson["degraded"] = degraded;
+        auto pinsJson = telemetryJson["pins"].to<JsonArray>();
+        for (auto& pin : pins) {
+            auto pinJson = pinsJson.add<JsonObject>();
+            pinJson["voltage"] = pin.voltage;
+            pinJson["pulses"] = std::exchange(pin.reported.pulses, 0);
+            pinJson["missed"] = std::exchange(pin.reported.missed, 0);
+            pinJson["dropped"] = pin.counter->takeDroppedTimestamps();
+            pinJson["interval"] = pin.reported.meanIntervalUs / 1000.0;
+            pinJson["min-interval"] = pin.reported.minIntervalUs / 1000.0;
+            pinJson["max-interval"] = pin.reported.maxIntervalUs / 1000.0;
+            pinJson["jitter"] = pin.reported.jitterUs / 1000.0;
+            pinJson["degraded"] = pin.detector.isDegraded();
+        }
+    }
+
 private:
+    /**
+     * @brief How often we take pulse timestamps from the counters; they can buffer a few dozen pulses.
+     */
+    static constexpr auto ANALYSIS_PERIOD = 1s;
+
+    /**
+     * @brief How often we judge whether the fence is degraded.
+     */
+    static constexpr auto EVALUATION_PERIOD = 5s;
+
+    /**
+     * @brief Evaluate the health of each pin, returning true if the fence changed state.
+     */
+    bool evaluate() {
+        Lock lock(statsMutex);
+        bool anyDegraded = false;
+        for (auto& pin : pins) {
+            auto stats = pin.analyzer.takeStats();
+            if (auto change = pin.detector.evaluate(stats.pulses, stats.missed)) {
+                LOGW("Electric fence pin %s (%dV) is %s, missed %" PRIu32 " of %" PRIu32 " pulses",
+                    pin.counter->getPin()->getName().c_str(), pin.voltage,
+                    *change ? "degraded" : "healthy again", stats.missed, stats.pulses + stats.missed);
+            }
+            anyDegraded |= pin.detector.isDegraded();
+
+            pin.reported.pulses += stats.pulses;
+            pin.reported.missed += stats.missed;
+            pin.reported.meanIntervalUs = stats.meanIntervalUs;
+            pin.reported.minIntervalUs = stats.minIntervalUs;
+            pin.reported.maxIntervalUs = stats.maxIntervalUs;
+            pin.reported.jitterUs = stats.jitterUs;
+        }
+        return std::exchange(degraded, anyDegraded) != anyDegraded;
+    }
+
     std::atomic<uint16_t> lastVoltage { 0 };
 
     struct FencePin {
         uint16_t voltage;
         std::shared_ptr<PulseCounter> counter;
+        PulseIntervalAnalyzer analyzer;
+        DegradationDetector detector;
+        // Accumulated since the last telemetry publish
+        PulseIntervalStats reported {};
     };
 
     std::list<FencePin> pins;
+
+    Mutex statsMutex;
+    bool degraded = false;
 };
 
 inline PeripheralFactory makeFactory() {
@@ -95,10 +191,14 @@ inline PeripheralFactory makeFactory() {
             auto monitor = std::make_shared<ElectricFenceMonitor>(
                 params.name,
                 params.services.pulseCounterManager,
+                params.services.telemetryPublisher,
                 settings);
             params.registerFeature("voltage", [monitor](JsonObject& telemetryJson) {
                 telemetryJson["value"] = monitor->getVoltage();
             });
+            params.registerFeature("fence", [monitor](JsonObject& telemetryJson) {
+                monitor->populateTelemetry(telemetryJson);
+            });
             return monitor;
         });
 }
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include <Configuration.hpp>
@@ -44,24 +45,58 @@ public:
         return measurementFrequency;
     }
 
+    void requestMeasurements(milliseconds duration) override {
+        bool wasIdle;
+        {
+            Lock lock(updateAverageMutex);
+            wasIdle = isIdle();
+            measureUntil = std::max(measureUntil.value_or(steady_clock::time_point {}), steady_clock::now() + duration);
+        }
+        if (wasIdle) {
+            LOGV("Light sensor '%s' measuring for %lld ms",
+                name.c_str(), duration.count());
+            measurementTask.abortDelay();
+        }
+    }
+
 protected:
     virtual double readLightLevel() = 0;
 
     void runLoop() {
-        Task::loop(name, 3072, [this](Task& task) {
+        measurementTask = Task::loop(name, 3072, [this](Task& task) {
             auto currentLevel = readLightLevel();
+            bool idle;
             {
                 Lock lock(updateAverageMutex);
                 level.record(currentLevel);
+                idle = isIdle();
+            }
+            if (idle) {
+                // Woken early by requestMeasurements()
+                Task::delay(IDLE_MEASUREMENT_FREQUENCY);
+                task.markWakeTime();
+            } else {
+                task.delayUntil(measurementFrequency);
             }
-            task.delayUntil(measurementFrequency);
         });
     }
 
 private:
+    /**
+     * @brief Outside requested windows we still measure now and then, so telemetry isn't completely stale.
+     */
+    static constexpr seconds IDLE_MEASUREMENT_FREQUENCY = 15min;
+
+    bool isIdle() const {
+        return measureUntil.has_value() && steady_clock::now() >= *measureUntil;
+    }
+
     const seconds measurementFrequency;
     Mutex updateAverageMutex;
     MovingAverage<double> level;
+    // Unset until someone requests measurements, until then we measure continuously
+    std::optional<steady_clock::time_point> measureUntil;
+    TaskHandle measurementTask;
 };
 
 }    // namespace farmhub::peripherals::light_sensor
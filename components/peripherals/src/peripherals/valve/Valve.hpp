@@ -4,11 +4,13 @@
 #include <chrono>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 
 #include <ArduinoJson.h>
 
+#include <EnergyLedger.hpp>
 #include <Named.hpp>
 #include <NvsStore.hpp>
 #include <Task.hpp>
@@ -34,10 +36,14 @@ public:
     Valve(
         const std::string& name,
         std::unique_ptr<ValveControlStrategy> _strategy,
-        const std::shared_ptr<NvsStore>& nvs)
+        const std::shared_ptr<NvsStore>& nvs,
+        const std::shared_ptr<EnergyConsumer>& energy,
+        const std::shared_ptr<EnergyConsumer>& holdEnergy)
         : Peripheral(name)
         , nvs(nvs)
-        , strategy(std::move(_strategy)) {
+        , strategy(std::move(_strategy))
+        , energy(energy)
+        , holdEnergy(holdEnergy) {
 
         LOGI("Creating valve '%s' with strategy %s",
             name.c_str(), strategy->describe().c_str());
@@ -85,6 +91,13 @@ public:
     // Allow graceful shutdown
     void shutdown(const ShutdownParameters& /*params*/) override {
         closeBeforeShutdown();
+        // Whatever the valve is held at, we are not around to account for it
+        holding.reset();
+    }
+
+    milliseconds getShutdownEstimate() const override {
+        // Driving the motor, plus persisting the state
+        return strategy->getCloseDuration() + STATE_PERSIST_ESTIMATE;
     }
 
     bool transitionTo(std::optional<TargetState> target) override {
@@ -98,19 +111,25 @@ public:
 private:
     void open() {
         LOGI("Opening valve '%s'", name.c_str());
+        holding.reset();
         {
             PowerManagementLockGuard sleepLock(PowerManager::noLightSleep);
+            EnergyActivity activity(energy);
             strategy->open();
         }
+        holdIfNeeded(TargetState::Open);
         setState(ValveState::Open);
     }
 
     void close() {
         LOGI("Closing valve '%s'", name.c_str());
+        holding.reset();
         {
             PowerManagementLockGuard sleepLock(PowerManager::noLightSleep);
+            EnergyActivity activity(energy);
             strategy->close();
         }
+        holdIfNeeded(TargetState::Closed);
         setState(ValveState::Closed);
     }
 
@@ -138,6 +157,15 @@ private:
         }
     }
 
+    /**
+     * @brief Account for the motor being kept driven after the switch, until the next transition.
+     */
+    void holdIfNeeded(TargetState state) {
+        if (strategy->getHoldDuty(state) > 0.0) {
+            holding.emplace(holdEnergy);
+        }
+    }
+
     void setState(ValveState state) {
         this->state = state;
         if (!nvs->set(name, state)) {
@@ -146,8 +174,16 @@ private:
         }
     }
 
+    /**
+     * @brief Typical time it takes to write the state to NVS.
+     */
+    static constexpr milliseconds STATE_PERSIST_ESTIMATE = 50ms;
+
     const std::shared_ptr<NvsStore> nvs;
     const std::unique_ptr<ValveControlStrategy> strategy;
+    const std::shared_ptr<EnergyConsumer> energy;
+    const std::shared_ptr<EnergyConsumer> holdEnergy;
+    std::optional<EnergyActivity> holding;
     ValveState state = ValveState::None;
 };
 
@@ -28,6 +28,18 @@ public:
     virtual void close() = 0;
     virtual TargetState getDefaultState() const = 0;
 
+    /**
+     * @brief How long `close()` takes to return.
+     */
+    virtual milliseconds getCloseDuration() const = 0;
+
+    /**
+     * @brief Duty the motor is kept driven at after reaching the given state, zero if it is left alone.
+     */
+    virtual double getHoldDuty(TargetState /*state*/) const {
+        return 0.0;
+    }
+
     virtual std::string describe() const = 0;
 };
 
@@ -97,6 +109,14 @@ public:
         return TargetState::Closed;
     }
 
+    milliseconds getCloseDuration() const override {
+        return 0ms;
+    }
+
+    double getHoldDuty(TargetState state) const override {
+        return state == TargetState::Open ? holdDuty : 0.0;
+    }
+
     std::string describe() const override {
         return "normally closed with switch duration " + std::to_string(switchDuration.count()) + " ms and hold duty " + std::to_string(holdDuty * 100) + "%";
     }
@@ -121,6 +141,14 @@ public:
         return TargetState::Open;
     }
 
+    milliseconds getCloseDuration() const override {
+        return switchDuration;
+    }
+
+    double getHoldDuty(TargetState state) const override {
+        return state == TargetState::Closed ? holdDuty : 0.0;
+    }
+
     std::string describe() const override {
         return "normally open with switch duration " + std::to_string(switchDuration.count()) + " ms and hold duty " + std::to_string(holdDuty * 100) + "%";
     }
@@ -151,6 +179,10 @@ public:
         return TargetState::Closed;
     }
 
+    milliseconds getCloseDuration() const override {
+        return switchDuration;
+    }
+
     std::string describe() const override {
         return "latching with switch duration " + std::to_string(switchDuration.count()) + " ms and switch duty " + std::to_string(switchDuty * 100) + "%";
     }
@@ -180,6 +212,10 @@ public:
         return TargetState::Closed;
     }
 
+    milliseconds getCloseDuration() const override {
+        return 0ms;
+    }
+
     std::string describe() const override {
         return "latching with pin " + pin->getName();
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <list>
 #include <memory>
@@ -27,6 +28,11 @@ using namespace farmhub::peripherals::api;
 
 namespace farmhub::peripherals::valve {
 
+/**
+ * @brief Typical current draw of a valve motor while switching, in mA.
+ */
+static constexpr double VALVE_MOTOR_CURRENT = 300.0;
+
 inline PeripheralFactory makeFactory(
     const std::map<std::string, std::shared_ptr<PwmMotorDriver>>& motors,
     ValveControlStrategyType defaultStrategy) {
@@ -36,10 +42,17 @@ inline PeripheralFactory makeFactory(
         "valve",
         [motors](PeripheralInitParameters& params, const std::shared_ptr<ValveSettings>& settings) {
             auto strategy = settings->createValveControlStrategy(motors, settings->motor.get());
+            // Normally open and closed valves keep the motor driven at a lower duty in one of their states
+            auto holdDuty = std::max(strategy->getHoldDuty(TargetState::Open), strategy->getHoldDuty(TargetState::Closed));
+            auto holdEnergy = holdDuty > 0.0
+                ? params.services.energy->registerConsumer("valve:" + params.name + ":hold", VALVE_MOTOR_CURRENT * holdDuty)
+                : nullptr;
             auto valve = std::make_shared<Valve>(
                 params.name,
                 std::move(strategy),
-                params.services.nvs);
+                params.services.nvs,
+                params.services.energy->registerConsumer("valve:" + params.name, VALVE_MOTOR_CURRENT),
+                holdEnergy);
 
             params.registerFeature("valve", [valve](JsonObject& telemetry) {
                 valve->populateTelemetry(telemetry);
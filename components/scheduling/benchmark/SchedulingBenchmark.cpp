@@ -0,0 +1,62 @@
+#include <chrono>
+#include <list>
+#include <memory>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <FakeLog.hpp>
+
+#include <scheduling/Fakes.hpp>
+#include <scheduling/MoistureBasedScheduler.hpp>
+#include <scheduling/MoistureKalmanFilter.hpp>
+#include <scheduling/TimeBasedScheduler.hpp>
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+using namespace farmhub::utils::scheduling;
+
+TEST_CASE("moisture based scheduler", "[benchmark][scheduling]") {
+    BENCHMARK_ADVANCED("tick")(Catch::Benchmark::Chronometer meter) {
+        auto clock = std::make_shared<FakeClock>();
+        auto flowMeter = std::make_shared<FakeFlowMeter>();
+        auto moistureSensor = std::make_shared<FakeSoilMoistureSensor>();
+        MoistureBasedScheduler<FakeClock> scheduler({}, clock, flowMeter, moistureSensor);
+        scheduler.setTarget(MoistureTarget { .low = 60, .high = 80 });
+        meter.measure([&](int i) {
+            // Keep moisture hovering around the low end of the target to exercise watering decisions
+            moistureSensor->moisture = 58.0 + (i % 8) * 0.5;
+            flowMeter->bucket += 0.1;
+            clock->advance(5s);
+            return scheduler.tick();
+        });
+    };
+}
+
+TEST_CASE("moisture Kalman filter", "[benchmark][scheduling]") {
+    BENCHMARK_ADVANCED("update")(Catch::Benchmark::Chronometer meter) {
+        MoistureKalmanFilter filter(60.0, 0.0, 20.0);
+        meter.measure([&](int i) {
+            filter.update(60.0 + (i % 10) * 0.01, 18.0 + (i % 7) * 0.5, 1e-4, 1e-6, 0.04);
+            return filter.getMoistReal();
+        });
+    };
+}
+
+TEST_CASE("time based scheduler", "[benchmark][scheduling]") {
+    auto start = system_clock::from_time_t(1760000000);
+    std::list<TimeBasedSchedule> schedules {
+        { .start = start, .period = 24h, .duration = 15min },
+        { .start = start + 6h, .period = 24h, .duration = 10min },
+        { .start = start + 12h, .period = 24h, .duration = 15min },
+        { .start = start + 18h, .period = 24h, .duration = 10min },
+    };
+    auto now = start + 30 * 24h + 7h;
+
+    BENCHMARK("get state update with no schedules") {
+        return TimeBasedScheduler::getStateUpdate({}, now);
+    };
+    BENCHMARK("get state update with four daily schedules") {
+        return TimeBasedScheduler::getStateUpdate(schedules, now);
+    };
+}
@@ -50,15 +50,19 @@ struct LightSensorScheduler : IScheduler {
         }
         const auto& target = *this->target;
 
+        // Keep the sensor measuring, in case it was only asked to measure around sunrise and sunset before
+        lightSensor->requestMeasurements(CHECK_INTERVAL * 2);
         auto targetState = calculateTargetState(lightSensor->getLightLevel(), target);
         return {
             .targetState = targetState,
-            .nextDeadline = 1min,
+            .nextDeadline = CHECK_INTERVAL,
             .shouldPublishTelemetry = false,
         };
     }
 
 private:
+    static constexpr ms CHECK_INTERVAL = 1min;
+
     static std::optional<TargetState> calculateTargetState(Lux lightLevel, const LightSensorSchedule& target) {
         if (lightLevel >= target.open) {
             return TargetState::Open;
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace farmhub::utils::scheduling {
+
+enum class MoistureSourceState : uint8_t {
+    Unknown,
+    Ok,
+    Outlier,
+    Failed,
+};
+
+inline const char* toString(MoistureSourceState state) {
+    switch (state) {
+        case MoistureSourceState::Ok:
+            return "ok";
+        case MoistureSourceState::Outlier:
+            return "outlier";
+        case MoistureSourceState::Failed:
+            return "failed";
+        default:
+            return "unknown";
+    }
+}
+
+struct MoistureSourceHealth {
+    MoistureSourceState state = MoistureSourceState::Unknown;
+    /**
+     * @brief Last reading, temperature compensated.
+     */
+    double value = NAN;
+    /**
+     * @brief Estimated noise variance of the source, in percent squared.
+     */
+    double variance;
+    uint32_t readings = 0;
+    uint32_t outliers = 0;
+    uint32_t failures = 0;
+};
+
+/**
+ * @brief Combines readings of several soil moisture sensors into a single value.
+ *
+ * Each batch of readings is compensated for temperature, then readings too far from the median
+ * are rejected as outliers, with "too far" measured in median absolute deviations. The rest are
+ * averaged, weighted by the inverse of each source's estimated noise variance. The variance is
+ * tracked as an exponential moving average of the squared difference from the fused value, so
+ * sources that keep disagreeing with the others gradually lose their say.
+ */
+class MoistureFusion {
+public:
+    struct Config {
+        /**
+         * @brief How many median absolute deviations a reading can be from the median.
+         */
+        double outlierThreshold = 3.0;
+        /**
+         * @brief Readings closer than this to the median are never outliers, in percent.
+         */
+        double minOutlierDeviation = 5.0;
+        /**
+         * @brief Change of the reading per degree Celsius, due to the temperature alone.
+         */
+        double temperatureCoefficient = 0.0;
+        double temperatureRef = 20.0;
+        double initialVariance = 4.0;
+        /**
+         * @brief Variance never goes below this, so that no single source can take over.
+         */
+        double minVariance = 0.25;
+        /**
+         * @brief Weight of the latest squared deviation in the variance estimate.
+         */
+        double varianceAlpha = 0.1;
+    };
+
+    MoistureFusion(size_t sourceCount, Config config)
+        : config(config)
+        , sources(sourceCount, MoistureSourceHealth { .variance = config.initialVariance }) {
+    }
+
+    /**
+     * @brief Fuse a batch of readings, one per source, NaN for failed readings.
+     *
+     * @param temperature the soil temperature, or NaN if not known; no compensation happens then.
+     * @return the fused moisture, or NaN if no source provided a usable reading.
+     */
+    double fuse(std::span<const double> readings, double temperature = NAN) {
+        valid.clear();
+        for (size_t i = 0; i < sources.size(); i++) {
+            auto& source = sources[i];
+            source.readings++;
+            double reading = i < readings.size() ? readings[i] : NAN;
+            if (std::isnan(reading)) {
+                source.state = MoistureSourceState::Failed;
+                source.value = NAN;
+                source.failures++;
+                continue;
+            }
+            if (!std::isnan(temperature)) {
+                reading -= config.temperatureCoefficient * (temperature - config.temperatureRef);
+            }
+            source.state = MoistureSourceState::Ok;
+            source.value = reading;
+            valid.push_back(reading);
+        }
+        if (valid.empty()) {
+            return NAN;
+        }
+
+        double median = medianOf(valid);
+        for (auto& value : valid) {
+            value = std::abs(value - median);
+        }
+        // Scaled so that it estimates the standard deviation for normally distributed readings
+        double deviation = 1.4826 * medianOf(valid);
+        double maxDistance = std::max(config.outlierThreshold * deviation, config.minOutlierDeviation);
+
+        double weightedSum = 0;
+        double totalWeight = 0;
+        for (auto& source : sources) {
+            if (source.state == MoistureSourceState::Failed) {
+                continue;
+            }
+            if (std::abs(source.value - median) > maxDistance) {
+                source.state = MoistureSourceState::Outlier;
+                source.outliers++;
+                continue;
+            }
+            double weight = 1.0 / source.variance;
+            weightedSum += weight * source.value;
+            totalWeight += weight;
+        }
+        double fused = weightedSum / totalWeight;
+
+        for (auto& source : sources) {
+            if (source.state == MoistureSourceState::Ok) {
+                double error = source.value - fused;
+                source.variance = std::max(config.minVariance,
+                    ((1 - config.varianceAlpha) * source.variance) + (config.varianceAlpha * error * error));
+            }
+        }
+        return fused;
+    }
+
+    const std::vector<MoistureSourceHealth>& getSources() const {
+        return sources;
+    }
+
+private:
+    static double medianOf(std::vector<double>& values) {
+        auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+        std::nth_element(values.begin(), middle, values.end());
+        if (values.size() % 2 == 1) {
+            return *middle;
+        }
+        return (*middle + *std::max_element(values.begin(), middle)) / 2;
+    }
+
+    const Config config;
+    std::vector<MoistureSourceHealth> sources;
+    // Scratch space, kept to avoid allocating on every batch
+    std::vector<double> valid;
+};
+
+}    // namespace farmhub::utils::scheduling
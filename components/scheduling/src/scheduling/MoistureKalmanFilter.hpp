@@ -33,19 +33,21 @@ public:
     /// @brief Update filter with new observation
     /// @param moistObserved measured soil moisture (sensor)
     /// @param temp measured soil temperature
-    /// @param qMoist process noise for moistReal (slow drift, higher during watering)
-    /// @param qBeta process noise for beta (usually tiny)
+    /// @param qMoist process noise for moistReal per unit of time (slow drift, higher during watering)
+    /// @param qBeta process noise for beta per unit of time (usually tiny)
     /// @param R measurement noise variance
+    /// @param dt time since the previous update, in the same unit as the process noise
     void update(double moistObserved,
         double temp,
         double qMoist,
         double qBeta,
-        double R) {
+        double R,
+        double dt = 1.0) {
 
         // Predict step: state does not change (identity transition)
-        // Add process noise
-        P[0][0] += qMoist;
-        P[1][1] += qBeta;
+        // Add process noise, accumulated over the time passed
+        P[0][0] += qMoist * dt;
+        P[1][1] += qBeta * dt;
 
         // Observation model: H = [1, temp - tempRef]
         const double h0 = 1.0;
@@ -111,6 +113,14 @@ public:
     [[nodiscard]] double getBeta() const noexcept {
         return beta;
     }
+    /// @brief Variance of the moisture estimate
+    [[nodiscard]] double getMoistVariance() const noexcept {
+        return P[0][0];
+    }
+    /// @brief Variance of the temperature sensitivity estimate
+    [[nodiscard]] double getBetaVariance() const noexcept {
+        return P[1][1];
+    }
     [[nodiscard]] double getTempRef() const noexcept {
         return tempRef;
     }
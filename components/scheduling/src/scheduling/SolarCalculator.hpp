@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+using namespace std::chrono;
+
+namespace farmhub::utils::scheduling {
+
+enum class Twilight : uint8_t {
+    /**
+     * @brief The upper edge of the sun crosses the horizon, accounting for refraction.
+     */
+    Official,
+    /**
+     * @brief The center of the sun is 6 degrees below the horizon; it's light enough to see outside.
+     */
+    Civil,
+};
+
+struct SolarEvents {
+    enum class Kind : uint8_t {
+        Normal,
+        // The sun doesn't set on this day
+        AlwaysUp,
+        // The sun doesn't rise on this day
+        AlwaysDown,
+    };
+
+    Kind kind;
+    // Only valid for normal days
+    system_clock::time_point rise;
+    system_clock::time_point set;
+};
+
+/**
+ * @brief Sunrise and sunset from coordinates alone, using the sunrise equation NOAA's calculator is based on.
+ *
+ * Days are counted from the J2000 epoch in local solar time, so that a day holds a single
+ * sunrise and sunset. Results are within a minute or two of the published tables, less precise
+ * close to the polar circles, which is plenty to open a door by.
+ */
+class SolarCalculator {
+public:
+    /**
+     * @brief The solar day whose noon is closest to the given time at the given longitude (positive east).
+     */
+    static int64_t dayOf(system_clock::time_point time, double longitude) {
+        return std::llround(toJulianDate(time) - J2000 + longitude / 360.0);
+    }
+
+    static SolarEvents calculate(int64_t day, double latitude, double longitude, Twilight twilight) {
+        double meanSolarTime = static_cast<double>(day) + 0.0008 - longitude / 360.0;
+        double meanAnomaly = normalizeDegrees(357.5291 + 0.98560028 * meanSolarTime);
+        double m = toRadians(meanAnomaly);
+        double center = 1.9148 * std::sin(m) + 0.0200 * std::sin(2 * m) + 0.0003 * std::sin(3 * m);
+        double eclipticLongitude = toRadians(normalizeDegrees(meanAnomaly + center + 180.0 + 102.9372));
+        double transit = J2000 + meanSolarTime + 0.0053 * std::sin(m) - 0.0069 * std::sin(2 * eclipticLongitude);
+
+        double sinDeclination = std::sin(eclipticLongitude) * std::sin(toRadians(AXIAL_TILT));
+        double cosDeclination = std::cos(std::asin(sinDeclination));
+        double phi = toRadians(latitude);
+        double cosHourAngle = (std::sin(toRadians(horizonFor(twilight))) - std::sin(phi) * sinDeclination)
+            / (std::cos(phi) * cosDeclination);
+        if (cosHourAngle < -1.0) {
+            return { .kind = SolarEvents::Kind::AlwaysUp, .rise = {}, .set = {} };
+        }
+        if (cosHourAngle > 1.0) {
+            return { .kind = SolarEvents::Kind::AlwaysDown, .rise = {}, .set = {} };
+        }
+        double halfDay = std::acos(cosHourAngle) / (2 * std::numbers::pi);
+        return {
+            .kind = SolarEvents::Kind::Normal,
+            .rise = fromJulianDate(transit - halfDay),
+            .set = fromJulianDate(transit + halfDay),
+        };
+    }
+
+private:
+    static constexpr double J2000 = 2451545.0;
+    static constexpr double UNIX_EPOCH = 2440587.5;
+    static constexpr double SECONDS_PER_DAY = 86400.0;
+    static constexpr double AXIAL_TILT = 23.4397;
+
+    static constexpr double horizonFor(Twilight twilight) {
+        switch (twilight) {
+            case Twilight::Civil:
+                return -6.0;
+            case Twilight::Official:
+            default:
+                return -0.833;
+        }
+    }
+
+    static double toJulianDate(system_clock::time_point time) {
+        return UNIX_EPOCH + duration<double>(time.time_since_epoch()).count() / SECONDS_PER_DAY;
+    }
+
+    static system_clock::time_point fromJulianDate(double julianDate) {
+        return system_clock::time_point(duration_cast<system_clock::duration>(
+            duration<double>((julianDate - UNIX_EPOCH) * SECONDS_PER_DAY)));
+    }
+
+    static double normalizeDegrees(double degrees) {
+        double result = std::fmod(degrees, 360.0);
+        return result < 0 ? result + 360.0 : result;
+    }
+
+    static constexpr double toRadians(double degrees) {
+        return degrees * std::numbers::pi / 180.0;
+    }
+};
+
+}    // namespace farmhub::utils::scheduling
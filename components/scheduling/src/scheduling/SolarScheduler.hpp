@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include <utils/Chrono.hpp>
+
+#include <peripherals/api/ILightSensor.hpp>
+
+#include "IScheduler.hpp"
+#include "LightSensorScheduler.hpp"
+#include "SolarCalculator.hpp"
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+using namespace farmhub::peripherals::api;
+
+namespace farmhub::utils::scheduling {
+
+struct SolarSchedule {
+    // Degrees, positive north
+    double latitude;
+    // Degrees, positive east
+    double longitude;
+    Twilight twilight;
+    // Shift opening and closing relative to sunrise and sunset
+    seconds openOffset;
+    seconds closeOffset;
+    // Let the light sensor decide this close to the predicted transition; zero to rely on the sun alone
+    seconds lightWindow;
+    LightSensorSchedule light;
+};
+
+/**
+ * @brief Opens at sunrise and closes at sunset, as calculated from the coordinates and the clock.
+ *
+ * With a light sensor and a light window configured, the sensor decides within the window around
+ * each predicted transition, so an overcast morning can delay opening, and it is asked to measure
+ * only during those windows. Outside the windows, and at their end, the sun decides.
+ */
+class SolarScheduler : public IScheduler {
+public:
+    /**
+     * @param lightSensor the sensor to refine the transitions with, or nullptr to use the sun alone.
+     */
+    SolarScheduler(const std::shared_ptr<ILightSensor>& lightSensor)
+        : lightSensor(lightSensor) {
+    }
+
+    void setTarget(std::optional<SolarSchedule> target) {
+        if (target) {
+            LOGTD(SCHEDULING, "SolarScheduler: Setting target: lat=%.4f, lon=%.4f, %s twilight, offsets: open=%lld s, close=%lld s, light window: %lld s",
+                target->latitude, target->longitude,
+                target->twilight == Twilight::Civil ? "civil" : "official",
+                target->openOffset.count(), target->closeOffset.count(),
+                target->lightWindow.count());
+        } else {
+            LOGTD(SCHEDULING, "SolarScheduler: Clearing target");
+        }
+        this->target = target;
+        inLightWindow = false;
+    }
+
+    const char* getName() const override {
+        return "solar";
+    }
+
+    ScheduleResult tick() override {
+        return tick(system_clock::now());
+    }
+
+    ScheduleResult tick(system_clock::time_point now) {
+        if (!target) {
+            return {
+                .targetState = {},
+                .nextDeadline = {},
+                .shouldPublishTelemetry = false,
+            };
+        }
+        if (now < EARLIEST_VALID_TIME) {
+            // Wait for the clock to be synced
+            return {
+                .targetState = {},
+                .nextDeadline = 1min,
+                .shouldPublishTelemetry = false,
+            };
+        }
+        const auto& target = *this->target;
+
+        auto day = SolarCalculator::dayOf(now, target.longitude);
+        auto today = SolarCalculator::calculate(day, target.latitude, target.longitude, target.twilight);
+        switch (today.kind) {
+            case SolarEvents::Kind::AlwaysUp:
+                return { .targetState = TargetState::Open, .nextDeadline = POLAR_RECHECK, .shouldPublishTelemetry = false };
+            case SolarEvents::Kind::AlwaysDown:
+                return { .targetState = TargetState::Closed, .nextDeadline = POLAR_RECHECK, .shouldPublishTelemetry = false };
+            case SolarEvents::Kind::Normal:
+                break;
+        }
+
+        // Look at the neighboring days, too, as offsets can push transitions across midnight
+        auto solarState = TargetState::Closed;
+        std::optional<system_clock::time_point> previousTransition;
+        std::optional<system_clock::time_point> nextTransition;
+        for (auto d = day - 1; d <= day + 1; d++) {
+            auto events = d == day
+                ? today
+                : SolarCalculator::calculate(d, target.latitude, target.longitude, target.twilight);
+            if (events.kind != SolarEvents::Kind::Normal) {
+                continue;
+            }
+            auto open = events.rise + target.openOffset;
+            auto close = events.set + target.closeOffset;
+            if (open <= now && now < close) {
+                solarState = TargetState::Open;
+            }
+            for (auto transition : { open, close }) {
+                if (transition <= now) {
+                    previousTransition = std::max(previousTransition.value_or(transition), transition);
+                } else {
+                    nextTransition = std::min(nextTransition.value_or(transition), transition);
+                }
+            }
+        }
+
+        auto untilNext = nextTransition
+            ? duration_cast<ms>(*nextTransition - now)
+            : duration_cast<ms>(POLAR_RECHECK);
+        if (lightSensor == nullptr || target.lightWindow <= 0s) {
+            return {
+                .targetState = solarState,
+                .nextDeadline = untilNext,
+                .shouldPublishTelemetry = false,
+            };
+        }
+
+        // Measure light in the window around the closest transition
+        std::optional<ms> windowLeft;
+        if (nextTransition && untilNext <= target.lightWindow) {
+            windowLeft = untilNext + target.lightWindow;
+        } else if (previousTransition && now - *previousTransition < target.lightWindow) {
+            windowLeft = duration_cast<ms>(*previousTransition + target.lightWindow - now);
+        }
+        if (!windowLeft) {
+            inLightWindow = false;
+            return {
+                .targetState = solarState,
+                .nextDeadline = untilNext - target.lightWindow,
+                .shouldPublishTelemetry = false,
+            };
+        }
+
+        lightSensor->requestMeasurements(*windowLeft);
+        if (!inLightWindow) {
+            // The sensor has only just started measuring, give it time before trusting it
+            inLightWindow = true;
+            return {
+                .targetState = solarState,
+                .nextDeadline = LIGHT_CHECK_INTERVAL,
+                .shouldPublishTelemetry = false,
+            };
+        }
+        auto lightLevel = lightSensor->getLightLevel();
+        std::optional<TargetState> lightState;
+        if (lightLevel >= target.light.open) {
+            lightState = TargetState::Open;
+        } else if (lightLevel <= target.light.close) {
+            lightState = TargetState::Closed;
+        }
+        return {
+            .targetState = lightState,
+            .nextDeadline = std::min(LIGHT_CHECK_INTERVAL, *windowLeft),
+            .shouldPublishTelemetry = false,
+        };
+    }
+
+private:
+    static constexpr ms LIGHT_CHECK_INTERVAL = 1min;
+    static constexpr ms POLAR_RECHECK = 1h;
+    // Anything before this means the clock is not set yet
+    static constexpr system_clock::time_point EARLIEST_VALID_TIME { 1'577'836'800s };    // 2020-01-01
+
+    const std::shared_ptr<ILightSensor> lightSensor;
+    std::optional<SolarSchedule> target;
+    bool inLightWindow = false;
+};
+
+}    // namespace farmhub::utils::scheduling
@@ -0,0 +1,75 @@
+#include <array>
+#include <cmath>
+#include <random>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <scheduling/MoistureFusion.hpp>
+
+using Catch::Approx;
+
+namespace farmhub::utils::scheduling {
+
+TEST_CASE("agreeing sources are averaged", "[fusion]") {
+    MoistureFusion fusion(3, {});
+    std::array readings { 40.0, 42.0, 44.0 };
+    REQUIRE(fusion.fuse(readings) == Approx(42.0));
+    for (const auto& source : fusion.getSources()) {
+        REQUIRE(source.state == MoistureSourceState::Ok);
+        REQUIRE(source.readings == 1);
+    }
+}
+
+TEST_CASE("a source far from the rest is rejected", "[fusion]") {
+    MoistureFusion fusion(4, {});
+    std::array readings { 40.0, 41.0, 42.0, 95.0 };
+    REQUIRE(fusion.fuse(readings) == Approx(41.0));
+    REQUIRE(fusion.getSources()[3].state == MoistureSourceState::Outlier);
+    REQUIRE(fusion.getSources()[3].outliers == 1);
+}
+
+TEST_CASE("failed readings are skipped", "[fusion]") {
+    MoistureFusion fusion(3, {});
+    std::array<double, 3> readings { NAN, 30.0, 34.0 };
+    REQUIRE(fusion.fuse(readings) == Approx(32.0));
+    REQUIRE(fusion.getSources()[0].state == MoistureSourceState::Failed);
+    REQUIRE(fusion.getSources()[0].failures == 1);
+
+    // Recovers with the next good reading
+    std::array next { 32.0, 30.0, 34.0 };
+    REQUIRE(fusion.fuse(next) == Approx(32.0));
+    REQUIRE(fusion.getSources()[0].state == MoistureSourceState::Ok);
+}
+
+TEST_CASE("no usable reading gives NaN", "[fusion]") {
+    MoistureFusion fusion(2, {});
+    std::array<double, 2> readings { NAN, NAN };
+    REQUIRE(std::isnan(fusion.fuse(readings)));
+}
+
+TEST_CASE("readings are compensated for temperature", "[fusion]") {
+    MoistureFusion fusion(2, { .temperatureCoefficient = 0.5, .temperatureRef = 20.0 });
+    std::array readings { 45.0, 45.0 };
+    REQUIRE(fusion.fuse(readings, 30.0) == Approx(40.0));
+    REQUIRE(fusion.fuse(readings, NAN) == Approx(45.0));
+}
+
+TEST_CASE("noisy sources lose weight", "[fusion]") {
+    MoistureFusion fusion(3, { .minOutlierDeviation = 20.0 });
+    std::mt19937 rng(42);
+    std::normal_distribution<double> quiet(0.0, 0.2);
+    std::normal_distribution<double> noisy(0.0, 6.0);
+    for (int i = 0; i < 200; i++) {
+        std::array readings { 50.0 + quiet(rng), 50.0 + quiet(rng), 50.0 + noisy(rng) };
+        fusion.fuse(readings);
+    }
+    const auto& sources = fusion.getSources();
+    REQUIRE(sources[2].variance > 10 * sources[0].variance);
+
+    // A large error from the noisy source barely moves the result
+    std::array readings { 50.0, 50.0, 65.0 };
+    REQUIRE(fusion.fuse(readings) == Approx(50.0).margin(1.0));
+}
+
+}    // namespace farmhub::utils::scheduling
@@ -166,4 +166,26 @@ TEST_CASE("tempRef usage: consistent estimates around chosen reference", "[kalma
     // so we don't compare beta directly here.
 }
 
+TEST_CASE("Longer time steps let the estimate move further", "[kalman][dt]") {
+    MoistureKalmanFilter shortStep(50.0, 0.0, 20.0);
+    MoistureKalmanFilter longStep(50.0, 0.0, 20.0);
+    MoistureKalmanFilter twoSteps(50.0, 0.0, 20.0);
+
+    const double qMoist = 1e-2;
+    const double qBeta = 1e-6;
+    const double R = 1.0;
+
+    shortStep.update(60.0, 20.0, qMoist, qBeta, R, 1.0);
+    longStep.update(60.0, 20.0, qMoist, qBeta, R, 10.0);
+    REQUIRE(longStep.getMoistReal() > shortStep.getMoistReal());
+
+    // The observation shrinks the uncertainty that accumulated over the step
+    twoSteps.update(60.0, 20.0, 0.0, 0.0, R, 0.0);
+    REQUIRE(twoSteps.getMoistVariance() < 1.0);
+    auto varianceBefore = twoSteps.getMoistVariance();
+    twoSteps.update(60.0, 20.0, qMoist, qBeta, R, 5.0);
+    REQUIRE(twoSteps.getMoistVariance() < varianceBefore + 5.0 * qMoist);
+    REQUIRE(twoSteps.getBetaVariance() > 0.0);
+}
+
 }    // namespace farmhub::utils::scheduling
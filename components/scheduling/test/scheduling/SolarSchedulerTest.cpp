@@ -0,0 +1,187 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "TestHelpers.hpp"
+
+#include <chrono>
+#include <memory>
+
+#include <peripherals/api/ILightSensor.hpp>
+#include <peripherals/api/TargetState.hpp>
+#include <scheduling/SolarCalculator.hpp>
+#include <scheduling/SolarScheduler.hpp>
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+using namespace farmhub::peripherals::api;
+using namespace farmhub::utils::scheduling;
+
+namespace {
+
+constexpr double BUDAPEST_LATITUDE = 47.4979;
+constexpr double BUDAPEST_LONGITUDE = 19.0402;
+
+// 2024-06-21 00:00:00 UTC
+constexpr system_clock::time_point SUMMER_SOLSTICE { 1'718'928'000s };
+// 2024-12-21 00:00:00 UTC
+constexpr system_clock::time_point WINTER_SOLSTICE { 1'734'739'200s };
+
+class MockLightSensor : public ILightSensor {
+public:
+    Lux getLightLevel() override {
+        return level;
+    }
+
+    void requestMeasurements(milliseconds duration) override {
+        requested = duration;
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "mock-light-sensor";
+        return name;
+    }
+
+    Lux level = 0.0;
+    std::optional<milliseconds> requested;
+};
+
+SolarSchedule budapest(seconds lightWindow = 0s) {
+    return {
+        .latitude = BUDAPEST_LATITUDE,
+        .longitude = BUDAPEST_LONGITUDE,
+        .twilight = Twilight::Official,
+        .openOffset = 0s,
+        .closeOffset = 0s,
+        .lightWindow = lightWindow,
+        .light = { .open = 100.0, .close = 10.0 },
+    };
+}
+
+/**
+ * @brief Check that the time is within two minutes of the expected one, about the precision of the calculation.
+ */
+bool isAround(system_clock::time_point actual, system_clock::time_point expected) {
+    return actual - expected < 2min && expected - actual < 2min;
+}
+
+}    // namespace
+
+TEST_CASE("SolarCalculator: sunrise and sunset match published times") {
+    auto summer = SolarCalculator::calculate(
+        SolarCalculator::dayOf(SUMMER_SOLSTICE + 12h, BUDAPEST_LONGITUDE), BUDAPEST_LATITUDE, BUDAPEST_LONGITUDE, Twilight::Official);
+    REQUIRE(summer.kind == SolarEvents::Kind::Normal);
+    REQUIRE(isAround(summer.rise, SUMMER_SOLSTICE + 2h + 46min));
+    REQUIRE(isAround(summer.set, SUMMER_SOLSTICE + 18h + 45min));
+
+    auto winter = SolarCalculator::calculate(
+        SolarCalculator::dayOf(WINTER_SOLSTICE + 12h, BUDAPEST_LONGITUDE), BUDAPEST_LATITUDE, BUDAPEST_LONGITUDE, Twilight::Official);
+    REQUIRE(isAround(winter.rise, WINTER_SOLSTICE + 6h + 29min));
+    REQUIRE(isAround(winter.set, WINTER_SOLSTICE + 14h + 55min));
+}
+
+TEST_CASE("SolarCalculator: civil twilight starts before sunrise") {
+    auto civil = SolarCalculator::calculate(
+        SolarCalculator::dayOf(SUMMER_SOLSTICE + 12h, BUDAPEST_LONGITUDE), BUDAPEST_LATITUDE, BUDAPEST_LONGITUDE, Twilight::Civil);
+    REQUIRE(isAround(civil.rise, SUMMER_SOLSTICE + 2h + 6min));
+    REQUIRE(isAround(civil.set, SUMMER_SOLSTICE + 19h + 26min));
+}
+
+TEST_CASE("SolarCalculator: the sun doesn't set or rise beyond the polar circle") {
+    // Tromsø
+    auto day = SolarCalculator::dayOf(SUMMER_SOLSTICE + 12h, 18.96);
+    REQUIRE(SolarCalculator::calculate(day, 69.65, 18.96, Twilight::Official).kind == SolarEvents::Kind::AlwaysUp);
+    day = SolarCalculator::dayOf(WINTER_SOLSTICE + 12h, 18.96);
+    REQUIRE(SolarCalculator::calculate(day, 69.65, 18.96, Twilight::Official).kind == SolarEvents::Kind::AlwaysDown);
+}
+
+TEST_CASE("SolarScheduler: returns none when no target is set or the clock is not set") {
+    SolarScheduler scheduler(nullptr);
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE) == ScheduleResult {});
+
+    scheduler.setTarget(budapest());
+    REQUIRE(scheduler.tick(system_clock::time_point {}) == ScheduleResult { .nextDeadline = 1min });
+}
+
+TEST_CASE("SolarScheduler: open during the day, closed at night") {
+    SolarScheduler scheduler(nullptr);
+    scheduler.setTarget(budapest());
+
+    auto night = scheduler.tick(SUMMER_SOLSTICE + 1h);
+    REQUIRE(night.targetState == TargetState::Closed);
+    // Next transition is sunrise
+    REQUIRE(night.nextDeadline > 1h + 44min);
+    REQUIRE(night.nextDeadline < 1h + 48min);
+
+    auto day = scheduler.tick(SUMMER_SOLSTICE + 12h);
+    REQUIRE(day.targetState == TargetState::Open);
+    // Next transition is sunset
+    REQUIRE(day.nextDeadline > 6h + 44min);
+    REQUIRE(day.nextDeadline < 6h + 47min);
+
+    auto evening = scheduler.tick(SUMMER_SOLSTICE + 20h);
+    REQUIRE(evening.targetState == TargetState::Closed);
+    // Next transition is tomorrow's sunrise
+    REQUIRE(evening.nextDeadline > 6h + 44min);
+    REQUIRE(evening.nextDeadline < 6h + 48min);
+}
+
+TEST_CASE("SolarScheduler: offsets shift the transitions") {
+    SolarScheduler scheduler(nullptr);
+    auto target = budapest();
+    target.openOffset = 1h;
+    target.closeOffset = -1h;
+    scheduler.setTarget(target);
+
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 3h).targetState == TargetState::Closed);
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 4h).targetState == TargetState::Open);
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 17h + 30min).targetState == TargetState::Open);
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 18h).targetState == TargetState::Closed);
+}
+
+TEST_CASE("SolarScheduler: light sensor is only asked to measure around transitions") {
+    auto sensor = std::make_shared<MockLightSensor>();
+    SolarScheduler scheduler(sensor);
+    scheduler.setTarget(budapest(30min));
+
+    auto night = scheduler.tick(SUMMER_SOLSTICE + 1h);
+    REQUIRE(night.targetState == TargetState::Closed);
+    REQUIRE_FALSE(sensor->requested.has_value());
+    // Wake up when the window before sunrise starts
+    REQUIRE(night.nextDeadline > 1h + 14min);
+    REQUIRE(night.nextDeadline < 1h + 18min);
+
+    // Entering the window, the sensor starts measuring, but the sun still decides
+    sensor->level = 200.0;
+    auto windowStart = scheduler.tick(SUMMER_SOLSTICE + 2h + 30min);
+    REQUIRE(windowStart.targetState == TargetState::Closed);
+    REQUIRE(windowStart.nextDeadline == 1min);
+    REQUIRE(sensor->requested > 30min);
+    REQUIRE(sensor->requested < 50min);
+
+    // Bright enough to open before sunrise
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 2h + 31min).targetState == TargetState::Open);
+
+    // Overcast morning keeps the door closed after sunrise
+    sensor->level = 5.0;
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 3h).targetState == TargetState::Closed);
+
+    // Between the thresholds the light sensor has no opinion
+    sensor->level = 50.0;
+    REQUIRE_FALSE(scheduler.tick(SUMMER_SOLSTICE + 3h + 5min).targetState.has_value());
+
+    // After the window the sun decides again
+    sensor->requested.reset();
+    sensor->level = 5.0;
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE + 4h).targetState == TargetState::Open);
+    REQUIRE_FALSE(sensor->requested.has_value());
+}
+
+TEST_CASE("SolarScheduler: sun alone decides at the poles") {
+    SolarScheduler scheduler(nullptr);
+    auto target = budapest();
+    target.latitude = 69.65;
+    target.longitude = 18.96;
+    scheduler.setTarget(target);
+
+    REQUIRE(scheduler.tick(SUMMER_SOLSTICE).targetState == TargetState::Open);
+    REQUIRE(scheduler.tick(WINTER_SOLSTICE + 12h).targetState == TargetState::Closed);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <mutex>
+
+namespace farmhub::kernel {
+
+/**
+ * @brief Host stand-in for the FreeRTOS-based mutex, for benchmarking code that locks.
+ */
+class Mutex {
+public:
+    void lock() {
+        mutex.lock();
+    }
+
+    void unlock() {
+        mutex.unlock();
+    }
+
+private:
+    std::mutex mutex;
+};
+
+using Lock = std::lock_guard<Mutex>;
+
+}    // namespace farmhub::kernel
@@ -5,10 +5,20 @@
 
 LOGGING_TAG(TEST, "test")
 
+#ifdef FARMHUB_FAKE_LOG_SILENT
+// Arguments are still type-checked, but nothing is printed
+#define LOG(fmt, ...)                             \
+    do {                                          \
+        if (false) {                              \
+            std::printf(fmt "\n", ##__VA_ARGS__); \
+        }                                         \
+    } while (0)
+#else
 #define LOG(fmt, ...)                         \
     do {                                      \
         std::printf(fmt "\n", ##__VA_ARGS__); \
     } while (0)
+#endif
 
 #define LOGV(fmt, ...) LOG("V " fmt, ##__VA_ARGS__)
 #define LOGD(fmt, ...) LOG("D " fmt, ##__VA_ARGS__)
@@ -0,0 +1,29 @@
+#include <chrono>
+#include <optional>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <utils/DebouncedMeasurement.hpp>
+
+using namespace std::chrono_literals;
+using namespace farmhub::utils;
+
+TEST_CASE("debounced measurement", "[benchmark]") {
+    int measurements = 0;
+    auto measure = [&](const DebouncedParams<double>& /*params*/) -> std::optional<double> {
+        measurements++;
+        return 21.5;
+    };
+
+    DebouncedMeasurement<double> cached(measure, 1h);
+    REQUIRE(cached.getValue() == 21.5);
+    BENCHMARK("cached value") {
+        return cached.getValue();
+    };
+
+    DebouncedMeasurement<double> fresh(measure, 0ms);
+    BENCHMARK("fresh measurement") {
+        return fresh.getValue();
+    };
+}
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+Compare two benchmark runs recorded with Catch2's XML reporter.
+
+Usage: compare_benchmarks.py <baseline.xml> <current.xml> [threshold-percent]
+
+A benchmark counts as a regression when its mean slowed down by more than the
+threshold (10% by default) and the confidence intervals of the two runs do not
+overlap. Exits with a non-zero status if any benchmark regressed.
+"""
+
+import sys
+import xml.etree.ElementTree as ET
+
+
+def load(path):
+    results = {}
+    for test_case in ET.parse(path).getroot().iter("TestCase"):
+        for benchmark in test_case.iter("BenchmarkResults"):
+            mean = benchmark.find("mean")
+            key = f"{test_case.get('name')} / {benchmark.get('name')}"
+            results[key] = (
+                float(mean.get("value")),
+                float(mean.get("lowerBound")),
+                float(mean.get("upperBound")),
+            )
+    return results
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return f"{value / scale:.2f} {unit}"
+    return f"{value:.2f} ns"
+
+
+def main():
+    if len(sys.argv) not in (3, 4):
+        print(f"Usage: {sys.argv[0]} <baseline.xml> <current.xml> [threshold-percent]", file=sys.stderr)
+        sys.exit(1)
+
+    baseline = load(sys.argv[1])
+    current = load(sys.argv[2])
+    threshold = float(sys.argv[3]) if len(sys.argv) == 4 else 10.0
+
+    regressions = 0
+    width = max((len(key) for key in baseline.keys() | current.keys()), default=0)
+    for key in sorted(baseline.keys() | current.keys()):
+        if key not in baseline:
+            print(f"{key:<{width}}  {'':>12}  {format_ns(current[key][0]):>12}  (new)")
+            continue
+        if key not in current:
+            print(f"{key:<{width}}  {format_ns(baseline[key][0]):>12}  {'':>12}  (removed)")
+            continue
+
+        base_mean, _, base_upper = baseline[key]
+        mean, lower, _ = current[key]
+        change = (mean - base_mean) / base_mean * 100 if base_mean > 0 else 0.0
+        regressed = change > threshold and lower > base_upper
+        if regressed:
+            regressions += 1
+        print(f"{key:<{width}}  {format_ns(base_mean):>12}  {format_ns(mean):>12}  {change:+7.1f}%"
+              + ("  REGRESSION" if regressed else ""))
+
+    if regressions > 0:
+        print(f"\n{regressions} benchmark(s) regressed by more than {threshold:.0f}%", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()